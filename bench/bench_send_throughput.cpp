@@ -0,0 +1,71 @@
+// Multi-thread send throughput of PduCommRaw::send.
+// Each producer thread publishes its own channel through one shared comm whose
+// raw_send only counts bytes, so the numbers reflect encode + lock cost.
+//
+// Usage: bench_send_throughput [payload_bytes] [messages_per_thread]
+#include "hakoniwa/pdu/comm/comm_raw.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+class NullSinkComm final : public hakoniwa::pdu::comm::PduCommRaw
+{
+public:
+    uint64_t bytes() const noexcept { return bytes_.load(); }
+
+protected:
+    HakoPduErrorType raw_open(const std::string&) override { return HAKO_PDU_ERR_OK; }
+    HakoPduErrorType raw_close() noexcept override { return HAKO_PDU_ERR_OK; }
+    HakoPduErrorType raw_start() noexcept override { return HAKO_PDU_ERR_OK; }
+    HakoPduErrorType raw_stop() noexcept override { return HAKO_PDU_ERR_OK; }
+    HakoPduErrorType raw_is_running(bool& running) noexcept override { running = true; return HAKO_PDU_ERR_OK; }
+    HakoPduErrorType raw_send(const std::vector<std::byte>& data) noexcept override
+    {
+        bytes_.fetch_add(data.size(), std::memory_order_relaxed);
+        return HAKO_PDU_ERR_OK;
+    }
+
+private:
+    std::atomic<uint64_t> bytes_{0};
+};
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const size_t payload_size = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 4096;
+    const size_t messages = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 200000;
+    const std::vector<int> thread_counts = {1, 2, 4, 8};
+
+    std::cout << "payload=" << payload_size << " bytes, messages/thread=" << messages << std::endl;
+    for (int threads : thread_counts) {
+        auto comm = std::make_shared<NullSinkComm>();
+        std::vector<std::thread> workers;
+        const auto begin = std::chrono::steady_clock::now();
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&comm, t, payload_size, messages]() {
+                std::vector<std::byte> payload(payload_size, std::byte{0x5A});
+                hakoniwa::pdu::PduResolvedKey key{"BenchRobot", t};
+                for (size_t i = 0; i < messages; ++i) {
+                    (void)comm->send(key, payload);
+                }
+            });
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+        const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        const double total = static_cast<double>(messages) * threads;
+        std::cout << "threads=" << threads
+                  << " msgs/s=" << static_cast<uint64_t>(total / sec)
+                  << " MB/s=" << (static_cast<double>(comm->bytes()) / sec / (1024.0 * 1024.0))
+                  << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,202 @@
+// Thread-per-session vs epoll reactor sessions in the TCP comm multiplexer.
+// A TcpCommMultiplexer accepts `connections` plain TCP clients, once with the
+// default thread per session and once with "reactor" enabled. Each client sends
+// a v2 frame every `interval_us` (driven by a few sender threads) carrying its
+// send time; the server's receive callback records the delivery latency.
+// With many connections the thread model pays for one reader thread per client
+// and the context switches between them; the reactor serves all of them from
+// one epoll loop per core.
+//
+// Usage: bench_tcp_mux_reactor [payload_bytes] [messages_per_connection] [interval_us] [reactor_threads]
+#include "bench_util.hpp"
+#include "hakoniwa/pdu/comm/comm_tcp_mux.hpp"
+#include "hakoniwa/pdu/comm/packet.hpp"
+#include "hakoniwa/pdu/latency_histogram.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using hakoniwa::pdu::LatencyHistogram;
+using hakoniwa::pdu::PduComm;
+using hakoniwa::pdu::PduResolvedKey;
+using hakoniwa::pdu::comm::DataPacket;
+using hakoniwa::pdu::comm::MetaPdu;
+using hakoniwa::pdu::comm::TcpCommMultiplexer;
+using hakoniwa::pdu::bench::received_rate;
+using hakoniwa::pdu::bench::wait_until_quiet;
+using hakoniwa::pdu::bench::write_config;
+
+constexpr int kPort = 54198;
+constexpr int kSenderThreads = 4;
+
+int64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int connect_client()
+{
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(kPort);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int nodelay = 1;
+    (void)setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool send_all(int fd, const std::byte* data, size_t size)
+{
+    while (size > 0) {
+        ssize_t n = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+void bench(bool reactor, int reactor_threads, int connections, size_t payload_size, size_t messages,
+           std::chrono::microseconds interval)
+{
+    const std::string config_path = write_config("tcp_mux_reactor",
+        "{ \"protocol\": \"tcp\", \"direction\": \"in\","
+        " \"local\": { \"address\": \"127.0.0.1\", \"port\": " + std::to_string(kPort) + " },"
+        " \"expected_clients\": " + std::to_string(connections) + ","
+        " \"options\": { \"backlog\": 1024, \"reactor\": { \"enabled\": " + (reactor ? "true" : "false")
+        + ", \"threads\": " + std::to_string(reactor_threads) + " } } }");
+    const std::string label = reactor ? "reactor" : "thread ";
+
+    TcpCommMultiplexer mux;
+    if (mux.open(config_path) != HAKO_PDU_ERR_OK || mux.start() != HAKO_PDU_ERR_OK) {
+        std::cerr << label << " connections=" << connections << ": mux open failed" << std::endl;
+        return;
+    }
+
+    std::vector<int> clients;
+    for (int i = 0; i < connections; ++i) {
+        int fd = connect_client();
+        if (fd < 0) {
+            std::cerr << "connect failed after " << i << " clients: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        clients.push_back(fd);
+    }
+
+    std::atomic<uint64_t> received{0};
+    LatencyHistogram latency;
+    std::vector<std::shared_ptr<PduComm>> sessions;
+    for (int wait = 0; wait < 500 && sessions.size() < clients.size(); ++wait) {
+        for (auto& session : mux.take_sessions()) {
+            session->set_on_recv_callback([&received, &latency](const PduResolvedKey&, std::span<const std::byte> data) {
+                int64_t sent_ns = 0;
+                if (data.size() >= sizeof(sent_ns)) {
+                    std::memcpy(&sent_ns, data.data(), sizeof(sent_ns));
+                    latency.record((now_ns() - sent_ns) / 1000);
+                }
+                received.fetch_add(1, std::memory_order_relaxed);
+            });
+            if (session->open(config_path) != HAKO_PDU_ERR_OK || session->start() != HAKO_PDU_ERR_OK) {
+                std::cerr << "session start failed" << std::endl;
+            }
+            sessions.push_back(std::move(session));
+        }
+        if (sessions.size() < clients.size()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kSenderThreads; ++t) {
+        threads.emplace_back([&, t]() {
+            MetaPdu meta;
+            DataPacket::init_meta(meta, "BenchRobot", static_cast<uint32_t>(t));
+            std::vector<std::byte> payload(std::max(payload_size, sizeof(int64_t)), std::byte{0x5A});
+            std::vector<std::byte> frame;
+            for (size_t m = 0; m < messages; ++m) {
+                for (size_t i = static_cast<size_t>(t); i < clients.size(); i += kSenderThreads) {
+                    const int64_t stamp = now_ns();
+                    std::memcpy(payload.data(), &stamp, sizeof(stamp));
+                    DataPacket::encode_into(frame, meta, payload);
+                    (void)send_all(clients[i], frame.data(), frame.size());
+                }
+                std::this_thread::sleep_until(begin + interval * static_cast<int64_t>(m + 1));
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    const uint64_t expected = messages * static_cast<uint64_t>(clients.size());
+    const auto end = wait_until_quiet(received, expected, 100);
+    const double seconds = std::chrono::duration<double>(end - begin).count();
+    const auto summary = latency.summary();
+
+    std::cout << label << " connections=" << clients.size()
+              << received_rate(received.load(), expected, seconds)
+              << " latency_us p50=" << summary.p50_us << " p99=" << summary.p99_us
+              << " max=" << summary.max_us << std::endl;
+
+    for (int fd : clients) {
+        ::close(fd);
+    }
+    for (auto& session : sessions) {
+        session->stop();
+        session->close();
+    }
+    mux.stop();
+    mux.close();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const size_t payload_size = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 256;
+    const size_t messages = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 200;
+    const auto interval = std::chrono::microseconds((argc > 3) ? std::strtoul(argv[3], nullptr, 10) : 5000);
+    const int reactor_threads = (argc > 4) ? std::atoi(argv[4]) : 0;
+
+    // 1000 clients and their 1000 server sessions need more than the usual 1024 fds.
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        (void)setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    std::cout << "payload=" << payload_size << " bytes, messages/connection=" << messages
+              << ", interval=" << interval.count() << " us, reactor threads=" << reactor_threads
+              << " (0 = auto), hardware threads=" << std::thread::hardware_concurrency() << std::endl;
+    for (int connections : {10, 100, 1000}) {
+        bench(false, reactor_threads, connections, payload_size, messages, interval);
+        bench(true, reactor_threads, connections, payload_size, messages, interval);
+    }
+    return 0;
+}
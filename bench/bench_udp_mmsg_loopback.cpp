@@ -0,0 +1,102 @@
+// UDP loopback throughput, one datagram per syscall vs recvmmsg/sendmmsg.
+// A receiver and a sender UdpComm are opened on 127.0.0.1 with the socket
+// backend; the sender pushes batches through send_batch() and the receiver
+// counts delivered PDUs. The "single" row sets recv_batch/send_batch to 1
+// (recvfrom/sendto), the "mmsg" row sets both to `batch`, and the "gso" row
+// additionally enables UDP_SEGMENT on send and UDP_GRO on receive.
+//
+// Usage: bench_udp_mmsg_loopback [payload_bytes] [messages] [batch]
+#include "bench_util.hpp"
+#include "hakoniwa/pdu/comm/comm_udp.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+using hakoniwa::pdu::PduResolvedKey;
+using hakoniwa::pdu::PduSendItem;
+using hakoniwa::pdu::bench::received_rate;
+using hakoniwa::pdu::bench::wait_until_quiet;
+using hakoniwa::pdu::bench::write_config;
+
+constexpr int kPort = 54192;
+
+std::string options_json(size_t mmsg_batch, bool offload)
+{
+    const std::string flag = offload ? "true" : "false";
+    return "\"options\": { \"recv_batch\": " + std::to_string(mmsg_batch)
+           + ", \"send_batch\": " + std::to_string(mmsg_batch)
+           + ", \"gso\": " + flag + ", \"gro\": " + flag
+           + ", \"buffer_size\": 4194304 }";
+}
+
+void bench(const std::string& label, size_t mmsg_batch, bool offload, size_t payload_size, size_t messages, size_t batch)
+{
+    const std::string rx_path = write_config("mmsg_rx_" + label,
+        "{ \"protocol\": \"udp\", \"direction\": \"in\","
+        " \"local\": { \"address\": \"127.0.0.1\", \"port\": " + std::to_string(kPort) + " }, "
+        + options_json(mmsg_batch, offload) + " }");
+    const std::string tx_path = write_config("mmsg_tx_" + label,
+        "{ \"protocol\": \"udp\", \"direction\": \"out\","
+        " \"remote\": { \"address\": \"127.0.0.1\", \"port\": " + std::to_string(kPort) + " }, "
+        + options_json(mmsg_batch, offload) + " }");
+
+    auto rx = std::make_shared<hakoniwa::pdu::comm::UdpComm>();
+    auto tx = std::make_shared<hakoniwa::pdu::comm::UdpComm>();
+    if (rx->open(rx_path) != HAKO_PDU_ERR_OK || tx->open(tx_path) != HAKO_PDU_ERR_OK) {
+        std::cerr << label << ": open failed" << std::endl;
+        return;
+    }
+    std::atomic<uint64_t> received{0};
+    rx->set_on_recv_callback([&received](const PduResolvedKey&, std::span<const std::byte>) {
+        received.fetch_add(1, std::memory_order_relaxed);
+    });
+    rx->start();
+    tx->start();
+
+    std::vector<std::byte> payload(payload_size, std::byte{0x5A});
+    std::vector<PduSendItem> items(batch, PduSendItem{PduResolvedKey{"BenchRobot", 0}, payload});
+
+    const auto begin = std::chrono::steady_clock::now();
+    for (size_t sent = 0; sent < messages; sent += batch) {
+        const size_t n = std::min(batch, messages - sent);
+        if (tx->send_batch(std::span<const PduSendItem>(items.data(), n)) != HAKO_PDU_ERR_OK) {
+            break;
+        }
+    }
+    const auto sent_end = std::chrono::steady_clock::now();
+    const auto end = wait_until_quiet(received, messages, 20);
+    const double send_seconds = std::chrono::duration<double>(sent_end - begin).count();
+    const double seconds = std::chrono::duration<double>(end - begin).count();
+
+    std::cout << label << " (batch=" << mmsg_batch << ")"
+              << " send msgs/s=" << static_cast<uint64_t>(messages / send_seconds)
+              << received_rate(received.load(), messages, seconds) << std::endl;
+
+    tx->stop();
+    rx->stop();
+    tx->close();
+    rx->close();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const size_t payload_size = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 256;
+    const size_t messages = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 200000;
+    const size_t batch = (argc > 3) ? std::clamp<size_t>(std::strtoul(argv[3], nullptr, 10), 1, 1024) : 32;
+
+    std::cout << "payload=" << payload_size << " bytes, messages=" << messages
+              << ", batch=" << batch << std::endl;
+    bench("single", 1, false, payload_size, messages, batch);
+    bench("mmsg", batch, false, payload_size, messages, batch);
+    bench("gso", batch, true, payload_size, messages, batch);
+    return 0;
+}
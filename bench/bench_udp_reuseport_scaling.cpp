@@ -0,0 +1,111 @@
+// Inbound UDP scaling with SO_REUSEPORT receiver threads.
+// One receiving UdpComm is opened with "receiver_threads" set to 1, 2, 4 and 8;
+// `senders` sending UdpComms (one flow each, so the kernel can spread them)
+// push PDUs from their own threads. The receive callback spins for `work_ns`
+// per PDU to stand in for decode/dispatch cost, which is what one recv thread
+// cannot scale past. Reports delivered PDUs per second.
+//
+// Usage: bench_udp_reuseport_scaling [payload_bytes] [messages_per_sender] [senders] [work_ns]
+#include "bench_util.hpp"
+#include "hakoniwa/pdu/comm/comm_udp.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using hakoniwa::pdu::PduResolvedKey;
+using hakoniwa::pdu::bench::received_rate;
+using hakoniwa::pdu::bench::spin_for;
+using hakoniwa::pdu::bench::wait_until_quiet;
+using hakoniwa::pdu::bench::write_config;
+
+constexpr int kPort = 54193;
+
+void bench(int receiver_threads, size_t payload_size, size_t messages, int senders, std::chrono::nanoseconds work)
+{
+    const std::string rx_path = write_config("reuseport_rx",
+        "{ \"protocol\": \"udp\", \"direction\": \"in\","
+        " \"local\": { \"address\": \"127.0.0.1\", \"port\": " + std::to_string(kPort) + " },"
+        " \"options\": { \"receiver_threads\": " + std::to_string(receiver_threads)
+        + ", \"buffer_size\": 4194304 } }");
+    const std::string tx_path = write_config("reuseport_tx",
+        "{ \"protocol\": \"udp\", \"direction\": \"out\","
+        " \"remote\": { \"address\": \"127.0.0.1\", \"port\": " + std::to_string(kPort) + " } }");
+
+    auto rx = std::make_shared<hakoniwa::pdu::comm::UdpComm>();
+    if (rx->open(rx_path) != HAKO_PDU_ERR_OK) {
+        std::cerr << "receiver_threads=" << receiver_threads << ": open failed" << std::endl;
+        return;
+    }
+    std::atomic<uint64_t> received{0};
+    rx->set_on_recv_callback([&received, work](const PduResolvedKey&, std::span<const std::byte>) {
+        spin_for(work);
+        received.fetch_add(1, std::memory_order_relaxed);
+    });
+    rx->start();
+
+    std::vector<std::shared_ptr<hakoniwa::pdu::comm::UdpComm>> txs;
+    for (int i = 0; i < senders; ++i) {
+        auto tx = std::make_shared<hakoniwa::pdu::comm::UdpComm>();
+        if (tx->open(tx_path) != HAKO_PDU_ERR_OK) {
+            std::cerr << "sender open failed" << std::endl;
+            return;
+        }
+        tx->start();
+        txs.push_back(tx);
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < senders; ++i) {
+        threads.emplace_back([&, i]() {
+            std::vector<std::byte> payload(payload_size, std::byte{0x5A});
+            const PduResolvedKey key{"BenchRobot", static_cast<HakoPduChannelIdType>(i)};
+            for (size_t m = 0; m < messages; ++m) {
+                txs[i]->send(key, payload);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    // UDP may drop under load: wait until the receivers go quiet.
+    const uint64_t expected = messages * static_cast<uint64_t>(senders);
+    const auto end = wait_until_quiet(received, expected, 20);
+    const double seconds = std::chrono::duration<double>(end - begin).count();
+
+    std::cout << "receiver_threads=" << receiver_threads
+              << received_rate(received.load(), expected, seconds) << std::endl;
+
+    for (auto& tx : txs) {
+        tx->stop();
+        tx->close();
+    }
+    rx->stop();
+    rx->close();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const size_t payload_size = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 256;
+    const size_t messages = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 50000;
+    const int senders = (argc > 3) ? std::max(1, std::atoi(argv[3])) : 8;
+    const auto work = std::chrono::nanoseconds((argc > 4) ? std::strtoul(argv[4], nullptr, 10) : 2000);
+
+    std::cout << "payload=" << payload_size << " bytes, messages/sender=" << messages
+              << ", senders=" << senders << ", work=" << work.count() << " ns"
+              << ", hardware threads=" << std::thread::hardware_concurrency() << std::endl;
+    for (int receiver_threads : {1, 2, 4, 8}) {
+        bench(receiver_threads, payload_size, messages, senders, work);
+    }
+    return 0;
+}
@@ -0,0 +1,66 @@
+// Helpers shared by the comm benchmarks: config files written to /tmp, a busy
+// wait standing in for per-PDU work, and the end of a run (wait until the
+// receiver goes quiet, then report the delivered rate).
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+
+namespace hakoniwa {
+namespace pdu {
+namespace bench {
+
+// Write a comm config to /tmp/hako_bench_<name>.json and return its path.
+inline std::string write_config(const std::string& name, const std::string& body)
+{
+    const std::string path = "/tmp/hako_bench_" + name + ".json";
+    std::ofstream out(path);
+    out << body;
+    return path;
+}
+
+// Busy wait; stands in for decode/dispatch cost in a receive callback.
+inline void spin_for(std::chrono::nanoseconds work)
+{
+    const auto until = std::chrono::steady_clock::now() + work;
+    while (std::chrono::steady_clock::now() < until) {
+    }
+}
+
+// Wait until `received` reaches `expected` or stops moving for idle_polls x 5 ms
+// (UDP may drop under load). Returns the time of the last progress, which ends
+// the measured run.
+inline std::chrono::steady_clock::time_point wait_until_quiet(const std::atomic<uint64_t>& received,
+                                                              uint64_t expected, int idle_polls)
+{
+    uint64_t last = 0;
+    auto last_change = std::chrono::steady_clock::now();
+    for (int idle = 0; idle < idle_polls;) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        const uint64_t now = received.load();
+        if (now >= expected) {
+            return std::chrono::steady_clock::now();
+        }
+        if (now != last) {
+            last_change = std::chrono::steady_clock::now();
+        }
+        idle = (now == last) ? idle + 1 : 0;
+        last = now;
+    }
+    return last_change;
+}
+
+// " received=<n>/<expected> msgs/s=<rate>", the common tail of a result line.
+inline std::string received_rate(uint64_t received, uint64_t expected, double seconds)
+{
+    return " received=" + std::to_string(received) + "/" + std::to_string(expected)
+           + " msgs/s=" + std::to_string(static_cast<uint64_t>(received / seconds));
+}
+
+} // namespace bench
+} // namespace pdu
+} // namespace hakoniwa
@@ -0,0 +1,237 @@
+// permessage-deflate bandwidth/CPU trade-off for WebSocket PDUs.
+// A server WebSocketComm sends `messages` PDUs to a client WebSocketComm
+// through a byte-counting TCP relay, with deflate off and at several
+// compression settings. Three payloads stand in for typical visualization
+// traffic: a LiDAR-like float32 range scan, an 8-bit camera-like image and
+// incompressible random bytes. Reports bytes on the wire relative to the raw
+// frames, throughput and process CPU time (both ends compress/inflate).
+//
+// Usage: bench_websocket_deflate [payload_bytes] [messages]
+#include "bench_util.hpp"
+#include "hakoniwa/pdu/comm/comm_websocket.hpp"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+using hakoniwa::pdu::PduResolvedKey;
+using hakoniwa::pdu::comm::WebSocketComm;
+using hakoniwa::pdu::bench::write_config;
+
+constexpr int kServerPort = 54195;
+constexpr int kRelayPort = 54196;
+
+// Accepts one connection on kRelayPort, connects it to kServerPort and copies
+// bytes both ways, counting server -> client bytes.
+class Relay {
+public:
+    bool start()
+    {
+        listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        int on = 1;
+        setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(kRelayPort);
+        if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(listen_fd_, 1) != 0) {
+            return false;
+        }
+        thread_ = std::thread([this]() { run(); });
+        return true;
+    }
+    void stop()
+    {
+        running_ = false;
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        ::close(listen_fd_);
+    }
+    uint64_t downstream_bytes() const { return downstream_.load(); }
+    void reset_count() { downstream_ = 0; }
+
+private:
+    void run()
+    {
+        pollfd lp{listen_fd_, POLLIN, 0};
+        while (running_ && ::poll(&lp, 1, 50) <= 0) {
+        }
+        if (!running_) {
+            return;
+        }
+        const int client = ::accept(listen_fd_, nullptr, nullptr);
+        const int server = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(kServerPort);
+        if (client < 0 || ::connect(server, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            std::cerr << "relay connect failed" << std::endl;
+            return;
+        }
+        std::vector<char> buf(256 * 1024);
+        pollfd fds[2] = {{client, POLLIN, 0}, {server, POLLIN, 0}};
+        while (running_) {
+            if (::poll(fds, 2, 50) <= 0) {
+                continue;
+            }
+            bool closed = false;
+            for (int i = 0; i < 2 && !closed; ++i) {
+                if ((fds[i].revents & (POLLIN | POLLHUP | POLLERR)) == 0) {
+                    continue;
+                }
+                const ssize_t n = ::recv(fds[i].fd, buf.data(), buf.size(), 0);
+                if (n <= 0) {
+                    closed = true;
+                    break;
+                }
+                const int to = (i == 0) ? server : client;
+                for (ssize_t off = 0; off < n;) {
+                    const ssize_t w = ::send(to, buf.data() + off, n - off, MSG_NOSIGNAL);
+                    if (w <= 0) {
+                        closed = true;
+                        break;
+                    }
+                    off += w;
+                }
+                if (i == 1) {
+                    downstream_ += static_cast<uint64_t>(n);
+                }
+            }
+            if (closed) {
+                break;
+            }
+        }
+        ::close(client);
+        ::close(server);
+    }
+
+    int listen_fd_ = -1;
+    std::atomic<bool> running_{true};
+    std::atomic<uint64_t> downstream_{0};
+    std::thread thread_;
+};
+
+std::vector<std::byte> make_payload(const std::string& kind, size_t size)
+{
+    std::vector<std::byte> payload(size);
+    std::mt19937 rng(42);
+    if (kind == "lidar") {
+        // Smooth ranges (float32) with millimetre noise.
+        std::normal_distribution<float> noise(0.0f, 0.001f);
+        for (size_t i = 0; i + sizeof(float) <= size; i += sizeof(float)) {
+            const float range = 5.0f + 2.0f * std::sin(static_cast<float>(i) / 4096.0f) + noise(rng);
+            std::memcpy(payload.data() + i, &range, sizeof(range));
+        }
+    } else if (kind == "image") {
+        // Gradient with sensor noise in the low bit.
+        for (size_t i = 0; i < size; ++i) {
+            payload[i] = static_cast<std::byte>(((i % 640) * 255 / 640) ^ (rng() & 1));
+        }
+    } else {
+        for (auto& b : payload) {
+            b = static_cast<std::byte>(rng());
+        }
+    }
+    return payload;
+}
+
+void bench(const std::string& label, const std::string& deflate, const std::string& kind,
+           const std::vector<std::byte>& payload, size_t messages)
+{
+    const std::string options = deflate.empty() ? "" : ", \"options\": { \"permessage_deflate\": " + deflate + " }";
+    const std::string server_path = write_config("ws_deflate_server",
+        "{ \"protocol\": \"websocket\", \"role\": \"server\", \"direction\": \"out\","
+        " \"local\": { \"port\": " + std::to_string(kServerPort) + " }" + options + " }");
+    const std::string client_path = write_config("ws_deflate_client",
+        "{ \"protocol\": \"websocket\", \"role\": \"client\", \"direction\": \"in\","
+        " \"remote\": { \"host\": \"127.0.0.1\", \"port\": " + std::to_string(kRelayPort) + ", \"path\": \"/\" }"
+        + options + " }");
+
+    Relay relay;
+    auto server = std::make_shared<WebSocketComm>();
+    auto client = std::make_shared<WebSocketComm>();
+    if (server->open(server_path) != HAKO_PDU_ERR_OK || client->open(client_path) != HAKO_PDU_ERR_OK || !relay.start()) {
+        std::cerr << label << ": setup failed" << std::endl;
+        return;
+    }
+    std::atomic<uint64_t> received{0};
+    client->set_on_recv_callback([&received](const PduResolvedKey&, std::span<const std::byte>) {
+        received.fetch_add(1, std::memory_order_relaxed);
+    });
+    server->start();
+    client->start();
+    bool running = false;
+    for (int w = 0; w < 500 && !running; ++w) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        client->is_running(running);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    relay.reset_count();
+
+    const PduResolvedKey key{"BenchRobot", 1};
+    const std::clock_t cpu_begin = std::clock();
+    const auto begin = std::chrono::steady_clock::now();
+    for (size_t m = 0; m < messages; ++m) {
+        server->send(key, payload);
+    }
+    for (int w = 0; w < 30000 && received.load() < messages; ++w) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    const double cpu_ms = 1000.0 * static_cast<double>(std::clock() - cpu_begin) / CLOCKS_PER_SEC;
+    const double raw = static_cast<double>(messages * (payload.size() + sizeof(hakoniwa::pdu::comm::MetaPdu)));
+
+    std::cout << kind << " " << label
+              << " received=" << received.load() << "/" << messages
+              << " wire/raw=" << static_cast<double>(relay.downstream_bytes()) / raw
+              << " MB/s(raw)=" << raw / seconds / 1e6
+              << " cpu_ms=" << cpu_ms
+              << std::endl;
+
+    client->stop();
+    client->close();
+    server->stop();
+    server->close();
+    relay.stop();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const size_t payload_size = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 256 * 1024;
+    const size_t messages = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 200;
+
+    std::cout << "payload=" << payload_size << " bytes, messages=" << messages << std::endl;
+    const std::pair<std::string, std::string> modes[] = {
+        {"off", ""},
+        {"level1", "{ \"enabled\": true, \"compression_level\": 1 }"},
+        {"level6", "{ \"enabled\": true, \"compression_level\": 6 }"},
+        {"level9", "{ \"enabled\": true, \"compression_level\": 9 }"},
+        {"level6_window10", "{ \"enabled\": true, \"compression_level\": 6, \"window_bits\": 10 }"},
+    };
+    for (const std::string kind : {"lidar", "image", "random"}) {
+        const auto payload = make_payload(kind, payload_size);
+        for (const auto& [label, deflate] : modes) {
+            bench(label, deflate, kind, payload, messages);
+        }
+    }
+    return 0;
+}
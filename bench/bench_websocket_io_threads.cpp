@@ -0,0 +1,122 @@
+// Inbound WebSocket scaling with an io_context thread pool.
+// One server WebSocketComm is opened with "io_threads" set to 1, 2, 4 and 8;
+// `clients` client WebSocketComms connect to it and push PDUs, driven by a few
+// sender threads. The server's receive callback spins for `work_ns` per PDU to
+// stand in for decode/dispatch cost. Framing, unmasking and dispatch of all
+// clients share the server's io threads, so msgs/s should grow with io_threads
+// until the cores run out.
+//
+// Usage: bench_websocket_io_threads [payload_bytes] [messages_per_client] [clients] [work_ns]
+#include "bench_util.hpp"
+#include "hakoniwa/pdu/comm/comm_websocket.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using hakoniwa::pdu::PduResolvedKey;
+using hakoniwa::pdu::comm::WebSocketComm;
+using hakoniwa::pdu::bench::received_rate;
+using hakoniwa::pdu::bench::spin_for;
+using hakoniwa::pdu::bench::wait_until_quiet;
+using hakoniwa::pdu::bench::write_config;
+
+constexpr int kPort = 54194;
+constexpr int kSenderThreads = 8;
+
+void bench(int io_threads, size_t payload_size, size_t messages, int clients, std::chrono::nanoseconds work)
+{
+    const std::string server_path = write_config("ws_pool_server",
+        "{ \"protocol\": \"websocket\", \"role\": \"server\", \"direction\": \"in\","
+        " \"local\": { \"port\": " + std::to_string(kPort) + " },"
+        " \"options\": { \"io_threads\": " + std::to_string(io_threads) + " } }");
+    const std::string client_path = write_config("ws_pool_client",
+        "{ \"protocol\": \"websocket\", \"role\": \"client\", \"direction\": \"out\","
+        " \"remote\": { \"host\": \"127.0.0.1\", \"port\": " + std::to_string(kPort) + ", \"path\": \"/\" } }");
+
+    auto server = std::make_shared<WebSocketComm>();
+    if (server->open(server_path) != HAKO_PDU_ERR_OK) {
+        std::cerr << "io_threads=" << io_threads << ": open failed" << std::endl;
+        return;
+    }
+    std::atomic<uint64_t> received{0};
+    server->set_on_recv_callback([&received, work](const PduResolvedKey&, std::span<const std::byte>) {
+        spin_for(work);
+        received.fetch_add(1, std::memory_order_relaxed);
+    });
+    server->start();
+
+    std::vector<std::shared_ptr<WebSocketComm>> peers;
+    for (int i = 0; i < clients; ++i) {
+        auto client = std::make_shared<WebSocketComm>();
+        if (client->open(client_path) != HAKO_PDU_ERR_OK) {
+            std::cerr << "client open failed" << std::endl;
+            return;
+        }
+        client->start();
+        peers.push_back(client);
+    }
+    for (auto& client : peers) {
+        bool running = false;
+        for (int w = 0; w < 500 && !running; ++w) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            client->is_running(running);
+        }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200)); // server side handshakes
+
+    const auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kSenderThreads; ++t) {
+        threads.emplace_back([&, t]() {
+            std::vector<std::byte> payload(payload_size, std::byte{0x5A});
+            for (size_t m = 0; m < messages; ++m) {
+                for (int i = t; i < clients; i += kSenderThreads) {
+                    const PduResolvedKey key{"BenchRobot", static_cast<HakoPduChannelIdType>(i)};
+                    peers[i]->send(key, payload);
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    const uint64_t expected = messages * static_cast<uint64_t>(clients);
+    const auto end = wait_until_quiet(received, expected, 100);
+    const double seconds = std::chrono::duration<double>(end - begin).count();
+
+    std::cout << "io_threads=" << io_threads
+              << received_rate(received.load(), expected, seconds) << std::endl;
+
+    for (auto& client : peers) {
+        client->stop();
+        client->close();
+    }
+    server->stop();
+    server->close();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const size_t payload_size = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 1024;
+    const size_t messages = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 2000;
+    const int clients = (argc > 3) ? std::max(1, std::atoi(argv[3])) : 64;
+    const auto work = std::chrono::nanoseconds((argc > 4) ? std::strtoul(argv[4], nullptr, 10) : 2000);
+
+    std::cout << "payload=" << payload_size << " bytes, messages/client=" << messages
+              << ", clients=" << clients << ", work=" << work.count() << " ns"
+              << ", hardware threads=" << std::thread::hardware_concurrency() << std::endl;
+    for (int io_threads : {1, 2, 4, 8}) {
+        bench(io_threads, payload_size, messages, clients, work);
+    }
+    return 0;
+}
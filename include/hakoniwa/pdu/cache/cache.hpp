@@ -23,6 +23,9 @@ public:
     PduCache& operator=(PduCache&&) = delete;
 
     virtual HakoPduErrorType open(const std::string& config_path) = 0;
+    // New, empty cache already configured like this opened one, without reading
+    // the config again (endpoint templates). nullptr when not supported.
+    virtual std::unique_ptr<PduCache> clone_config() const { return nullptr; }
     virtual HakoPduErrorType close() noexcept = 0;
     virtual HakoPduErrorType start() noexcept = 0;
     virtual HakoPduErrorType stop() noexcept = 0;
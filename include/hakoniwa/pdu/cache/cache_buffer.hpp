@@ -6,6 +6,7 @@
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 #include <nlohmann/json.hpp>
 #include <iostream>
@@ -52,6 +53,10 @@ public:
     return HAKO_PDU_ERR_OK;
   }
 
+  std::unique_ptr<PduCache> clone_config() const override {
+    return std::make_unique<PduLatestBuffer>();
+  }
+
   HakoPduErrorType close() noexcept override {
     std::lock_guard<std::mutex> lock(mtx_);
     buffers_.clear();
@@ -111,6 +116,22 @@ public:
 
     return HAKO_PDU_ERR_OK;
   }
+
+  // Copy out the latest value of every key that holds data.
+  HakoPduErrorType snapshot(std::vector<std::pair<PduResolvedKey, std::vector<std::byte>>> &entries) {
+    if (!is_running_) {
+        return HAKO_PDU_ERR_NOT_RUNNING;
+    }
+    std::lock_guard<std::mutex> lock(mtx_);
+    entries.clear();
+    entries.reserve(buffers_.size());
+    for (const auto &[key, entry] : buffers_) {
+      if (entry.has_data) {
+        entries.emplace_back(key, entry.data);
+      }
+    }
+    return HAKO_PDU_ERR_OK;
+  }
 };
 
 } // namespace pdu
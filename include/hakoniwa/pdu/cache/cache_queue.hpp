@@ -55,6 +55,12 @@ public:
     return HAKO_PDU_ERR_OK;
   }
 
+  std::unique_ptr<PduCache> clone_config() const override {
+    auto clone = std::make_unique<PduLatestQueue>();
+    clone->depth_ = depth_;
+    return clone;
+  }
+
   HakoPduErrorType close() noexcept override {
     std::lock_guard<std::mutex> lock(mtx_);
     queues_.clear();
@@ -0,0 +1,223 @@
+#pragma once
+
+#include "hakoniwa/pdu/cache/cache.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace hakoniwa {
+namespace pdu {
+
+// One value of a PduSharedCache.
+struct PduSharedCacheEntry {
+  PduResolvedKey key;
+  uint64_t session_id = 0; // session that wrote it
+  std::vector<std::byte> data;
+};
+
+// Latest value per (robot, channel) written by many session endpoints of an
+// EndpointCommMultiplexer, so an aggregator reads one structure instead of one
+// cache per client. With per_session, values are also keyed by session id and
+// each client keeps its own slot; otherwise the last writer wins.
+// Keys are spread over lock stripes, so sessions writing different PDUs (or,
+// with per_session, their own slot of the same PDU) rarely contend.
+class PduSharedCache {
+public:
+  explicit PduSharedCache(bool per_session) : per_session_(per_session) {}
+  PduSharedCache(const PduSharedCache &) = delete;
+  PduSharedCache &operator=(const PduSharedCache &) = delete;
+
+  bool per_session() const noexcept { return per_session_; }
+
+  HakoPduErrorType write(uint64_t session_id, const PduResolvedKey &pdu_key,
+                         std::span<const std::byte> data) noexcept {
+    try {
+      const SlotKey slot{pdu_key, per_session_ ? session_id : 0};
+      Stripe &stripe = stripe_of_(slot);
+      std::lock_guard<std::mutex> lock(stripe.mtx);
+      auto &entry = stripe.slots[slot];
+      entry.data.assign(data.begin(), data.end());
+      entry.session_id = session_id;
+    } catch (const std::bad_alloc &) {
+      return HAKO_PDU_ERR_OUT_OF_MEMORY;
+    }
+    return HAKO_PDU_ERR_OK;
+  }
+
+  // session_id selects the slot with per_session and is ignored otherwise.
+  HakoPduErrorType read(const PduResolvedKey &pdu_key, std::span<std::byte> data,
+                        size_t &received_size, uint64_t session_id = 0) noexcept {
+    received_size = 0;
+    try {
+      const SlotKey slot{pdu_key, per_session_ ? session_id : 0};
+      Stripe &stripe = stripe_of_(slot);
+      std::lock_guard<std::mutex> lock(stripe.mtx);
+      auto it = stripe.slots.find(slot);
+      if (it == stripe.slots.end()) {
+        return HAKO_PDU_ERR_NO_ENTRY;
+      }
+      const auto &src = it->second.data;
+      received_size = src.size();
+      if (data.size() < src.size()) {
+        return HAKO_PDU_ERR_NO_SPACE;
+      }
+      std::copy(src.begin(), src.end(), data.begin());
+    } catch (const std::bad_alloc &) {
+      return HAKO_PDU_ERR_OUT_OF_MEMORY; // copying the lookup key
+    }
+    return HAKO_PDU_ERR_OK;
+  }
+
+  // Visit every value, one stripe locked at a time. visit must not call back
+  // into this cache.
+  void for_each(const std::function<void(const PduResolvedKey &, uint64_t,
+                                         std::span<const std::byte>)> &visit) {
+    for (auto &stripe : stripes_) {
+      std::lock_guard<std::mutex> lock(stripe.mtx);
+      for (const auto &[slot, entry] : stripe.slots) {
+        visit(slot.key, entry.session_id, entry.data);
+      }
+    }
+  }
+
+  // Copy out every value.
+  HakoPduErrorType snapshot(std::vector<PduSharedCacheEntry> &entries) noexcept {
+    entries.clear();
+    try {
+      for_each([&entries](const PduResolvedKey &key, uint64_t session_id,
+                          std::span<const std::byte> data) {
+        entries.push_back(PduSharedCacheEntry{key, session_id,
+                                              std::vector<std::byte>(data.begin(), data.end())});
+      });
+    } catch (const std::bad_alloc &) {
+      return HAKO_PDU_ERR_OUT_OF_MEMORY;
+    }
+    return HAKO_PDU_ERR_OK;
+  }
+
+  // Drop the slots of a session whose endpoint closed (per_session only).
+  void erase_session(uint64_t session_id) noexcept {
+    if (!per_session_) {
+      return;
+    }
+    for (auto &stripe : stripes_) {
+      std::lock_guard<std::mutex> lock(stripe.mtx);
+      for (auto it = stripe.slots.begin(); it != stripe.slots.end();) {
+        it = (it->first.session_id == session_id) ? stripe.slots.erase(it) : std::next(it);
+      }
+    }
+  }
+
+  void clear() noexcept {
+    for (auto &stripe : stripes_) {
+      std::lock_guard<std::mutex> lock(stripe.mtx);
+      stripe.slots.clear();
+    }
+  }
+
+private:
+  struct SlotKey {
+    PduResolvedKey key;
+    uint64_t session_id = 0;
+    bool operator==(const SlotKey &other) const noexcept {
+      return session_id == other.session_id && key == other.key;
+    }
+  };
+  struct SlotKeyHash {
+    std::size_t operator()(const SlotKey &k) const {
+      // Odd multiplier: consecutive session ids differ in the low (stripe) bits.
+      return PduResolvedKeyHash()(k.key) ^ static_cast<std::size_t>(k.session_id * 0x9E3779B97F4A7C15ull);
+    }
+  };
+  struct Slot {
+    std::vector<std::byte> data;
+    uint64_t session_id = 0;
+  };
+  // One cache line each, so writers on neighbouring stripes do not false-share.
+  struct alignas(64) Stripe {
+    std::mutex mtx;
+    std::unordered_map<SlotKey, Slot, SlotKeyHash> slots;
+  };
+  static constexpr std::size_t kStripes = 16;
+
+  // SlotKeyHash covers the session id too (0 unless per_session), so clients
+  // writing the same PDU in per_session mode spread over the stripes.
+  Stripe &stripe_of_(const SlotKey &slot) noexcept {
+    return stripes_[SlotKeyHash()(slot) % kStripes];
+  }
+
+  const bool per_session_;
+  std::array<Stripe, kStripes> stripes_;
+};
+
+// PduCache of one session endpoint that writes into a PduSharedCache under
+// its session id. recv() on the endpoint reads the shared value (its own slot
+// with per_session). close() drops the session's slots.
+class PduSharedCacheSession : public PduCache {
+public:
+  PduSharedCacheSession(std::shared_ptr<PduSharedCache> shared, uint64_t session_id)
+      : shared_(std::move(shared)), session_id_(session_id) {}
+  ~PduSharedCacheSession() override = default;
+
+  HakoPduErrorType open(const std::string &config_path) override {
+    (void)config_path; // configured by the multiplexer
+    return HAKO_PDU_ERR_OK;
+  }
+
+  HakoPduErrorType close() noexcept override {
+    is_running_ = false;
+    shared_->erase_session(session_id_);
+    return HAKO_PDU_ERR_OK;
+  }
+
+  HakoPduErrorType start() noexcept override {
+    is_running_ = true;
+    return HAKO_PDU_ERR_OK;
+  }
+
+  HakoPduErrorType stop() noexcept override {
+    is_running_ = false;
+    return HAKO_PDU_ERR_OK;
+  }
+
+  HakoPduErrorType is_running(bool &running) noexcept override {
+    running = is_running_;
+    return HAKO_PDU_ERR_OK;
+  }
+
+  HakoPduErrorType write(const PduResolvedKey &pdu_key,
+                         std::span<const std::byte> data) noexcept override {
+    if (!is_running_) {
+      return HAKO_PDU_ERR_NOT_RUNNING;
+    }
+    return shared_->write(session_id_, pdu_key, data);
+  }
+
+  HakoPduErrorType read(const PduResolvedKey &pdu_key, std::span<std::byte> data,
+                        size_t &received_size) noexcept override {
+    if (!is_running_) {
+      received_size = 0;
+      return HAKO_PDU_ERR_NOT_RUNNING;
+    }
+    return shared_->read(pdu_key, data, received_size, session_id_);
+  }
+
+  uint64_t session_id() const noexcept { return session_id_; }
+
+private:
+  std::shared_ptr<PduSharedCache> shared_;
+  const uint64_t session_id_;
+  std::atomic<bool> is_running_{false};
+};
+
+} // namespace pdu
+} // namespace hakoniwa
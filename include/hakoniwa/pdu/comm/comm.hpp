@@ -2,15 +2,61 @@
 
 #include "hakoniwa/pdu/endpoint_types.hpp"
 #include "hakoniwa/pdu/pdu_definition.hpp" 
+#include <chrono>
+#include <cstdint>
 #include <memory> 
 #include <span>
 #include <functional>
+#include <vector>
 
 namespace hakoniwa {
 namespace pdu {
 
 // callbacks for communication
 
+// One PDU of a batched send. The data span must stay valid for the duration of send_batch().
+struct PduSendItem {
+    PduResolvedKey key;
+    std::span<const std::byte> data;
+};
+
+// Encoded frame shared by several comms without copying (group sends, WebSocket
+// broadcast). Immutable once published; key names the PDU encoded in bytes.
+struct PduEncodedFrame {
+    std::vector<std::byte> bytes;
+    PduResolvedKey key;
+};
+using PduSharedFrame = std::shared_ptr<const PduEncodedFrame>;
+
+// Per-channel receive statistics, reported by comms that track sequence numbers.
+struct PduChannelStats {
+    PduResolvedKey key;
+    uint64_t received = 0;      // samples delivered in order
+    uint64_t lost = 0;          // sequence gaps that were never filled
+    uint64_t reordered = 0;     // late samples dropped because a newer one was already delivered
+    uint64_t duplicates = 0;    // repeated sequence numbers, dropped
+    uint64_t last_sequence = 0; // newest sequence number delivered
+};
+
+// Receive socket statistics, reported by socket based comms.
+struct PduCommSocketStats {
+    uint64_t rx_dropped = 0;       // datagrams the kernel dropped on a full receive queue (SO_RXQ_OVFL)
+    int recv_buffer_size = 0;      // SO_RCVBUF as reported by getsockopt (per receive socket)
+    uint32_t recv_buffer_grows = 0; // receive buffer auto-tune steps taken
+};
+
+// Timing of the PDU being delivered to on_recv_callback_, for latency tracking.
+// Times are CLOCK_REALTIME; 0 means unknown.
+struct PduRecvTimestamps {
+    int64_t sent_real_time_us = 0; // sender's MetaPdu::real_time_us (v2 frames from a tracking sender)
+    int64_t kernel_rx_ns = 0;      // SO_TIMESTAMPNS of the read, or the userspace arrival time
+};
+
+inline int64_t realtime_now_ns() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
 
 // PduComm defines the transport contract used by Endpoint.
 // Implementations must make delivery semantics explicit via config.
@@ -44,6 +90,40 @@ public:
 
     // Send PDU data for a resolved key.
     virtual HakoPduErrorType send(const PduResolvedKey& pdu_key, std::span<const std::byte> data) noexcept = 0;
+    // Send several PDUs at once. Transports that can batch (one syscall / one
+    // submission for all items) override this; the default sends one by one.
+    // Stops at the first failure and returns its error.
+    virtual HakoPduErrorType send_batch(std::span<const PduSendItem> items) noexcept
+    {
+        for (const auto& item : items) {
+            HakoPduErrorType err = send(item.key, item.data);
+            if (err != HAKO_PDU_ERR_OK) {
+                return err;
+            }
+        }
+        return HAKO_PDU_ERR_OK;
+    }
+    // Send a frame already encoded for this comm's packet version, e.g. one frame
+    // encoded once for every session of an EndpointCommMultiplexer. Comms that
+    // queue frames keep a reference to it instead of a copy.
+    virtual HakoPduErrorType send_frame(const PduSharedFrame& frame) noexcept
+    {
+        (void)frame;
+        return HAKO_PDU_ERR_UNSUPPORTED;
+    }
+    // Snapshot of per-channel receive statistics. Comms that do not track
+    // sequence numbers return HAKO_PDU_ERR_UNSUPPORTED.
+    virtual HakoPduErrorType get_channel_stats(std::vector<PduChannelStats>& stats) const noexcept
+    {
+        stats.clear();
+        return HAKO_PDU_ERR_UNSUPPORTED;
+    }
+    // Receive socket statistics; HAKO_PDU_ERR_UNSUPPORTED for non-socket comms.
+    virtual HakoPduErrorType get_socket_stats(PduCommSocketStats& stats) const noexcept
+    {
+        stats = PduCommSocketStats{};
+        return HAKO_PDU_ERR_UNSUPPORTED;
+    }
     // Recv PDU data for a resolved key (optional; raw comms may return UNSUPPORTED).
     virtual HakoPduErrorType recv(const PduResolvedKey& pdu_key, std::span<std::byte> data, size_t& received_size) noexcept = 0;
 
@@ -54,6 +134,27 @@ public:
         return HAKO_PDU_ERR_OK;
     }
 
+    // Called from the comm thread right after a stream connection comes up
+    // (initial connect and every reconnect). Comms without connections never call it.
+    virtual HakoPduErrorType set_on_connected_callback(std::function<void()> callback) noexcept
+    {
+        on_connected_callback_ = callback;
+        return HAKO_PDU_ERR_OK;
+    }
+    // True when the comm is configured to have the endpoint replay its latest
+    // outgoing PDUs on (re)connect ("resync_on_connect").
+    virtual bool resync_on_connect() const noexcept { return false; }
+    // True when the comm stamps real_time_us on send and receive timestamps on
+    // delivery ("latency_tracking"); the endpoint then keeps latency histograms.
+    virtual bool latency_tracking() const noexcept { return false; }
+    // Timestamps of the PDU currently being delivered on this thread. Only
+    // meaningful inside on_recv_callback_ of a latency tracking comm.
+    static PduRecvTimestamps& current_recv_timestamps() noexcept
+    {
+        thread_local PduRecvTimestamps timestamps;
+        return timestamps;
+    }
+
     // Only meaningful for SHM poll implementations. Other comm types are no-op.
     virtual void process_recv_events() noexcept {}
     
@@ -64,6 +165,7 @@ protected:
     std::shared_ptr<PduDefinition>  pdu_def_; // Moved to base class
     //callbacks can be added here
     std::function<void(const PduResolvedKey&, std::span<const std::byte>)> on_recv_callback_;
+    std::function<void()> on_connected_callback_;
 };
 } // namespace pdu
 } // namespace hakoniwa
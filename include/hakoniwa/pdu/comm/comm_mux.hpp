@@ -1,7 +1,12 @@
 #pragma once
 
 #include "hakoniwa/pdu/comm/comm.hpp"
+#include "hakoniwa/pdu/socket_utils.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -9,6 +14,99 @@ namespace hakoniwa {
 namespace pdu {
 namespace comm {
 
+// Session arrival notification of a comm multiplexer. Shared with the threads
+// that create sessions (accept loop, recv loop, io threads), which call
+// notify() after queueing a session for take_sessions().
+class SessionSignal
+{
+public:
+    using Callback = std::function<void()>;
+
+    SessionSignal() { (void)fd_.open(); }
+
+    void notify() noexcept
+    {
+        std::shared_ptr<const Callback> callback;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_ = true;
+            callback = callback_;
+        }
+        cond_.notify_all();
+        fd_.notify();
+        if (callback) {
+            (*callback)();
+        }
+    }
+    // The multiplexer's start(): waits block again until ready.
+    void start() noexcept
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = false;
+    }
+    // The multiplexer's stop()/close(): wake waiters, and fail waits started
+    // later until the next start().
+    void stop() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopped_ = true;
+        }
+        cond_.notify_all();
+    }
+    // take_sessions(): clear before taking, so a session queued meanwhile notifies again.
+    void clear() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_ = false;
+        }
+        fd_.drain();
+    }
+
+    // Wait until ready() holds; ready() is evaluated under the signal mutex.
+    // HAKO_PDU_ERR_NOT_RUNNING when not started or stopped meanwhile.
+    template <typename Pred>
+    HakoPduErrorType wait(Pred ready, int timeout_ms) noexcept
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto done = [&]() { return ready() || stopped_; };
+        if (timeout_ms < 0) {
+            while (!cond_.wait_for(lock, std::chrono::seconds(1), done)) {
+            }
+        } else if (!cond_.wait_for(lock, std::chrono::milliseconds(timeout_ms), done)) {
+            return HAKO_PDU_ERR_TIMEOUT;
+        }
+        return ready() ? HAKO_PDU_ERR_OK : HAKO_PDU_ERR_NOT_RUNNING;
+    }
+    bool pending() const noexcept { return pending_; } // under wait()
+
+    void set_callback(Callback callback)
+    {
+        auto shared = callback ? std::make_shared<const Callback>(std::move(callback)) : nullptr;
+        std::lock_guard<std::mutex> lock(mutex_);
+        callback_ = std::move(shared);
+    }
+    int fd() const noexcept { return fd_.fd(); }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    bool pending_ = false;
+    bool stopped_ = true; // until the multiplexer's start()
+    std::shared_ptr<const Callback> callback_;
+    WakeupFd fd_;
+};
+
+// Admission counters of a comm multiplexer (TCP mux "admission" options,
+// UDP mux "max_peers").
+struct CommMuxAdmissionStats {
+    uint64_t accepted = 0;              // connections that became sessions
+    uint64_t rejected_max_sessions = 0; // refused: max_sessions sessions were live
+    uint64_t rejected_rate = 0;         // refused: accept rate limit exhausted
+    size_t live_sessions = 0;           // sessions not yet closed by either side
+};
+
 class CommMultiplexer
 {
 public:
@@ -31,6 +129,35 @@ public:
     virtual size_t expected_count() const noexcept = 0;
 
     bool is_ready() const noexcept { return connected_count() >= expected_count(); }
+
+    // HAKO_PDU_ERR_UNSUPPORTED when the multiplexer has no admission control.
+    virtual HakoPduErrorType get_admission_stats(CommMuxAdmissionStats& stats) const noexcept
+    {
+        stats = CommMuxAdmissionStats{};
+        return HAKO_PDU_ERR_UNSUPPORTED;
+    }
+
+    // Block until is_ready() (HAKO_PDU_ERR_OK), timeout_ms passes (HAKO_PDU_ERR_TIMEOUT,
+    // -1 waits forever) or the mux is not running: before start(), after stop()/close()
+    // or when one of them is called meanwhile (HAKO_PDU_ERR_NOT_RUNNING).
+    HakoPduErrorType wait_ready(int timeout_ms) noexcept
+    {
+        return session_signal_->wait([this]() { return is_ready(); }, timeout_ms);
+    }
+    // Same, until take_sessions() has something to return.
+    HakoPduErrorType wait_sessions(int timeout_ms) noexcept
+    {
+        const SessionSignal& signal = *session_signal_;
+        return session_signal_->wait([&signal]() { return signal.pending(); }, timeout_ms);
+    }
+    // Called on the thread that created the session, right after it was queued
+    // for take_sessions(). Keep it short: wake a loop, do not take sessions in it.
+    void set_on_session_callback(SessionSignal::Callback callback) { session_signal_->set_callback(std::move(callback)); }
+    // Readable (POLLIN) once a session is waiting for take_sessions(); -1 if unavailable.
+    int session_fd() const noexcept { return session_signal_->fd(); }
+
+protected:
+    std::shared_ptr<SessionSignal> session_signal_ = std::make_shared<SessionSignal>();
 };
 
 } // namespace comm
@@ -6,6 +6,7 @@
 #include <string>
 #include <mutex> // Add mutex include
 #include <memory>
+#include <new>
 #include <iostream>
 // Removed <deque>, <mutex>, <condition_variable>
 
@@ -42,16 +43,58 @@ class PduCommRaw : public PduComm {
      }
  
      HakoPduErrorType send(const PduResolvedKey& pdu_key, std::span<const std::byte> data) noexcept override {
-         DataPacket packet(pdu_key.robot, pdu_key.channel_id, {data.begin(), data.end()});
-         // TODO: Timestamps should be set here if needed.
-         std::lock_guard<std::mutex> lock(send_mutex_); // Add lock
-         auto encoded_data = packet.encode(packet_version_); // Encode data while holding lock
+         // Encoding runs outside send_mutex_ into a per-thread buffer, so producers
+         // publishing different channels only serialize on the transport write.
+         thread_local std::vector<std::byte> encoded_data;
+         MetaPdu meta;
+         DataPacket::init_meta(meta, pdu_key.robot, static_cast<uint32_t>(pdu_key.channel_id));
+         if (latency_tracking_) {
+             meta.real_time_us = realtime_now_ns() / 1000;
+         }
+         try {
+             DataPacket::encode_into(encoded_data, meta, data, packet_version_);
+         } catch (const std::bad_alloc&) {
+             return HAKO_PDU_ERR_OUT_OF_MEMORY;
+         }
          #ifdef ENABLE_DEBUG_MESSAGES
          std::cout << "DEBUG: PduCommRaw sending PDU: robot=" << pdu_key.robot
                    << " channel=" << pdu_key.channel_id
                    << " size=" << encoded_data.size() << std::endl;
         #endif
-         return raw_send(encoded_data); // Call the pure virtual raw_send, now protected by the lock
+         std::lock_guard<std::mutex> lock(send_mutex_);
+         raw_stamp_frame(encoded_data);
+         return raw_send(encoded_data);
+     }
+ 
+     HakoPduErrorType send_batch(std::span<const PduSendItem> items) noexcept override {
+         thread_local std::vector<std::vector<std::byte>> encoded_frames;
+         const int64_t real_time_us = latency_tracking_ ? realtime_now_ns() / 1000 : 0;
+         try {
+             if (encoded_frames.size() < items.size()) {
+                 encoded_frames.resize(items.size());
+             }
+             for (size_t i = 0; i < items.size(); ++i) {
+                 MetaPdu meta;
+                 DataPacket::init_meta(meta, items[i].key.robot, static_cast<uint32_t>(items[i].key.channel_id));
+                 meta.real_time_us = real_time_us;
+                 DataPacket::encode_into(encoded_frames[i], meta, items[i].data, packet_version_);
+             }
+         } catch (const std::bad_alloc&) {
+             return HAKO_PDU_ERR_OUT_OF_MEMORY;
+         }
+         std::lock_guard<std::mutex> lock(send_mutex_);
+         for (size_t i = 0; i < items.size(); ++i) {
+             raw_stamp_frame(encoded_frames[i]);
+         }
+         return raw_send_batch(std::span<const std::vector<std::byte>>(encoded_frames.data(), items.size()));
+     }
+ 
+     HakoPduErrorType send_frame(const PduSharedFrame& frame) noexcept override {
+         if (!frame) {
+             return HAKO_PDU_ERR_INVALID_ARGUMENT;
+         }
+         std::lock_guard<std::mutex> lock(send_mutex_);
+         return raw_send_frame(frame);
      }
  
      HakoPduErrorType recv(const PduResolvedKey& pdu_key, std::span<std::byte> data, size_t& received_size) noexcept override {
@@ -60,6 +103,8 @@ class PduCommRaw : public PduComm {
          received_size = 0;
          return HAKO_PDU_ERR_UNSUPPORTED;
      }
+
+     bool latency_tracking() const noexcept override { return latency_tracking_; }
  
  protected:
      bool set_packet_version(const std::string& version) {
@@ -70,6 +115,8 @@ class PduCommRaw : public PduComm {
          return false;
      }
      const std::string& packet_version() const noexcept { return packet_version_; }
+     // "latency_tracking" option: stamp real_time_us on send, publish PduRecvTimestamps on receive.
+     void set_latency_tracking(bool enabled) noexcept { latency_tracking_ = enabled; }
 
      // Pure virtual interface for derived classes (UdpComm, TcpComm)
      // These methods deal with raw, framed byte buffers.
@@ -80,37 +127,84 @@ class PduCommRaw : public PduComm {
      virtual HakoPduErrorType raw_stop() noexcept = 0;
      virtual HakoPduErrorType raw_is_running(bool& running) noexcept = 0;
      virtual HakoPduErrorType raw_send(const std::vector<std::byte>& data) noexcept = 0; // Keep the original name
+     // Send already-encoded frames in order. Called with send_mutex_ held.
+     // Override when the transport can submit several frames at once.
+     virtual HakoPduErrorType raw_send_batch(std::span<const std::vector<std::byte>> frames) noexcept {
+         for (const auto& frame : frames) {
+             HakoPduErrorType err = raw_send(frame);
+             if (err != HAKO_PDU_ERR_OK) {
+                 return err;
+             }
+         }
+         return HAKO_PDU_ERR_OK;
+     }
      
-     // Method for derived classes to call when a raw packet is received
-     void on_raw_data_received(const std::vector<std::byte>& raw_data) {
-         auto packet = DataPacket::decode(raw_data, packet_version_);
-         if (!packet) {
+     // Send a frame encoded once and shared with other comms. Called with
+     // send_mutex_ held; the frame is not stamped. Override to queue the shared
+     // frame itself, or to stamp a copy of it.
+     virtual HakoPduErrorType raw_send_frame(const PduSharedFrame& frame) noexcept {
+         return raw_send(frame->bytes);
+     }
+
+     // Called with send_mutex_ held for every encoded frame, in transmit order.
+     // Override to patch header fields that must follow that order (sequence numbers).
+     virtual void raw_stamp_frame(std::vector<std::byte>& frame) noexcept {
+         (void)frame;
+     }
+     // Called for every decoded PDU_DATA_TYPE packet before on_recv_callback_;
+     // return false to drop it (e.g. an out-of-order sample).
+     virtual bool raw_accept_packet(const DataPacketView& packet) noexcept {
+         (void)packet;
+         return true;
+     }
+     // Called for every decoded packet that is not PDU_DATA_TYPE (control
+     // frames such as SESSION_REJECTED); the body aliases the receive buffer.
+     virtual void raw_on_control_packet(const DataPacketView& packet) noexcept {
+         (void)packet;
+         std::cerr << "WARNING: PDU packet ignored (non PDU_DATA_TYPE)." << std::endl;
+     }
+
+     // Method for derived classes to call when a raw packet is received.
+     // The frame is decoded in place; the body handed to on_recv_callback_
+     // aliases raw_data and is valid only for the duration of the callback.
+     // kernel_rx_ns is the socket receive timestamp when the transport has one.
+     void on_raw_data_received(std::span<const std::byte> raw_data, int64_t kernel_rx_ns = 0) {
+         DataPacketView packet;
+         if (!DataPacket::decode_view(raw_data, packet_version_, packet)) {
              // Decode error, maybe log it.
              return;
          }
-         if (!packet->is_pdu_data_type(packet_version_)) {
-             std::cerr << "WARNING: PDU packet ignored (non PDU_DATA_TYPE)." << std::endl;
+         if (!DataPacket::is_pdu_data_type(packet, packet_version_)) {
+             raw_on_control_packet(packet);
+             return;
+         }
+         if (!raw_accept_packet(packet)) {
              return;
          }
  
          if (on_recv_callback_) {
-             PduResolvedKey key;
-             key.robot = packet->get_robot_name();
-             key.channel_id = packet->get_channel_id();
-             const auto& pdu_data = packet->get_pdu_data();
+             // Reused per thread so steady-state receive does not allocate for the key.
+             thread_local PduResolvedKey key;
+             key.robot.assign(packet.robot_name.data(), packet.robot_name.size());
+             key.channel_id = static_cast<decltype(key.channel_id)>(packet.meta.channel_id);
              #ifdef ENABLE_DEBUG_MESSAGES
              std::cout << "DEBUG: PduCommRaw received PDU: robot=" << key.robot
                        << " channel=" << key.channel_id
-                       << " size=" << pdu_data.size() << std::endl;
+                       << " size=" << packet.body.size() << std::endl;
             #endif
-             on_recv_callback_(key, std::span<const std::byte>(pdu_data));
+             if (latency_tracking_) {
+                 PduRecvTimestamps& timestamps = current_recv_timestamps();
+                 timestamps.sent_real_time_us = packet.meta.real_time_us;
+                 timestamps.kernel_rx_ns = (kernel_rx_ns != 0) ? kernel_rx_ns : realtime_now_ns();
+             }
+             on_recv_callback_(key, packet.body);
          }
-         // Removed queue related code
      }
  
  private:
-     std::mutex send_mutex_; // Add mutex member
+     std::mutex send_mutex_; // Serializes raw_send only (frames must not interleave on streams)
      std::string packet_version_ = "v2";
+     bool latency_tracking_ = false;
 
      // Removed queue for synchronous recv
  };
@@ -1,10 +1,14 @@
 #pragma once
 
 #include "hakoniwa/pdu/comm/comm_raw.hpp"
+#include "hakoniwa/pdu/comm/io_uring_io.hpp"
+#include "hakoniwa/pdu/socket_utils.hpp"
 #include <netinet/in.h>
 #include <netdb.h> // For addrinfo
 #include <thread>
 #include <atomic>
+#include <memory>
+#include <random>
 #include <vector>
 #include <string>
 
@@ -28,14 +32,37 @@ protected:
     HakoPduErrorType raw_stop() noexcept override;
     HakoPduErrorType raw_is_running(bool& running) noexcept override;
     HakoPduErrorType raw_send(const std::vector<std::byte>& data) noexcept override;
+    HakoPduErrorType raw_send_batch(std::span<const std::vector<std::byte>> frames) noexcept override;
+    // SESSION_REJECTED from an admission-controlled server: log the reason and
+    // back off for the maximum reconnect delay before trying again.
+    void raw_on_control_packet(const DataPacketView& packet) noexcept override;
+
+public:
+    bool resync_on_connect() const noexcept override { return options_.resync_on_connect; }
+    // SO_RCVBUF of the connected socket; TCP never drops (the sender is flow controlled).
+    HakoPduErrorType get_socket_stats(PduCommSocketStats& stats) const noexcept override;
+    // Connections the server refused with a SESSION_REJECTED frame (client role).
+    uint64_t rejected_count() const noexcept { return rejected_count_.load(); }
 
 private:
     // Main loop for client/server threads
     void server_loop();
     void client_loop();
+    // Reads frames from a connected socket until it closes or the comm stops.
+    void read_loop(int fd);
+    // io_uring receive path; returns false when the caller must fall back to recv().
+    bool read_loop_uring(int fd);
+
+    // Connection established: notify the owner (resync) before reading.
+    void on_connected();
+    // Client reconnect delay: exponential backoff with jitter; sleeps end early on stop().
+    int next_reconnect_delay_ms(int& current_delay_ms);
+    void sleep_while_running(int delay_ms);
 
     // Helper methods
     HakoPduErrorType read_data(int fd, std::byte* buffer, size_t size) noexcept;
+    // recv() that also picks up the SO_TIMESTAMPNS of the read into last_rx_time_ns_.
+    ssize_t recv_timestamped(int fd, std::byte* buffer, size_t size) noexcept;
     HakoPduErrorType write_data(int fd, const std::byte* buffer, size_t size) noexcept;
 
     enum class Role {
@@ -56,6 +83,15 @@ private:
         int send_buffer_size = 8192;
         bool linger_enabled = false;
         int linger_timeout_sec = 0;
+        bool use_io_uring = false;
+        IoUringIo::Options io_uring;
+        // Client reconnect backoff: initial, initial*multiplier, ... capped at max, +/- jitter ratio.
+        int reconnect_initial_delay_ms = 50;
+        int reconnect_max_delay_ms = 1000;
+        double reconnect_multiplier = 2.0;
+        double reconnect_jitter = 0.2;
+        bool resync_on_connect = false;
+        bool latency_tracking = false; // stamp real_time_us on send, SO_TIMESTAMPNS on receive
     };
     HakoPduErrorType configure_socket_options(int fd, const Options& options) noexcept;
     HakoPduErrorType configure_timeouts(int fd, const Options& options) noexcept;
@@ -70,12 +106,23 @@ private:
     // Threading
     std::thread comm_thread_;
     std::atomic<bool> is_running_flag_{false};
+    WakeupFd wakeup_; // notified by raw_stop() so blocked waits return immediately
 
     HakoPduEndpointDirectionType config_direction_ = HAKO_PDU_ENDPOINT_DIRECTION_INOUT;
     sockaddr_storage remote_addr_info_{};
     socklen_t remote_addr_len_ = 0;
 
     std::atomic<bool> is_connected_{false};
+    std::atomic<uint64_t> rejected_count_{0};
+    bool rejected_ = false; // set by the read loop, consumed by client_loop; comm thread only
+    std::minstd_rand reconnect_rng_{std::random_device{}()};
+
+    // io_uring backend (optional, "io_backend": "io_uring"); null when the socket path is used
+    std::unique_ptr<IoUringIo> recv_uring_;
+    std::unique_ptr<IoUringIo> send_uring_;
+
+    // Kernel receive time of the latest read (latency tracking); recv thread only.
+    int64_t last_rx_time_ns_ = 0;
 };
 
 } // namespace comm
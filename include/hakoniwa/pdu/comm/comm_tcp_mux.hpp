@@ -1,9 +1,14 @@
 #pragma once
 
 #include "hakoniwa/pdu/comm/comm_mux.hpp"
+#include "hakoniwa/pdu/socket_utils.hpp"
 #include <atomic>
+#include <chrono>
+#include <cstddef>
 #include <mutex>
+#include <poll.h>
 #include <thread>
+#include <vector>
 
 namespace hakoniwa {
 namespace pdu {
@@ -11,6 +16,12 @@ namespace comm {
 
 // TCP mux comm: accept multiple TCP clients and expose each as a session comm.
 // Sessions are consumed via take_sessions() by the EndpointCommMultiplexer.
+// By default each session reads on its own thread; with "reactor" enabled
+// (Linux) the mux owns a few epoll loops and sessions are registered fds on
+// them, with incremental frame parsing and a bounded send queue per session.
+// "admission" caps the live sessions and the accept rate (token bucket); a
+// refused client is accepted, sent a SESSION_REJECTED frame and closed once
+// it has read the frame (lingering close on the accept thread).
 class TcpCommMultiplexer final : public CommMultiplexer
 {
 public:
@@ -26,9 +37,24 @@ public:
 
     size_t connected_count() const noexcept override;
     size_t expected_count() const noexcept override;
+    HakoPduErrorType get_admission_stats(CommMuxAdmissionStats& stats) const noexcept override;
 
 private:
+    struct Reactor;
+    class ReactorSession;
+
+    enum class Rejection { None, MaxSessions, Rate };
+
     void accept_loop_();
+    // Accept thread only: admission check and token bucket.
+    Rejection admit_() noexcept;
+    void reject_(int fd, Rejection reason) noexcept;
+    // Rejected sockets are half-closed and kept until the client closes its
+    // side (or kRejectLingerMs passes), so the reject frame is not lost to a
+    // RST from closing with unread client data. Accept thread only.
+    void linger_close_(int fd) noexcept;
+    void drain_closing_(const pollfd* fds, bool expire_all) noexcept;
+    int closing_timeout_ms_() const noexcept;
 
     struct Options {
         int backlog = 5;
@@ -42,18 +68,48 @@ private:
         int send_buffer_size = 8192;
         bool linger_enabled = false;
         int linger_timeout_sec = 0;
+        bool reactor_enabled = false;
+        int reactor_threads = 0; // 0 = one loop per hardware thread, up to kMaxReactorThreads
+        size_t reactor_max_send_queue_bytes = 4 * 1024 * 1024;
+        size_t max_sessions = 0;    // 0 = unlimited
+        double accept_rate = 0.0;   // new sessions per second; 0 = unlimited
+        double accept_burst = 0.0;  // token bucket size; 0 = max(1, accept_rate)
+        bool reject_reason = true;  // send a SESSION_REJECTED frame (v2) before closing
     };
+    static constexpr int kMaxReactorThreads = 16;
+    static constexpr int kRejectLingerMs = 1000;
+    static constexpr size_t kMaxClosingSockets = 64; // oldest is closed early beyond this
 
     HakoPduErrorType configure_socket_options_(int fd, const Options& options) noexcept;
 
     std::atomic<int> listen_fd_{-1};
     std::atomic<bool> is_running_{false};
+    WakeupFd wakeup_; // notified by stop() to end accept_loop_
     std::thread accept_thread_;
+    // epoll loops shared with the reactor sessions; outlives the mux while they run.
+    std::shared_ptr<Reactor> reactor_;
+    // Parsed at open(); sessions configure themselves from it instead of the file.
+    std::shared_ptr<const nlohmann::json> session_config_;
 
     Options options_{};
     size_t expected_clients_ = 0;
     std::atomic<size_t> connected_clients_{0};
 
+    // Admission: live sessions are counted down by the sessions themselves.
+    std::shared_ptr<std::atomic<size_t>> live_sessions_ = std::make_shared<std::atomic<size_t>>(0);
+    std::atomic<uint64_t> accepted_total_{0};
+    std::atomic<uint64_t> rejected_max_sessions_{0};
+    std::atomic<uint64_t> rejected_rate_{0};
+    double accept_tokens_ = 0.0;
+    std::chrono::steady_clock::time_point accept_refill_at_{};
+    std::vector<std::byte> reject_frame_max_sessions_; // empty: close without a frame
+    std::vector<std::byte> reject_frame_rate_;
+    struct ClosingSocket {
+        int fd;
+        std::chrono::steady_clock::time_point deadline;
+    };
+    std::vector<ClosingSocket> closing_; // capacity kMaxClosingSockets, reserved at start()
+
     mutable std::mutex sessions_mutex_;
     std::vector<std::shared_ptr<PduComm>> pending_sessions_;
 };
@@ -1,13 +1,20 @@
 #pragma once
 
 #include "hakoniwa/pdu/comm/comm_raw.hpp" // Change base class
+#include "hakoniwa/pdu/comm/io_uring_io.hpp"
 #include "hakoniwa/pdu/endpoint_types.hpp"
+#include "hakoniwa/pdu/socket_utils.hpp"
 #include <netinet/in.h>
 #include <string>
 #include <thread>
 #include <vector>
 #include <atomic>
+#include <chrono>
 #include <memory> // std::unique_ptr for DataPacket in PduCommRaw
+#include <mutex>
+#include <map>
+#include <unordered_map>
+#include <span>
 
 namespace hakoniwa {
 namespace pdu {
@@ -15,12 +22,19 @@ namespace comm { // Add comm namespace
 
 // UDP comm: connectionless transport with explicit direction and PDU key.
 // Framing uses PduCommRaw (v1/v2) and a configured PDU key for routing.
+// With "receiver_threads" > 1 the receive callback is called concurrently from
+// several recv threads and must be thread-safe.
 class UdpComm final : public PduCommRaw // Change base class
 {
 public:
     UdpComm();
     virtual ~UdpComm();
 
+    // Loss/reorder counters per (robot, channel); needs "sequence_numbers": true.
+    HakoPduErrorType get_channel_stats(std::vector<PduChannelStats>& stats) const noexcept override;
+    // Kernel receive-queue drops (summed over receive sockets) and SO_RCVBUF.
+    HakoPduErrorType get_socket_stats(PduCommSocketStats& stats) const noexcept override;
+
 protected: // Implement PduCommRaw's pure virtual raw_* methods
     HakoPduErrorType raw_open(const std::string& config_path) override;
     HakoPduErrorType raw_close() noexcept override;
@@ -28,11 +42,71 @@ protected: // Implement PduCommRaw's pure virtual raw_* methods
     HakoPduErrorType raw_stop() noexcept override;
     HakoPduErrorType raw_is_running(bool& running) noexcept override;
     HakoPduErrorType raw_send(const std::vector<std::byte>& data) noexcept override; // Added noexcept
+    HakoPduErrorType raw_send_batch(std::span<const std::vector<std::byte>> frames) noexcept override;
+    HakoPduErrorType raw_send_frame(const PduSharedFrame& frame) noexcept override;
+    void raw_stamp_frame(std::vector<std::byte>& frame) noexcept override;
+    bool raw_accept_packet(const DataPacketView& packet) noexcept override;
     // recv is now handled by PduCommRaw
 
 private:
-    // 受信スレッドのメインループ
-    void recv_loop();
+    struct Receiver;
+    struct ReassemblyState;
+    // One send address: an entry of "remote"/"remotes" or a channel's multicast group.
+    struct Destination {
+        sockaddr_storage addr{};
+        socklen_t len = 0;
+    };
+    // 受信スレッドのメインループ (one per receive socket)
+    void recv_loop(Receiver& receiver);
+    // io_uring receive path; returns false when the caller must fall back to recvfrom.
+    bool recv_loop_uring_(Receiver& receiver);
+    // recvmmsg receive path (recv_batch > 1, Linux); returns false when unavailable.
+    bool recv_loop_mmsg_(Receiver& receiver);
+    // Default single target: "remote", or the latest client in inout mode (copied).
+    HakoPduErrorType resolve_send_target_(Destination& target) noexcept;
+    // Route already encoded frames: per-channel group or the default targets, fragmenting oversized ones.
+    HakoPduErrorType send_routed_(int fd, std::span<const std::vector<std::byte>> frames) noexcept;
+    // robot_id (optional): fragment_robot_id of the frame's robot name.
+    bool frame_channel_id_(const std::vector<std::byte>& frame, uint32_t& channel_id,
+                           uint32_t* robot_id = nullptr) const noexcept;
+    // rx_time_ns: SO_TIMESTAMPNS of the read (0 if unavailable), for latency tracking.
+    void on_datagram_(Receiver& receiver, std::span<const std::byte> data, const sockaddr* from, socklen_t from_len,
+                      int64_t rx_time_ns = 0);
+    // Send encoded frames to every target: io_uring, GSO, sendmmsg or sendto, whichever is configured.
+    // Several targets share one sendmmsg call (same iovec, different msg_name).
+    HakoPduErrorType send_frames_(int fd, std::span<const std::vector<std::byte>> frames,
+                                  std::span<const Destination> targets) noexcept;
+    // Split a frame larger than fragmentation.max_datagram_size into fragment datagrams.
+    HakoPduErrorType send_fragmented_(int fd, const std::vector<std::byte>& frame,
+                                      std::span<const Destination> targets) noexcept;
+    void on_fragment_(ReassemblyState& reassembly, std::span<const std::byte> data, const sockaddr* from,
+                      socklen_t from_len, int64_t rx_time_ns);
+    // Discard partial messages older than reassembly_timeout_ms and free quiet streams.
+    void expire_reassembly_(ReassemblyState& reassembly) noexcept;
+    // Receive poll interval: timeout_ms, shortened to the reassembly timeout when fragmentation is on.
+    int recv_poll_ms_(const Receiver& receiver) const noexcept;
+    // SO_RXQ_OVFL counter seen on a read; grows SO_RCVBUF during warm-up when auto-tune is on.
+    void on_rxq_drops_(Receiver& receiver, uint32_t drops) noexcept;
+    // UDP_SEGMENT send of runs of equal-sized frames; UNSUPPORTED if the kernel rejects GSO.
+    HakoPduErrorType send_batch_gso_(int fd, std::span<const std::vector<std::byte>> frames,
+                                     const sockaddr* target_addr, socklen_t target_addr_len) noexcept;
+
+    // Application-level fragmentation ("fragmentation" option block).
+    struct FragmentOptions {
+        bool enabled = false;
+        size_t max_datagram_size = 1472;       // fragment size on the wire, header included
+        int reassembly_timeout_ms = 200;       // incomplete messages older than this are discarded
+        size_t max_message_size = 16 * 1024 * 1024;
+        bool latest_wins = true;               // a newer message drops the incomplete older one
+        int max_streams = 8;                   // (sender, robot, channel) messages reassembled at once per receive socket
+    };
+
+    // Receive buffer auto-tune ("rcvbuf_autotune" option block).
+    struct RecvBufferAutotune {
+        bool enabled = false;
+        int max_size = 8 * 1024 * 1024; // largest SO_RCVBUF to request
+        int warmup_ms = 10000;          // drops after this long from start() no longer grow it (0 = always)
+    };
 
     // 内部オプション構造体 (remains the same)
     struct Options {
@@ -45,8 +119,29 @@ private:
         std::string multicast_group;
         std::string multicast_interface = "0.0.0.0";
         int multicast_ttl = 1;
+        std::map<uint32_t, std::string> multicast_channel_groups; // channel_id -> group address
+        std::vector<uint32_t> multicast_subscribe_channels;       // empty = join every mapped group
+        int multicast_port = 0;                                   // 0 = port of "remote"
+        bool use_io_uring = false;
+        IoUringIo::Options io_uring;
+        int recv_batch = 1;   // datagrams per recvmmsg (1 = recvfrom); 64 KiB per slot
+        int send_batch = 32;  // datagrams per sendmmsg in raw_send_batch (1 = sendto)
+        bool gso = false;     // UDP_SEGMENT for send_batch() (Linux)
+        bool gro = false;     // UDP_GRO on receive (Linux)
+        FragmentOptions fragmentation;
+        bool sequence_numbers = false; // stamp on send, drop stale samples on receive (v2 only)
+        int receiver_threads = 1;      // SO_REUSEPORT receive sockets, one recv thread each (callbacks run concurrently)
+        RecvBufferAutotune rcvbuf_autotune;
+        bool latency_tracking = false; // stamp real_time_us on send, SO_TIMESTAMPNS on receive
     };
-    HakoPduErrorType configure_socket_options(const Options& options) noexcept;
+    HakoPduErrorType configure_socket_options(int fd, const Options& options) noexcept;
+    // Create receivers_: socket_fd_ plus receiver_threads - 1 extra sockets bound to local_addr.
+    HakoPduErrorType open_receivers_(const Options& options, const addrinfo* local_addr) noexcept;
+    void configure_segmentation_offload(const Options& options) noexcept;
+    // Enable SO_RXQ_OVFL on the receive sockets and record their SO_RCVBUF.
+    void configure_drop_accounting(const Options& options) noexcept;
+    // "latency_tracking": enable SO_TIMESTAMPNS on the receive sockets.
+    void configure_rx_timestamps(const Options& options) noexcept;
     HakoPduErrorType configure_multicast(const Options& options) noexcept;
 
     // ソケットとアドレス関連 (remains the same)
@@ -54,13 +149,60 @@ private:
     sockaddr_storage dest_addr_{};
     socklen_t dest_addr_len_ = 0;
     bool has_fixed_remote_ = false;
-    sockaddr_storage last_client_addr_{};
-    socklen_t last_client_addr_len_ = 0;
+    // inout without "remote": receiver whose reply address is the latest client.
+    std::atomic<Receiver*> reply_receiver_{nullptr};
     HakoPduEndpointDirectionType config_direction_ = HAKO_PDU_ENDPOINT_DIRECTION_INOUT;
+    // Fan-out: "remote" plus "remotes" when more than one destination is configured
+    // (empty otherwise, and dest_addr_ is used). Frames are encoded once and sent to all.
+    std::vector<Destination> destinations_;
+    // Multicast "channel_groups": frames of a mapped channel go to its group only.
+    std::unordered_map<uint32_t, Destination> channel_groups_;
+
+    // io_uring send ring (optional, "io_backend": "io_uring"); null when the socket path is used.
+    // Receive rings live in the receivers.
+    std::unique_ptr<IoUringIo> send_uring_;
+    int recv_timeout_ms_ = 1000;
+
+    // Preallocated recvmmsg/sendmmsg slots (Linux); sized once in raw_open.
+    struct MmsgSlots;
+    std::unique_ptr<MmsgSlots> send_slots_; // used under PduCommRaw's send lock
+    bool gso_enabled_ = false;
+    bool gro_enabled_ = false;
+
+    // Fragmentation: send side state is used under PduCommRaw's send lock,
+    // reassembly state only by its receiver's recv thread.
+    FragmentOptions fragmentation_;
+    uint32_t next_message_id_ = 0;
+    std::vector<std::vector<std::byte>> fragment_frames_;
+
+    // Sequence numbers: tx_sequences_ is used under PduCommRaw's send lock and
+    // has a counter per defined channel from open(); the epoch (random per
+    // open) lets the receiver detect a restarted sender.
+    bool sequence_numbers_ = false;
+    uint32_t sequence_epoch_ = 0;
+    std::unordered_map<PduResolvedKey, uint64_t, PduResolvedKeyHash> tx_sequences_;
+    PduResolvedKey tx_sequence_key_;
+    struct RxSequence {
+        uint32_t epoch = 0;
+        PduChannelStats stats;
+    };
+    mutable std::mutex rx_sequence_mutex_; // recv thread vs get_channel_stats()
+    std::unordered_map<PduResolvedKey, RxSequence, PduResolvedKeyHash> rx_sequences_;
+    PduResolvedKey rx_sequence_key_;
+
+    // Drop accounting: the counters live in the receivers; auto-tune only runs on recv threads.
+    bool rxq_ovfl_enabled_ = false;
+    RecvBufferAutotune rcvbuf_autotune_;
+    std::chrono::steady_clock::time_point recv_started_{};
+    std::atomic<uint32_t> recv_buffer_grows_{0};
+    bool rx_timestamps_enabled_ = false; // SO_TIMESTAMPNS cmsgs requested on the receive sockets
 
     // スレッド関連 (pdu_key_ is now in PduCommRaw)
-    std::thread recv_thread_;
+    // Receive sockets: [0] is socket_fd_, the rest are extra SO_REUSEPORT sockets
+    // ("receiver_threads"). Each has its own thread, slots, ring and reassembly state.
+    std::vector<std::unique_ptr<Receiver>> receivers_;
     std::atomic<bool> is_running_flag_{false}; // Renamed to avoid confusion with raw_is_running
+    WakeupFd wakeup_; // notified by raw_stop() to end recv_loop without waiting for timeout_ms
     // queue_mtx_, queue_cv_, data_queue_ removed (now in PduCommRaw)
 };
 
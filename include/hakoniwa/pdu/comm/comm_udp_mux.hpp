@@ -0,0 +1,90 @@
+#pragma once
+
+#include "hakoniwa/pdu/comm/comm_mux.hpp"
+#include "hakoniwa/pdu/socket_utils.hpp"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <netinet/in.h>
+#include <thread>
+#include <unordered_map>
+
+namespace hakoniwa {
+namespace pdu {
+namespace comm {
+
+// UDP mux comm: one bound socket and one recv thread serve many peers. Each new
+// peer address whose first datagram decodes as a PDU becomes a session comm
+// (replies go to that peer only), up to "max_peers" live peers; sessions are
+// consumed via take_sessions() by the EndpointCommMultiplexer and expire after
+// "idle_timeout_ms" without a datagram from the peer.
+class UdpCommMultiplexer final : public CommMultiplexer
+{
+public:
+    UdpCommMultiplexer();
+    ~UdpCommMultiplexer();
+
+    HakoPduErrorType open(const std::string& config_path) override;
+    HakoPduErrorType close() noexcept override;
+    HakoPduErrorType start() noexcept override;
+    HakoPduErrorType stop() noexcept override;
+
+    std::vector<std::shared_ptr<PduComm>> take_sessions() override;
+
+    // Live (not yet expired) peers.
+    size_t connected_count() const noexcept override;
+    size_t expected_count() const noexcept override;
+    // accepted: peers that became sessions; rejected_max_sessions: datagrams
+    // from new peers dropped because max_peers were live.
+    HakoPduErrorType get_admission_stats(CommMuxAdmissionStats& stats) const noexcept override;
+
+private:
+    class Session;
+    struct SharedSocket;
+
+    struct PeerKey {
+        sockaddr_storage addr{};
+        socklen_t len = 0;
+        bool operator==(const PeerKey& other) const noexcept;
+    };
+    struct PeerKeyHash {
+        size_t operator()(const PeerKey& key) const noexcept;
+    };
+
+    struct Options {
+        int buffer_size = 8192;
+        bool reuse_address = true;
+        int idle_timeout_ms = 30000; // 0 = peers never expire
+        size_t max_peers = 0;        // 0 = unlimited
+    };
+
+    void recv_loop_();
+    void on_datagram_(const PeerKey& peer, std::span<const std::byte> data, std::chrono::steady_clock::time_point now);
+    void expire_idle_(std::chrono::steady_clock::time_point now) noexcept;
+    HakoPduErrorType configure_socket_options_(int fd, const Options& options) noexcept;
+
+    std::shared_ptr<SharedSocket> socket_; // shared with the sessions, which send through it
+    // Parsed at open(); sessions configure themselves from it instead of the file.
+    std::shared_ptr<const nlohmann::json> session_config_;
+    std::atomic<bool> is_running_{false};
+    WakeupFd wakeup_; // notified by stop() to end recv_loop_
+    std::thread recv_thread_;
+
+    Options options_{};
+    std::string packet_version_ = "v2"; // "comm_raw_version", to decode a new peer's first datagram
+    size_t expected_clients_ = 0;
+    std::atomic<size_t> connected_clients_{0};
+    std::atomic<uint64_t> accepted_peers_{0};
+    std::atomic<uint64_t> rejected_max_peers_{0};
+
+    // Peer table: touched only by the recv thread (and close() after it has stopped).
+    std::unordered_map<PeerKey, std::shared_ptr<Session>, PeerKeyHash> peers_;
+    std::chrono::steady_clock::time_point last_expiry_scan_{};
+
+    mutable std::mutex sessions_mutex_;
+    std::vector<std::shared_ptr<PduComm>> pending_sessions_;
+};
+
+} // namespace comm
+} // namespace pdu
+} // namespace hakoniwa
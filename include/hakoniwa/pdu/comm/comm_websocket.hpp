@@ -5,11 +5,14 @@
 #include <vector>
 #include <thread>
 #include <atomic>
+#include <functional>
 #include <memory>
+#include <span>
 #include <boost/asio.hpp>
 #include <boost/beast.hpp>
 #include <boost/beast/websocket.hpp>
 #include <boost/beast/http.hpp>
+#include <nlohmann/json.hpp>
 
 namespace hakoniwa {
 namespace pdu {
@@ -21,20 +24,54 @@ namespace websocket = beast::websocket;
 namespace http = beast::http;
 using tcp = net::ip::tcp;
 
+// Sessions run on a strand of the comm's io_context. The concrete executor type
+// (instead of any_io_executor) keeps asio from boxing the strand on the heap
+// every time an operation copies the executor.
+using WebSocketExecutor = net::strand<net::io_context::executor_type>;
+using WebSocketSocket = tcp::socket::rebind_executor<WebSocketExecutor>::other;
+using WebSocketStream = beast::basic_stream<tcp, WebSocketExecutor>;
+
 // Forward declaration for the session class that handles a single WebSocket connection
 class WebSocketSession;
+class WebSocketCommMultiplexer;
+
+// Encoded frame queued for writing. Immutable and reference counted, so a
+// broadcast copies the frame once no matter how many sessions it goes to, and
+// a mux group send (send_frame) queues the caller's frame without any copy.
+// key is only needed when the send queue conflates per channel.
+using WebSocketOutFrame = PduEncodedFrame;
+using WebSocketFrame = PduSharedFrame;
+
+// Snapshot of one session's write queue.
+struct WebSocketSessionStats {
+    uint64_t id = 0;
+    std::string remote;          // peer address:port
+    size_t queued_messages = 0;  // including the frame being written
+    size_t queued_bytes = 0;
+    uint64_t sent = 0;           // frames fully written
+    uint64_t dropped = 0;        // frames discarded by the drop_oldest limit
+    uint64_t conflated = 0;      // queued frames replaced by a newer one of the same channel
+};
 
-// WebSocket comm: stream semantics over WebSocket (client/server roles).
+// WebSocket comm: stream semantics over WebSocket (client/server roles, or one
+// client of a WebSocketCommMultiplexer).
 // Packet framing is handled by PduCommRaw (v1/v2).
 class WebSocketComm final : public PduCommRaw
 {
     friend class WebSocketSession;
+    friend class WebSocketCommMultiplexer;
 public:
     WebSocketComm();
     virtual ~WebSocketComm();
     
-    // Method for session to call back to when data is received
-    void on_session_data_received(const std::vector<std::byte>& data);
+    // Method for session to call back to when a message is received. data aliases
+    // the session's read buffer and is valid only for the duration of the call.
+    void on_session_data_received(std::span<const std::byte> data);
+
+    // Write queue depth and drop counters of the current sessions.
+    HakoPduErrorType get_session_stats(std::vector<WebSocketSessionStats>& stats) const noexcept;
+    // Sessions closed because their queue overflowed with the "disconnect" policy.
+    uint64_t slow_consumer_disconnects() const noexcept { return slow_consumer_disconnects_.load(); }
 
 protected:
     // PduCommRaw's pure virtual methods implementation
@@ -44,16 +81,28 @@ protected:
     HakoPduErrorType raw_stop() noexcept override;
     HakoPduErrorType raw_is_running(bool& running) noexcept override;
     HakoPduErrorType raw_send(const std::vector<std::byte>& data) noexcept override;
+    HakoPduErrorType raw_send_frame(const PduSharedFrame& frame) noexcept override;
 
 protected:
     enum class Role {
         Client,
-        Server
+        Server,
+        MuxSession // one client accepted by WebSocketCommMultiplexer
     };
 
+    // Mux session: runs on the multiplexer's io_context instead of owning one.
+    explicit WebSocketComm(std::shared_ptr<net::io_context> ioc);
+    // Take over a socket accepted by the multiplexer and start the server handshake.
+    // notify(comm, true) follows a completed handshake, notify(comm, false) the end
+    // of the session (a failed handshake included).
+    using MuxNotify = std::function<void(const std::shared_ptr<WebSocketComm>&, bool connected)>;
+    void attach_mux_session_(WebSocketSocket socket, const std::string& remote, MuxNotify notify);
+    void on_mux_handshake_();
+    void notify_mux_closed_() noexcept;
+
     // Server methods
     void do_accept();
-    void on_accept(beast::error_code ec, tcp::socket socket);
+    void on_accept(beast::error_code ec, WebSocketSocket socket);
 
     // Client methods
     void do_connect();
@@ -61,13 +110,43 @@ protected:
     void on_connect(beast::error_code ec, tcp::resolver::results_type::endpoint_type endpoint);
     void on_handshake(beast::error_code ec);
 
+    // Per-session write queue limits ("send_queue" option block); 0 = unlimited.
+    struct SendQueueOptions {
+        enum class Policy {
+            DropOldest, // discard the oldest unsent frame
+            Conflate,   // keep only the latest unsent frame per channel, then drop oldest
+            Disconnect  // close the slow session
+        };
+        size_t max_messages = 0;
+        size_t max_bytes = 0;
+        Policy policy = Policy::DropOldest;
+    };
+
+    // permessage-deflate ("permessage_deflate" option block); negotiated per session.
+    struct DeflateOptions {
+        bool enabled = false;
+        int window_bits = 15;        // 9..15, offered as server/client_max_window_bits
+        int compression_level = 8;   // zlib level 0..9
+        int mem_level = 4;           // zlib memLevel 1..9
+        bool no_context_takeover = false;
+        size_t min_size = 0;         // smaller messages are sent uncompressed (Boost >= 1.80)
+    };
+
     // Common state
     Role role_ = Role::Client;
+    SendQueueOptions send_queue_{};
+    DeflateOptions deflate_{};
+    std::atomic<uint64_t> next_session_id_{1};
+    std::atomic<uint64_t> slow_consumer_disconnects_{0};
     HakoPduEndpointDirectionType config_direction_ = HAKO_PDU_ENDPOINT_DIRECTION_INOUT;
     
     // Boost.Asio & Beast core components
-    net::io_context ioc_;
-    std::thread comm_thread_;
+    // ioc_ is run by io_threads_ ("io_threads", default 1). Every session lives on
+    // its own strand, so its handlers never run concurrently and stay in order.
+    // Mux sessions share the multiplexer's io_context and have no io threads.
+    std::shared_ptr<net::io_context> ioc_;
+    int io_thread_count_ = 1;
+    std::vector<std::thread> io_threads_;
     std::atomic<bool> is_running_flag_{false};
     std::optional<net::executor_work_guard<net::io_context::executor_type>> work_guard_; // Only one declaration
 
@@ -83,7 +162,12 @@ protected:
 
     // Session management
     std::vector<std::shared_ptr<WebSocketSession>> sessions_; // For server: stores multiple sessions; for client: stores one session.
-    std::mutex sessions_mtx_;
+    mutable std::mutex sessions_mtx_;
+
+    // Mux session callback; cleared once the session has ended.
+    MuxNotify mux_notify_;
+    // Mux session: the mux's parsed config, used by raw_open() instead of the file.
+    std::shared_ptr<const nlohmann::json> mux_config_;
     
 public:
     // Method for session to call back to when it's closed
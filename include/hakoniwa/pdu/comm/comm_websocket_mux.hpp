@@ -0,0 +1,62 @@
+#pragma once
+
+#include "hakoniwa/pdu/comm/comm_mux.hpp"
+#include "hakoniwa/pdu/comm/comm_websocket.hpp"
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace hakoniwa {
+namespace pdu {
+namespace comm {
+
+// WebSocket mux comm: one listener and one io_context thread pool ("io_threads")
+// serve every client. Each client that completes the WebSocket handshake becomes
+// its own session comm (sends go to that client only); sessions are consumed via
+// take_sessions() by the EndpointCommMultiplexer. A session reads nothing until
+// its endpoint starts, and connected_count() drops when its client disconnects.
+class WebSocketCommMultiplexer final : public CommMultiplexer
+{
+public:
+    WebSocketCommMultiplexer();
+    ~WebSocketCommMultiplexer();
+
+    HakoPduErrorType open(const std::string& config_path) override;
+    HakoPduErrorType close() noexcept override;
+    // start() also runs the io threads. stop() only stops accepting: the threads
+    // keep running (after close() too) until no taken session is left.
+    HakoPduErrorType start() noexcept override;
+    HakoPduErrorType stop() noexcept override;
+
+    std::vector<std::shared_ptr<PduComm>> take_sessions() override;
+
+    // Clients with a completed handshake that have not disconnected.
+    size_t connected_count() const noexcept override;
+    size_t expected_count() const noexcept override;
+
+private:
+    struct Shared;
+
+    void do_accept_();
+    void on_accept_(beast::error_code ec, WebSocketSocket socket);
+    // Session comm callback: handshake done (connected) or session ended.
+    // `comm` is the session's address, still valid when it ends in its destructor.
+    static void on_session_(const std::shared_ptr<Shared>& shared, const WebSocketComm* comm, bool connected);
+
+    // io_context, io threads and session lists; they outlive the mux while
+    // taken session comms still use them.
+    std::shared_ptr<Shared> shared_;
+    std::unique_ptr<tcp::acceptor> acceptor_; // on a strand
+    std::atomic<bool> is_running_{false};
+    std::atomic<bool> accept_armed_{false}; // an accept is pending or about to be
+
+    int io_thread_count_ = 1;
+    size_t expected_clients_ = 0;
+    WebSocketComm::DeflateOptions deflate_{};
+    // Parsed at open(); sessions configure themselves from it instead of the file.
+    std::shared_ptr<const nlohmann::json> session_config_;
+};
+
+} // namespace comm
+} // namespace pdu
+} // namespace hakoniwa
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "hakoniwa/pdu/comm/packet.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace hakoniwa {
+namespace pdu {
+namespace comm {
+
+// Incremental v1/v2 frame parser for stream transports.
+// Bytes can arrive in arbitrary chunks; every complete frame is handed to the
+// callback as one contiguous buffer. The internal buffer keeps its capacity,
+// so steady-state parsing does not allocate.
+class StreamFrameAssembler
+{
+public:
+    static constexpr uint32_t kMaxV1PacketSize = 4 * 1024 * 1024;
+
+    explicit StreamFrameAssembler(std::string version = "v2") : version_(std::move(version)) {}
+
+    void reset() noexcept
+    {
+        frame_.clear();
+        expected_size_ = 0;
+    }
+
+    // Returns false on a framing error (the stream must be dropped).
+    template <typename OnFrame>
+    bool feed(std::span<const std::byte> data, OnFrame&& on_frame)
+    {
+        while (!data.empty()) {
+            const size_t target = (expected_size_ == 0) ? header_size_() : expected_size_;
+            const size_t take = std::min(target - frame_.size(), data.size());
+            frame_.insert(frame_.end(), data.begin(), data.begin() + take);
+            data = data.subspan(take);
+            if (frame_.size() < target) {
+                break;
+            }
+            if (expected_size_ == 0) {
+                if (!compute_frame_size_()) {
+                    reset();
+                    return false;
+                }
+                if (frame_.size() < expected_size_) {
+                    continue;
+                }
+            }
+            on_frame(static_cast<const std::vector<std::byte>&>(frame_));
+            frame_.clear();
+            expected_size_ = 0;
+        }
+        return true;
+    }
+
+private:
+    size_t header_size_() const noexcept
+    {
+        return (version_ == "v1") ? sizeof(uint32_t) : sizeof(MetaPdu);
+    }
+
+    bool compute_frame_size_() noexcept
+    {
+        uint32_t value = 0;
+        if (version_ == "v1") {
+            value = read_le32_(frame_.data());
+            if (value == 0 || value > kMaxV1PacketSize) {
+                return false;
+            }
+            expected_size_ = sizeof(uint32_t) + value;
+            return true;
+        }
+        value = read_le32_(frame_.data() + offsetof(MetaPdu, body_len));
+        expected_size_ = sizeof(MetaPdu) + value;
+        return true;
+    }
+
+    static uint32_t read_le32_(const std::byte* data) noexcept
+    {
+        return static_cast<uint32_t>(std::to_integer<unsigned char>(data[0]))
+            | (static_cast<uint32_t>(std::to_integer<unsigned char>(data[1])) << 8)
+            | (static_cast<uint32_t>(std::to_integer<unsigned char>(data[2])) << 16)
+            | (static_cast<uint32_t>(std::to_integer<unsigned char>(data[3])) << 24);
+    }
+
+    std::string version_;
+    std::vector<std::byte> frame_;
+    size_t expected_size_ = 0;
+};
+
+} // namespace comm
+} // namespace pdu
+} // namespace hakoniwa
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "hakoniwa/pdu/endpoint_types.hpp"
+#include <nlohmann/json.hpp>
+#include <sys/socket.h>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace hakoniwa {
+namespace pdu {
+namespace comm {
+
+// Optional io_uring I/O backend used by socket comms (TCP/UDP).
+// Available only when the library is built with liburing on Linux. When it is
+// not compiled in, or the kernel refuses to create the ring, init() fails and
+// the comm keeps using its plain socket path.
+//
+// One instance is owned by one thread at a time: the recv thread drives
+// run_recv(), and senders call send_batch() under the comm send lock.
+class IoUringIo
+{
+public:
+    struct Options {
+        unsigned queue_depth = 256;
+        unsigned buffer_count = 64;
+        size_t buffer_size = 65536 + 512;
+    };
+    using RecvHandler = std::function<void(std::span<const std::byte> data, const sockaddr* from, socklen_t from_len)>;
+
+    IoUringIo();
+    ~IoUringIo();
+    IoUringIo(const IoUringIo&) = delete;
+    IoUringIo& operator=(const IoUringIo&) = delete;
+
+    // True when the library was built with liburing.
+    static bool is_compiled_in() noexcept;
+
+    // Create the ring. with_recv_buffers registers a provided-buffer ring of
+    // buffer_count * buffer_size bytes for multishot receive.
+    HakoPduErrorType init(const Options& options, bool with_recv_buffers) noexcept;
+    void shutdown() noexcept;
+    bool is_initialized() const noexcept;
+
+    // Blocking receive loop on fd: multishot recv (stream) or recvmsg (datagram)
+    // into the registered buffers. `running` is re-checked every poll_interval_ms;
+    // a readable wakeup_fd (see WakeupFd) ends the loop immediately, and on_idle
+    // (if set) is called each time poll_interval_ms passes without a completion.
+    // Returns HAKO_PDU_ERR_OK when stopped, HAKO_PDU_ERR_IO_ERROR on EOF/error and
+    // HAKO_PDU_ERR_UNSUPPORTED when the kernel rejects multishot receive.
+    HakoPduErrorType run_recv(int fd, bool datagram, const std::atomic<bool>& running,
+                              int poll_interval_ms, const RecvHandler& on_data,
+                              int wakeup_fd = -1, const std::function<void()>& on_idle = {}) noexcept;
+
+    // Submit all frames with a single io_uring_enter and wait for completion.
+    // Stream sockets get linked sends (ordered, short writes resumed);
+    // datagram sockets get one sendmsg per frame to `to` (nullptr if connected).
+    HakoPduErrorType send_batch(int fd, std::span<const std::vector<std::byte>> frames,
+                                const sockaddr* to, socklen_t to_len, bool datagram) noexcept;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// Parse "io_backend" ("socket" | "io_uring") and the optional "io_uring" block
+// from a comm "options" object.
+HakoPduErrorType parse_io_backend_options(const nlohmann::json& options, bool& use_io_uring,
+                                          IoUringIo::Options& uring_options);
+
+} // namespace comm
+} // namespace pdu
+} // namespace hakoniwa
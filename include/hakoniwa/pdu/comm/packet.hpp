@@ -7,6 +7,8 @@
 #include <memory>
 #include <algorithm>
 #include <cstring>
+#include <span>
+#include <string_view>
 #include <arpa/inet.h> // For htonl, ntohl
 
 namespace hakoniwa {
@@ -24,6 +26,11 @@ constexpr size_t META_V2_FIXED_SIZE = 176;
 constexpr size_t PDU_META_DATA_SIZE = 128;
 constexpr size_t TOTAL_PDU_META_SIZE = PDU_META_DATA_SIZE + META_V2_FIXED_SIZE; // 304 bytes
 
+// MetaPdu.flags bits (v2 only).
+// HAKO_META_FLAG_SEQUENCE: padding[0..7] holds a per-(robot, channel) sequence
+// number and padding[8..11] the sender's epoch, both little endian.
+constexpr uint32_t HAKO_META_FLAG_SEQUENCE = 0x00000001;
+
 enum MetaRequestType : uint32_t {
     PDU_DATA_TYPE = 0x42555043,   // "CPUB"
     DECLARE_PDU_FOR_READ = 0x52455044,   // "REPD"
@@ -32,6 +39,7 @@ enum MetaRequestType : uint32_t {
     REGISTER_RPC_CLIENT    = 0x43505244,   // "DRPC"
     PDU_DATA_RPC_REQUEST     = 0x43505243,   // "CRPC"
     PDU_DATA_RPC_REPLY       = 0x43505253,   // "SRPC"
+    SESSION_REJECTED         = 0x54434A52,   // "RJCT": body is the reason text
 };
 
 
@@ -60,6 +68,15 @@ struct MetaPdu {
 static_assert(sizeof(MetaPdu) == TOTAL_PDU_META_SIZE, "MetaPdu size is not correct");
 
 
+// Non-owning result of DataPacket::decode_view(). robot_name and body point into
+// the decoded buffer (body) or into this view (robot_name for v2), so the view is
+// valid only while both are alive and unmoved.
+struct DataPacketView {
+    MetaPdu meta{};                    // host byte order; v1 frames only fill channel_id
+    std::string_view robot_name;
+    std::span<const std::byte> body;
+};
+
 class DataPacket {
 public:
     DataPacket() {
@@ -97,26 +114,35 @@ public:
     const std::vector<std::byte>& get_pdu_data() const { return body_data_; }
     const MetaPdu& get_meta() const { return meta_pdu_; }
     bool is_pdu_data_type(const std::string& version) const noexcept {
-        if (version == "v1") {
-            // v1 has no explicit type field; we infer "data" by excluding known control magic numbers.
-            // This is best-effort and can misclassify payloads that start with those values.
-            if (body_data_.size() < sizeof(uint32_t)) {
-                return true;
-            }
-            const uint32_t type = read_le32(body_data_.data());
-            return type != static_cast<uint32_t>(MetaRequestType::DECLARE_PDU_FOR_READ)
-                && type != static_cast<uint32_t>(MetaRequestType::DECLARE_PDU_FOR_WRITE)
-                && type != static_cast<uint32_t>(MetaRequestType::REQUEST_PDU_READ);
-        }
-        return meta_pdu_.meta_request_type == static_cast<uint32_t>(MetaRequestType::PDU_DATA_TYPE);
+        return is_pdu_data_type(meta_pdu_, body_data_, version);
+    }
+    static bool is_pdu_data_type(const DataPacketView& view, const std::string& version) noexcept {
+        return is_pdu_data_type(view.meta, view.body, version);
     }
 
     // Encode/Decode
     std::vector<std::byte> encode(const std::string& version = "v2", MetaRequestType request_type = PDU_DATA_TYPE) const {
+        std::vector<std::byte> encoded_data;
+        encode_into(encoded_data, meta_pdu_, body_data_, version, request_type);
+        return encoded_data;
+    }
+
+    // Encode a frame into a caller-owned buffer. The buffer is resized, so its
+    // capacity is reused across calls (no allocation once it has grown).
+    static void encode_into(std::vector<std::byte>& out, const MetaPdu& meta, std::span<const std::byte> body,
+                            const std::string& version = "v2", MetaRequestType request_type = PDU_DATA_TYPE) {
         if (version == "v1") {
-            return encode_v1(request_type);
+            encode_v1(out, meta, body, request_type);
+            return;
         }
-        return encode_v2(request_type);
+        encode_v2(out, meta, body, request_type);
+    }
+
+    // Build the meta part for a PDU frame without copying the body.
+    static void init_meta(MetaPdu& meta, const std::string& robot_name, uint32_t channel_id) noexcept {
+        std::memset(&meta, 0, sizeof(meta));
+        std::strncpy(meta.robot_name, robot_name.c_str(), sizeof(meta.robot_name) - 1);
+        meta.channel_id = channel_id;
     }
 
     static std::unique_ptr<DataPacket> decode(const std::vector<std::byte>& data, const std::string& version = "v2") {
@@ -126,10 +152,58 @@ public:
         return decode_v2(data);
     }
 
+    // Patch the sequence stamp of an already encoded v2 frame in place.
+    static bool stamp_sequence(std::span<std::byte> frame, uint64_t sequence, uint32_t epoch) noexcept {
+        if (frame.size() < sizeof(MetaPdu)) {
+            return false;
+        }
+        std::byte* flags_ptr = frame.data() + offsetof(MetaPdu, flags);
+        write_le32(flags_ptr, read_le32(flags_ptr) | HAKO_META_FLAG_SEQUENCE);
+        std::byte* seq_ptr = frame.data() + offsetof(MetaPdu, padding);
+        write_le32(seq_ptr, static_cast<uint32_t>(sequence));
+        write_le32(seq_ptr + 4, static_cast<uint32_t>(sequence >> 32));
+        write_le32(seq_ptr + 8, epoch);
+        return true;
+    }
+
+    // Read the sequence stamp of a decoded v2 meta; false if the frame carries none.
+    static bool get_sequence(const MetaPdu& meta, uint64_t& sequence, uint32_t& epoch) noexcept {
+        if ((meta.flags & HAKO_META_FLAG_SEQUENCE) == 0) {
+            return false;
+        }
+        const std::byte* seq_ptr = reinterpret_cast<const std::byte*>(meta.padding);
+        sequence = static_cast<uint64_t>(read_le32(seq_ptr)) | (static_cast<uint64_t>(read_le32(seq_ptr + 4)) << 32);
+        epoch = read_le32(seq_ptr + 8);
+        return true;
+    }
+
+    // Decode without copying the body or allocating. Returns false on a malformed frame.
+    static bool decode_view(std::span<const std::byte> data, const std::string& version, DataPacketView& out) noexcept {
+        if (version == "v1") {
+            return decode_view_v1(data, out);
+        }
+        return decode_view_v2(data, out);
+    }
+
 private:
     MetaPdu meta_pdu_;
     std::vector<std::byte> body_data_;
 
+    static bool is_pdu_data_type(const MetaPdu& meta, std::span<const std::byte> body, const std::string& version) noexcept {
+        if (version == "v1") {
+            // v1 has no explicit type field; we infer "data" by excluding known control magic numbers.
+            // This is best-effort and can misclassify payloads that start with those values.
+            if (body.size() < sizeof(uint32_t)) {
+                return true;
+            }
+            const uint32_t type = read_le32(body.data());
+            return type != static_cast<uint32_t>(MetaRequestType::DECLARE_PDU_FOR_READ)
+                && type != static_cast<uint32_t>(MetaRequestType::DECLARE_PDU_FOR_WRITE)
+                && type != static_cast<uint32_t>(MetaRequestType::REQUEST_PDU_READ);
+        }
+        return meta.meta_request_type == static_cast<uint32_t>(MetaRequestType::PDU_DATA_TYPE);
+    }
+
     static uint32_t read_le32(const std::byte* data) noexcept {
         return static_cast<uint32_t>(std::to_integer<unsigned char>(data[0]))
             | (static_cast<uint32_t>(std::to_integer<unsigned char>(data[1])) << 8)
@@ -215,12 +289,15 @@ private:
     }
 
     // V2 Implementation
-    std::vector<std::byte> encode_v2(MetaRequestType request_type) const {
-        MetaPdu meta_to_send = meta_pdu_;
+    static void encode_v2(std::vector<std::byte>& out, const MetaPdu& meta, std::span<const std::byte> body,
+                          MetaRequestType request_type) {
+        MetaPdu meta_to_send = meta;
 
-        uint32_t body_len = body_data_.size();
+        uint32_t body_len = static_cast<uint32_t>(body.size());
         meta_to_send.magicno = to_le32(HAKO_META_MAGIC);
         meta_to_send.version = to_le16(HAKO_META_VER_V2);
+        // Flag bits are stamped into the encoded frame afterwards (stamp_sequence);
+        // a meta copied from a received frame must not carry its old stamp.
         meta_to_send.flags = to_le32(0);
         meta_to_send.meta_request_type = to_le32(static_cast<uint32_t>(request_type));
         meta_to_send.body_len = to_le32(body_len);
@@ -230,25 +307,33 @@ private:
         meta_to_send.real_time_us = static_cast<int64_t>(to_le64(static_cast<uint64_t>(meta_to_send.real_time_us)));
         meta_to_send.channel_id = to_le32(meta_to_send.channel_id);
 
-        std::vector<std::byte> encoded_data(sizeof(MetaPdu));
-        std::memcpy(encoded_data.data(), &meta_to_send, sizeof(MetaPdu));
-        encoded_data.insert(encoded_data.end(), body_data_.begin(), body_data_.end());
-
-        return encoded_data;
+        out.resize(sizeof(MetaPdu) + body.size());
+        std::memcpy(out.data(), &meta_to_send, sizeof(MetaPdu));
+        if (!body.empty()) {
+            std::memcpy(out.data() + sizeof(MetaPdu), body.data(), body.size());
+        }
     }
 
     static std::unique_ptr<DataPacket> decode_v2(const std::vector<std::byte>& data) {
-        if (data.size() < sizeof(MetaPdu)) {
+        DataPacketView view;
+        if (!decode_view_v2(data, view)) {
             return nullptr;
         }
+        return std::make_unique<DataPacket>(view.meta, std::vector<std::byte>(view.body.begin(), view.body.end()));
+    }
 
-        MetaPdu received_meta;
+    static bool decode_view_v2(std::span<const std::byte> data, DataPacketView& out) noexcept {
+        if (data.size() < sizeof(MetaPdu)) {
+            return false;
+        }
+
+        MetaPdu& received_meta = out.meta;
         std::memcpy(&received_meta, data.data(), sizeof(MetaPdu));
 
         received_meta.magicno = from_le32(received_meta.magicno);
         received_meta.version = from_le16(received_meta.version);
         if (received_meta.magicno != HAKO_META_MAGIC || received_meta.version != HAKO_META_VER_V2) {
-            return nullptr;
+            return false;
         }
 
         received_meta.flags = from_le32(received_meta.flags);
@@ -264,49 +349,53 @@ private:
         size_t actual_body_size = data.size() - sizeof(MetaPdu);
 
         if (actual_body_size < expected_body_size) {
-             return nullptr; // Incomplete packet
+             return false; // Incomplete packet
         }
 
-        std::vector<std::byte> body(
-            data.begin() + sizeof(MetaPdu), 
-            data.begin() + sizeof(MetaPdu) + expected_body_size
-        );
-
-        return std::make_unique<DataPacket>(received_meta, body);
+        out.robot_name = std::string_view(received_meta.robot_name,
+                                          strnlen(received_meta.robot_name, sizeof(received_meta.robot_name)));
+        out.body = data.subspan(sizeof(MetaPdu), expected_body_size);
+        return true;
     }
 
     // V1 Implementation
-    std::vector<std::byte> encode_v1(MetaRequestType /*request_type*/) const {
-        std::string name_str(meta_pdu_.robot_name);
-        uint32_t name_len = static_cast<uint32_t>(name_str.length());
-        uint32_t body_len = static_cast<uint32_t>(body_data_.size());
+    static void encode_v1(std::vector<std::byte>& out, const MetaPdu& meta, std::span<const std::byte> body,
+                          MetaRequestType /*request_type*/) {
+        uint32_t name_len = static_cast<uint32_t>(strnlen(meta.robot_name, sizeof(meta.robot_name)));
+        uint32_t body_len = static_cast<uint32_t>(body.size());
         uint32_t header_len = 4 + name_len + 4 + body_len;
         uint32_t total_len = 4 + header_len;
 
-        std::vector<std::byte> result(total_len);
+        out.resize(total_len);
         size_t offset = 0;
 
-        write_le32(result.data() + offset, header_len);
+        write_le32(out.data() + offset, header_len);
         offset += 4;
-        write_le32(result.data() + offset, name_len);
+        write_le32(out.data() + offset, name_len);
         offset += 4;
 
-        const std::byte* name_bytes = reinterpret_cast<const std::byte*>(name_str.c_str());
-        std::memcpy(result.data() + offset, name_bytes, name_len);
+        std::memcpy(out.data() + offset, meta.robot_name, name_len);
         offset += name_len;
 
-        write_le32(result.data() + offset, meta_pdu_.channel_id);
+        write_le32(out.data() + offset, meta.channel_id);
         offset += 4;
 
-        if (!body_data_.empty()) {
-            std::memcpy(result.data() + offset, body_data_.data(), body_data_.size());
+        if (!body.empty()) {
+            std::memcpy(out.data() + offset, body.data(), body.size());
         }
-
-        return result;
     }
 
     static std::unique_ptr<DataPacket> decode_v1(const std::vector<std::byte>& data) {
-        if (data.size() < 4) return nullptr;
+        DataPacketView view;
+        if (!decode_view_v1(data, view)) {
+            return nullptr;
+        }
+        return std::make_unique<DataPacket>(std::string(view.robot_name), view.meta.channel_id,
+                                            std::vector<std::byte>(view.body.begin(), view.body.end()));
+    }
+
+    static bool decode_view_v1(std::span<const std::byte> data, DataPacketView& out) noexcept {
+        if (data.size() < 4) return false;
 
         size_t index = 0;
         auto read_uint32_le = [&](uint32_t& val) {
@@ -319,20 +408,21 @@ private:
         uint32_t header_len = 0;
         uint32_t name_len = 0;
         uint32_t channel_id = 0;
-        if (!read_uint32_le(header_len)) return nullptr;
-        if (data.size() < 4 + header_len) return nullptr;
-        if (!read_uint32_le(name_len)) return nullptr;
-        if (index + name_len + 4 > data.size()) return nullptr;
-        if (header_len < (4 + name_len + 4)) return nullptr;
+        if (!read_uint32_le(header_len)) return false;
+        if (data.size() < 4 + static_cast<size_t>(header_len)) return false;
+        if (!read_uint32_le(name_len)) return false;
+        if (index + name_len + 4 > data.size()) return false;
+        if (header_len < (4 + name_len + 4)) return false;
 
-        std::string robot_name(reinterpret_cast<const char*>(data.data() + index), name_len);
+        out.robot_name = std::string_view(reinterpret_cast<const char*>(data.data() + index), name_len);
         index += name_len;
 
-        if (!read_uint32_le(channel_id)) return nullptr;
-
-        std::vector<std::byte> body(data.begin() + index, data.end());
+        if (!read_uint32_le(channel_id)) return false;
 
-        return std::make_unique<DataPacket>(robot_name, channel_id, body);
+        std::memset(&out.meta, 0, sizeof(out.meta));
+        out.meta.channel_id = channel_id;
+        out.body = data.subspan(index);
+        return true;
     }
 };
 
@@ -3,7 +3,9 @@
 #include "hakoniwa/pdu/endpoint_types.hpp"
 #include "hakoniwa/pdu/pdu_definition.hpp" // Added
 #include "hakoniwa/pdu/cache/cache.hpp"
+#include "hakoniwa/pdu/cache/cache_buffer.hpp"
 #include "hakoniwa/pdu/comm/comm.hpp"
+#include "hakoniwa/pdu/latency_histogram.hpp"
 #include "hakoniwa/pdu/pdu_factory.hpp"
 #include <nlohmann/json.hpp>
 #include <fstream>
@@ -17,7 +19,10 @@
 #include <vector>
 #include <functional>
 #include <mutex>
+#include <shared_mutex>
 #include <iostream>
+#include <new>
+#include <utility>
 
 namespace fs = std::filesystem;
 
@@ -25,6 +30,16 @@ namespace hakoniwa {
 namespace pdu {
 using OnRecvCallback = std::function<void(const PduResolvedKey&, std::span<const std::byte>)>;
 
+// Endpoint configuration parsed once and shared by every endpoint created from
+// it (EndpointCommMultiplexer sessions): the PDU definition is shared, the cache
+// prototype is cloned, and nothing is read from disk again. Immutable once loaded.
+struct EndpointTemplate {
+    std::shared_ptr<PduDefinition> pdu_def;   // null without pdu_def_path
+    std::unique_ptr<PduCache> cache_prototype; // opened, never started
+    std::string cache_config_path;             // resolved; for caches without clone_config()
+    std::string comm_config_path;              // resolved; empty without comm
+};
+
 /*
  * Threading assumptions:
  * - open/close/start/stop are called from a single thread (initialization/shutdown).
@@ -104,70 +119,66 @@ public:
     }
     
     // Load cache/comm (and optional PDU definition) from endpoint config.
+    // Same path as load_template() + open_from_template(), with the freshly
+    // opened cache used directly instead of a clone.
     virtual HakoPduErrorType open(const std::string& endpoint_config_path) 
     {
-        nlohmann::json config;
-        fs::path base_dir;
-        HakoPduErrorType err = load_endpoint_config_(endpoint_config_path, config, base_dir);
+        EndpointTemplate tmpl;
+        // Keeps a definition already loaded by create_pdu_lchannels().
+        HakoPduErrorType err = load_template_(endpoint_config_path, tmpl, pdu_def_);
         if (err != HAKO_PDU_ERR_OK) {
             return err;
         }
-        try {
-            err = load_pdu_definition_if_needed_(config, base_dir, false);
-            if (err != HAKO_PDU_ERR_OK) {
-                return err;
-            }
+        return open_from_template(tmpl, std::move(tmpl.cache_prototype));
+    }
 
-            // Cache is mandatory
-            if (!config.contains("cache") || config["cache"].is_null()) {
-                std::cerr << "PDU Cache configuration is missing." << std::endl;
-                return HAKO_PDU_ERR_INVALID_CONFIG;
-            }
-            std::string cache_config_path = config["cache"].get<std::string>();
-            auto resolved_cache_config_path = resolve_under_base(base_dir, cache_config_path);
+    // Parse an endpoint config (PDU definition, cache, comm path) once for open_from_template().
+    static HakoPduErrorType load_template(const std::string& endpoint_config_path, EndpointTemplate& tmpl)
+    {
+        return load_template_(endpoint_config_path, tmpl, nullptr);
+    }
 
-            cache_ = create_pdu_cache(resolved_cache_config_path);
+    // open() from a loaded template: shares its PDU definition and clones its
+    // cache. An injected comm (set_comm) still opens with the template's comm path.
+    // cache: an opened cache to use instead of the clone (shared mux cache).
+    virtual HakoPduErrorType open_from_template(const EndpointTemplate& tmpl, std::unique_ptr<PduCache> cache = nullptr)
+    {
+        pdu_def_ = tmpl.pdu_def;
+        if (cache) {
+            cache_ = std::move(cache);
+        } else {
+            cache_ = tmpl.cache_prototype ? tmpl.cache_prototype->clone_config() : nullptr;
+        }
+        if (!cache_) {
+            cache_ = create_pdu_cache(tmpl.cache_config_path);
             if (!cache_) {
-                std::cerr << "Failed to create PDU Cache module: " << resolved_cache_config_path << std::endl;
+                std::cerr << "Failed to create PDU Cache module: " << tmpl.cache_config_path << std::endl;
                 return HAKO_PDU_ERR_INVALID_CONFIG;
             }
-            HakoPduErrorType err = cache_->open(resolved_cache_config_path);
+            HakoPduErrorType err = cache_->open(tmpl.cache_config_path);
             if (err != HAKO_PDU_ERR_OK) {
                 std::cerr << "Failed to open PDU Cache: " << static_cast<int>(err) << std::endl;
                 return err;
             }
-            // Comm is optional
-            if (config.contains("comm") && !config["comm"].is_null()) {
-                std::string comm_config_path = config["comm"].get<std::string>();
-                auto resolved_comm_config_path = resolve_under_base(base_dir, comm_config_path);
-
-                if (!comm_) {
-                    comm_ = create_pdu_comm(resolved_comm_config_path);
-                }
-                if (!comm_) {
-                    std::cerr << "Failed to create PDU Comm module." << std::endl;
-                    return HAKO_PDU_ERR_INVALID_CONFIG;
-                }
-                // Pass PDU definition to comm module
-                if (pdu_def_) {
-                    comm_->set_pdu_definition(pdu_def_);
-                }
-                err = comm_->open(resolved_comm_config_path);
-                if (err != HAKO_PDU_ERR_OK) {
-                    std::cerr << "Failed to open PDU Comm: " << static_cast<int>(err) << std::endl;
-                    return err;
-                }
-            }
-
-        } catch (const nlohmann::json::exception& e) {
-            return HAKO_PDU_ERR_INVALID_JSON;
         }
-
-        if (comm_) {
-            (void)comm_->set_on_recv_callback([this](const PduResolvedKey& pdu_key, std::span<const std::byte> data) {
-                this->recv_callback_(pdu_key, data);
-            });
+        if (!tmpl.comm_config_path.empty()) {
+            if (!comm_) {
+                comm_ = create_pdu_comm(tmpl.comm_config_path);
+            }
+            if (!comm_) {
+                std::cerr << "Failed to create PDU Comm module." << std::endl;
+                return HAKO_PDU_ERR_INVALID_CONFIG;
+            }
+            if (pdu_def_) {
+                comm_->set_pdu_definition(pdu_def_);
+            }
+            HakoPduErrorType err = comm_->open(tmpl.comm_config_path);
+            if (err != HAKO_PDU_ERR_OK) {
+                std::cerr << "Failed to open PDU Comm: " << static_cast<int>(err) << std::endl;
+                return err;
+            }
         }
+        attach_comm_callbacks_();
         return HAKO_PDU_ERR_OK;
     }
     
@@ -177,6 +188,7 @@ public:
         HakoPduErrorType err = HAKO_PDU_ERR_OK;
         if (comm_) {
             (void)comm_->set_on_recv_callback(nullptr);
+            (void)comm_->set_on_connected_callback(nullptr);
             err = comm_->close();
         }
         if (cache_) {
@@ -185,6 +197,8 @@ public:
                 err = cache_err;
             }
         }
+        sent_cache_.reset();
+        latency_.reset();
         return err;
     }
     
@@ -195,6 +209,9 @@ public:
             HakoPduErrorType err = cache_->start();
             if (err != HAKO_PDU_ERR_OK) return err;
         }
+        if (sent_cache_) {
+            (void)sent_cache_->start();
+        }
         if (comm_) {
             return comm_->start();
         }
@@ -219,6 +236,9 @@ public:
         if (comm_) {
             err = comm_->stop();
         }
+        if (sent_cache_) {
+            (void)sent_cache_->stop();
+        }
         if (cache_) {
             HakoPduErrorType cache_err = cache_->stop();
             if (err == HAKO_PDU_ERR_OK) {
@@ -259,6 +279,47 @@ public:
         return HAKO_PDU_ERR_OK;
     }
 
+    // Per-channel receive statistics of the comm (sequence-numbered UDP).
+    // HAKO_PDU_ERR_UNSUPPORTED when there is no comm or it does not track them.
+    virtual HakoPduErrorType get_comm_channel_stats(std::vector<PduChannelStats>& stats) const noexcept
+    {
+        if (!comm_) {
+            stats.clear();
+            return HAKO_PDU_ERR_UNSUPPORTED;
+        }
+        return comm_->get_channel_stats(stats);
+    }
+
+    // Receive socket statistics of the comm (kernel drops, SO_RCVBUF).
+    // HAKO_PDU_ERR_UNSUPPORTED when there is no comm or it is not socket based.
+    virtual HakoPduErrorType get_comm_socket_stats(PduCommSocketStats& stats) const noexcept
+    {
+        if (!comm_) {
+            stats = PduCommSocketStats{};
+            return HAKO_PDU_ERR_UNSUPPORTED;
+        }
+        return comm_->get_socket_stats(stats);
+    }
+
+    // Per-channel receive latency histograms (send -> kernel -> cache -> callbacks).
+    // HAKO_PDU_ERR_UNSUPPORTED unless the comm has "latency_tracking" enabled.
+    virtual HakoPduErrorType get_latency_stats(std::vector<PduLatencyStats>& stats) const noexcept
+    {
+        if (!latency_) {
+            stats.clear();
+            return HAKO_PDU_ERR_UNSUPPORTED;
+        }
+        return latency_->snapshot(stats);
+    }
+    virtual HakoPduErrorType reset_latency_stats() noexcept
+    {
+        if (!latency_) {
+            return HAKO_PDU_ERR_UNSUPPORTED;
+        }
+        latency_->reset();
+        return HAKO_PDU_ERR_OK;
+    }
+
     // Only meaningful for SHM poll implementation; other comm types are no-op.
     virtual void process_recv_events() noexcept
     {
@@ -305,6 +366,13 @@ public:
                       << " channel=" << pdu_key.channel_id
                       << " size=" << data.size() << std::endl;
             #endif
+            if (sent_cache_) {
+                // Kept even if this send fails: it is replayed on the next connect.
+                // Held shared so a replay (resync_sent_) never goes out after a newer value.
+                std::shared_lock<std::shared_mutex> lock(resync_mutex_);
+                (void)sent_cache_->write(pdu_key, data);
+                return comm_->send(pdu_key, data);
+            }
             return comm_->send(pdu_key, data);
         }
         else {
@@ -382,6 +450,12 @@ protected:
     std::shared_ptr<PduDefinition>  pdu_def_; // Changed
     std::unique_ptr<PduCache>       cache_;
     std::shared_ptr<PduComm>        comm_;
+    // Latest outgoing value per key; only present when the comm asks for resync_on_connect.
+    std::unique_ptr<PduLatestBuffer> sent_cache_;
+    // Shared by send(), exclusive for the snapshot and replay of resync_sent_().
+    std::shared_mutex resync_mutex_;
+    // Receive latency histograms; only present when the comm has latency_tracking.
+    std::unique_ptr<PduLatencyRecorder> latency_;
 
 private:
     mutable std::mutex cb_mtx_;
@@ -424,9 +498,62 @@ private:
             std::cerr << "PDU Cache module is not initialized in recv_callback_. Ignoring received data." << std::endl;
             return; 
         }
+        if (!latency_) {
+            (void)cache_->write(pdu_key, data);
+            notify_subscribers_(pdu_key, data);
+            return;
+        }
+        // Copied first: a subscriber may receive on this thread and overwrite them.
+        const PduRecvTimestamps timestamps = PduComm::current_recv_timestamps();
         (void)cache_->write(pdu_key, data);
-
+        const int64_t cached_ns = realtime_now_ns();
         notify_subscribers_(pdu_key, data);
+        latency_->record(pdu_key, timestamps, cached_ns, realtime_now_ns());
+    }
+    /*
+     * call from comm when a connection comes up (resync_on_connect)
+     */
+    void resync_sent_() noexcept
+    {
+        // Sends wait for the replay: one racing it would otherwise go out first
+        // and then be overwritten on the peer by the older snapshot.
+        std::unique_lock<std::shared_mutex> lock(resync_mutex_);
+        std::vector<std::pair<PduResolvedKey, std::vector<std::byte>>> entries;
+        std::vector<PduSendItem> items;
+        try {
+            if (sent_cache_->snapshot(entries) != HAKO_PDU_ERR_OK || entries.empty()) {
+                return;
+            }
+            items.reserve(entries.size());
+            for (const auto& [key, data] : entries) {
+                items.push_back(PduSendItem{key, data});
+            }
+        } catch (const std::bad_alloc&) {
+            std::cerr << "Endpoint resync skipped: out of memory. name=" << name_ << std::endl;
+            return;
+        }
+        HakoPduErrorType err = comm_->send_batch(items);
+        if (err != HAKO_PDU_ERR_OK) {
+            std::cerr << "Endpoint resync failed: " << static_cast<int>(err) << " name=" << name_ << std::endl;
+        }
+    }
+    void attach_comm_callbacks_()
+    {
+        if (!comm_) {
+            return;
+        }
+        (void)comm_->set_on_recv_callback([this](const PduResolvedKey& pdu_key, std::span<const std::byte> data) {
+            this->recv_callback_(pdu_key, data);
+        });
+        if (comm_->resync_on_connect()) {
+            sent_cache_ = std::make_unique<PduLatestBuffer>();
+            (void)comm_->set_on_connected_callback([this]() {
+                this->resync_sent_();
+            });
+        }
+        if (comm_->latency_tracking()) {
+            latency_ = std::make_unique<PduLatencyRecorder>();
+        }
     }
     fs::path resolve_under_base(const fs::path& base_dir, const std::string& maybe_rel)
     {
@@ -453,6 +580,49 @@ private:
         }
         return HAKO_PDU_ERR_OK;
     }
+    // load_template() body; pdu_def: a definition already loaded, kept instead of reloading.
+    static HakoPduErrorType load_template_(const std::string& endpoint_config_path, EndpointTemplate& tmpl,
+                                           std::shared_ptr<PduDefinition> pdu_def)
+    {
+        Endpoint loader("template", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+        loader.pdu_def_ = std::move(pdu_def);
+        nlohmann::json config;
+        fs::path base_dir;
+        HakoPduErrorType err = loader.load_endpoint_config_(endpoint_config_path, config, base_dir);
+        if (err != HAKO_PDU_ERR_OK) {
+            return err;
+        }
+        try {
+            err = loader.load_pdu_definition_if_needed_(config, base_dir, false);
+            if (err != HAKO_PDU_ERR_OK) {
+                return err;
+            }
+            if (!config.contains("cache") || config["cache"].is_null()) {
+                std::cerr << "PDU Cache configuration is missing." << std::endl;
+                return HAKO_PDU_ERR_INVALID_CONFIG;
+            }
+            tmpl.cache_config_path = loader.resolve_under_base(base_dir, config["cache"].get<std::string>()).string();
+            tmpl.cache_prototype = create_pdu_cache(tmpl.cache_config_path);
+            if (!tmpl.cache_prototype) {
+                std::cerr << "Failed to create PDU Cache module: " << tmpl.cache_config_path << std::endl;
+                return HAKO_PDU_ERR_INVALID_CONFIG;
+            }
+            err = tmpl.cache_prototype->open(tmpl.cache_config_path);
+            if (err != HAKO_PDU_ERR_OK) {
+                std::cerr << "Failed to open PDU Cache: " << static_cast<int>(err) << std::endl;
+                return err;
+            }
+            tmpl.comm_config_path.clear();
+            if (config.contains("comm") && !config["comm"].is_null()) {
+                tmpl.comm_config_path = loader.resolve_under_base(base_dir, config["comm"].get<std::string>()).string();
+            }
+        } catch (const nlohmann::json::exception& e) {
+            return HAKO_PDU_ERR_INVALID_JSON;
+        }
+        tmpl.pdu_def = loader.pdu_def_;
+        return HAKO_PDU_ERR_OK;
+    }
+
     HakoPduErrorType load_pdu_definition_if_needed_(const nlohmann::json& config,
         const fs::path& base_dir,
         bool required)
@@ -2,15 +2,26 @@
 
 #include "hakoniwa/pdu/endpoint_types.hpp"
 #include "hakoniwa/pdu/endpoint.hpp"
+#include "hakoniwa/pdu/cache/cache_shared.hpp"
 #include "hakoniwa/pdu/comm/comm_mux.hpp"
 #include <filesystem>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <span>
 #include <string>
 #include <vector>
 
 namespace hakoniwa {
 namespace pdu {
 
+// Outcome of EndpointCommMultiplexer::send_to_all().
+struct PduGroupSendResult {
+    size_t sessions = 0; // live session endpoints the frame was offered to
+    size_t sent = 0;     // sessions that sent or queued it
+    size_t failed = 0;   // sessions that refused it (queue full, not running, ...)
+};
+
 class EndpointCommMultiplexer
 {
 public:
@@ -20,6 +31,8 @@ public:
     // - This class is protocol-agnostic; the comm multiplexer is selected by the comm config.
     // - take_endpoints() is non-blocking. If no new connections are ready, it returns an empty vector.
     // - Returned endpoints are already opened and started; the caller can use them immediately.
+    // - The endpoint config is parsed once by open(); every session endpoint shares its
+    //   PDU definition and clones its cache, without reading any file.
     // - Endpoint names are generated as "<mux_name>_<seq>" (seq starts at 1).
     // - expected/connected counts are managed by the comm multiplexer (e.g., TCP mux).
     // Load mux endpoint config and initialize comm multiplexer.
@@ -31,20 +44,59 @@ public:
     // Non-blocking: returns any newly accepted endpoints; empty if none.
     std::vector<std::unique_ptr<Endpoint>> take_endpoints();
 
+    // Encode one PDU once and hand the same shared frame to every session whose
+    // endpoint was taken from this mux and still exists, one session after the
+    // other on the calling thread (the group lock is not held while sending).
+    // WebSocket and TCP reactor sessions queue the frame and apply their own
+    // limits, so a slow client only fails or drops its own copy there. Thread-
+    // per-session TCP and UDP sessions write synchronously, so a stalled TCP
+    // client delays the sessions after it by up to its write_timeout_ms.
+    // Returns HAKO_PDU_ERR_OK when every session took the frame, otherwise the
+    // first session error; result has the counts.
+    HakoPduErrorType send_to_all(const PduResolvedKey& pdu_key, std::span<const std::byte> data,
+                                 PduGroupSendResult* result = nullptr) noexcept;
+
+    // With "shared_cache": { "enabled": true } in the mux endpoint config, every
+    // session endpoint writes what it receives into this one cache (session id =
+    // endpoint sequence number); nullptr otherwise.
+    std::shared_ptr<PduSharedCache> shared_cache() const noexcept { return shared_cache_; }
+
     // Connection counters are driven by comm multiplexer (e.g., TCP mux).
     size_t connected_count() const noexcept;
     size_t expected_count() const noexcept;
     bool is_ready() const noexcept;
+    // Accepted/rejected connection counters (TCP mux "admission" options).
+    HakoPduErrorType get_admission_stats(comm::CommMuxAdmissionStats& stats) const noexcept;
+
+    // Session arrival without polling (after open()). The comm multiplexer signals
+    // from the thread that accepted the session, right after queueing it.
+    // Block until is_ready(): HAKO_PDU_ERR_OK, HAKO_PDU_ERR_TIMEOUT after timeout_ms
+    // (-1 waits forever), HAKO_PDU_ERR_NOT_RUNNING before start(), after stop()/close()
+    // or when one of them interrupts it.
+    HakoPduErrorType wait_ready(int timeout_ms) noexcept;
+    // Same, until take_endpoints() has a new endpoint to return.
+    HakoPduErrorType wait_endpoints(int timeout_ms) noexcept;
+    // Called on the accepting thread for every new session; keep it short and
+    // call take_endpoints() from your own thread.
+    HakoPduErrorType set_on_session_callback(std::function<void()> callback);
+    // poll()able fd (POLLIN) while sessions wait for take_endpoints(); -1 if unavailable.
+    int session_fd() const noexcept;
 
 private:
     std::unique_ptr<comm::CommMultiplexer> create_comm_mux_(const std::string& comm_config_path);
 
     std::string name_;
     HakoPduEndpointDirectionType type_;
-    std::string endpoint_config_path_;
+    std::shared_ptr<const EndpointTemplate> template_; // loaded by open()
     std::filesystem::path base_dir_;
     std::unique_ptr<comm::CommMultiplexer> comm_;
     size_t endpoint_seq_ = 0;
+    std::shared_ptr<PduSharedCache> shared_cache_;
+    std::string packet_version_ = "v2"; // comm_raw_version of the session comms
+
+    // Session comms of the taken endpoints, for send_to_all(); pruned as they expire.
+    std::mutex group_mutex_;
+    std::vector<std::weak_ptr<PduComm>> group_;
 };
 
 } // namespace pdu
@@ -0,0 +1,257 @@
+#pragma once
+
+#include "hakoniwa/pdu/endpoint_types.hpp"
+#include "hakoniwa/pdu/comm/comm.hpp"
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+namespace hakoniwa {
+namespace pdu {
+
+// Summary of one latency histogram, in microseconds.
+struct LatencySummary {
+    uint64_t count = 0;
+    int64_t min_us = 0;
+    int64_t max_us = 0;
+    double mean_us = 0.0;
+    int64_t p50_us = 0;
+    int64_t p90_us = 0;
+    int64_t p99_us = 0;
+    int64_t p999_us = 0;
+};
+
+// Per-channel receive latencies, reported by endpoints whose comm has "latency_tracking".
+// wire and total need a sender that stamps real_time_us (v2 frames); they include
+// the clock offset between the two hosts.
+struct PduLatencyStats {
+    PduResolvedKey key;
+    LatencySummary wire;     // sender real_time_us -> kernel receive timestamp
+    LatencySummary stack;    // kernel receive -> cache write done
+    LatencySummary dispatch; // cache write done -> subscriber callbacks returned
+    LatencySummary total;    // sender real_time_us -> subscriber callbacks returned
+};
+
+// HDR-style log-linear histogram of non-negative values (microseconds).
+// Values below 2 * kSubBuckets are counted exactly; each power of two above is
+// split into kSubBuckets linear buckets, so percentiles are within 1/kSubBuckets
+// (about 3%) of the recorded value. record() is lock-free.
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 5;
+    static constexpr uint64_t kSubBuckets = uint64_t{1} << kSubBucketBits;
+    static constexpr int kMaxBits = 40; // larger values (about 12 days) are clamped
+    static constexpr size_t kBucketCount = 2 * kSubBuckets + (kMaxBits - kSubBucketBits - 1) * kSubBuckets;
+
+    void record(int64_t value) noexcept
+    {
+        uint64_t v = (value > 0) ? static_cast<uint64_t>(value) : 0;
+        if (v >= (uint64_t{1} << kMaxBits)) {
+            v = (uint64_t{1} << kMaxBits) - 1;
+        }
+        counts_[index_of(v)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(v, std::memory_order_relaxed);
+        uint64_t seen = min_.load(std::memory_order_relaxed);
+        while (v < seen && !min_.compare_exchange_weak(seen, v, std::memory_order_relaxed)) {
+        }
+        seen = max_.load(std::memory_order_relaxed);
+        while (v > seen && !max_.compare_exchange_weak(seen, v, std::memory_order_relaxed)) {
+        }
+    }
+
+    uint64_t count() const noexcept { return count_.load(std::memory_order_relaxed); }
+
+    // Highest value equivalent to the bucket holding the given percentile (0..100).
+    int64_t value_at_percentile(double percentile) const noexcept
+    {
+        const uint64_t total = count();
+        if (total == 0) {
+            return 0;
+        }
+        if (percentile > 100.0) {
+            percentile = 100.0;
+        }
+        uint64_t target = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(total) + 0.5);
+        if (target == 0) {
+            target = 1;
+        }
+        const uint64_t max = max_.load(std::memory_order_relaxed);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            seen += counts_[i].load(std::memory_order_relaxed);
+            if (seen >= target) {
+                const uint64_t upper = highest_equivalent(i);
+                return static_cast<int64_t>(upper < max ? upper : max);
+            }
+        }
+        return static_cast<int64_t>(max);
+    }
+
+    LatencySummary summary() const noexcept
+    {
+        LatencySummary s;
+        s.count = count();
+        if (s.count == 0) {
+            return s;
+        }
+        s.min_us = static_cast<int64_t>(min_.load(std::memory_order_relaxed));
+        s.max_us = static_cast<int64_t>(max_.load(std::memory_order_relaxed));
+        s.mean_us = static_cast<double>(sum_.load(std::memory_order_relaxed)) / static_cast<double>(s.count);
+        s.p50_us = value_at_percentile(50.0);
+        s.p90_us = value_at_percentile(90.0);
+        s.p99_us = value_at_percentile(99.0);
+        s.p999_us = value_at_percentile(99.9);
+        return s;
+    }
+
+    void reset() noexcept
+    {
+        for (auto& c : counts_) {
+            c.store(0, std::memory_order_relaxed);
+        }
+        count_.store(0, std::memory_order_relaxed);
+        sum_.store(0, std::memory_order_relaxed);
+        min_.store(UINT64_MAX, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static size_t index_of(uint64_t v) noexcept
+    {
+        if (v < 2 * kSubBuckets) {
+            return static_cast<size_t>(v);
+        }
+        const int top = std::bit_width(v) - 1; // >= kSubBucketBits + 1
+        const int shift = top - kSubBucketBits;
+        const uint64_t sub = (v >> shift) & (kSubBuckets - 1);
+        return static_cast<size_t>(2 * kSubBuckets + static_cast<uint64_t>(top - kSubBucketBits - 1) * kSubBuckets + sub);
+    }
+    static uint64_t highest_equivalent(size_t index) noexcept
+    {
+        if (index < 2 * kSubBuckets) {
+            return index;
+        }
+        const uint64_t k = index - 2 * kSubBuckets;
+        const int shift = static_cast<int>(k / kSubBuckets) + 1;
+        const uint64_t lower = (kSubBuckets + k % kSubBuckets) << shift;
+        return lower + (uint64_t{1} << shift) - 1;
+    }
+
+    std::array<std::atomic<uint64_t>, kBucketCount> counts_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> min_{UINT64_MAX};
+    std::atomic<uint64_t> max_{0};
+};
+
+// Per-channel latency histograms of an endpoint. A channel is added under the
+// table lock on its first sample and published in a lock-free index, so later
+// samples take no lock. Channels beyond kIndexSlots are looked up under the lock.
+class PduLatencyRecorder {
+public:
+    // cached_ns / done_ns: CLOCK_REALTIME after cache write and after the subscriber callbacks.
+    void record(const PduResolvedKey& key, const PduRecvTimestamps& ts, int64_t cached_ns, int64_t done_ns) noexcept
+    {
+        Channel* ch = channel_(key);
+        if (ch == nullptr) {
+            return;
+        }
+        const int64_t rx_ns = (ts.kernel_rx_ns != 0) ? ts.kernel_rx_ns : cached_ns;
+        if (ts.sent_real_time_us != 0) {
+            ch->wire.record(rx_ns / 1000 - ts.sent_real_time_us);
+            ch->total.record(done_ns / 1000 - ts.sent_real_time_us);
+        }
+        ch->stack.record((cached_ns - rx_ns) / 1000);
+        ch->dispatch.record((done_ns - cached_ns) / 1000);
+    }
+
+    HakoPduErrorType snapshot(std::vector<PduLatencyStats>& out) const noexcept
+    {
+        out.clear();
+        try {
+            std::lock_guard<std::mutex> lock(mutex_);
+            out.reserve(channels_.size());
+            for (const auto& [key, ch] : channels_) {
+                out.push_back(PduLatencyStats{key, ch->wire.summary(), ch->stack.summary(),
+                                              ch->dispatch.summary(), ch->total.summary()});
+            }
+        } catch (const std::bad_alloc&) {
+            out.clear();
+            return HAKO_PDU_ERR_OUT_OF_MEMORY;
+        }
+        return HAKO_PDU_ERR_OK;
+    }
+
+    void reset() noexcept
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& [key, ch] : channels_) {
+            ch->wire.reset();
+            ch->stack.reset();
+            ch->dispatch.reset();
+            ch->total.reset();
+        }
+    }
+
+private:
+    struct Channel {
+        PduResolvedKey key;
+        LatencyHistogram wire;
+        LatencyHistogram stack;
+        LatencyHistogram dispatch;
+        LatencyHistogram total;
+    };
+    static constexpr size_t kIndexSlots = 256; // power of two
+
+    Channel* channel_(const PduResolvedKey& key) noexcept
+    {
+        const size_t hash = PduResolvedKeyHash()(key);
+        // Open addressing, insert-only: an empty slot ends the probe.
+        for (size_t i = 0; i < kIndexSlots; ++i) {
+            Channel* ch = index_[(hash + i) & (kIndexSlots - 1)].load(std::memory_order_acquire);
+            if (ch == nullptr) {
+                break;
+            }
+            if (ch->key == key) {
+                return ch;
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = channels_.find(key);
+        if (it != channels_.end()) {
+            return it->second.get();
+        }
+        Channel* ch = nullptr;
+        try {
+            auto created = std::make_unique<Channel>();
+            created->key = key;
+            ch = created.get();
+            channels_.emplace(key, std::move(created));
+        } catch (const std::bad_alloc&) {
+            return nullptr;
+        }
+        for (size_t i = 0; i < kIndexSlots; ++i) {
+            auto& slot = index_[(hash + i) & (kIndexSlots - 1)];
+            if (slot.load(std::memory_order_relaxed) == nullptr) {
+                slot.store(ch, std::memory_order_release);
+                break;
+            }
+        }
+        return ch;
+    }
+
+    mutable std::mutex mutex_;
+    // Owns the channels; they live as long as the recorder.
+    std::unordered_map<PduResolvedKey, std::unique_ptr<Channel>, PduResolvedKeyHash> channels_;
+    std::array<std::atomic<Channel*>, kIndexSlots> index_{};
+};
+
+} // namespace pdu
+} // namespace hakoniwa
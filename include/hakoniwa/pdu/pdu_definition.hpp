@@ -69,6 +69,18 @@ public:
     HakoPduChannelIdType get_pdu_channel_id(const std::string& robot_name, const std::string& pdu_org_name) const;
 
 
+    /**
+     * @brief Calls visit(robot_name, def) for every defined PDU channel.
+     */
+    template <typename Visit>
+    void for_each(Visit&& visit) const {
+        for (const auto& [robot_name, defs] : pdu_definitions_) {
+            for (const auto& [org_name, def] : defs) {
+                visit(robot_name, def);
+            }
+        }
+    }
+
     bool add_definition(const std::string& robot_name, const PduDef& def) {
         pdu_definitions_[robot_name][def.org_name] = def;
         return true;
@@ -2,15 +2,53 @@
 
 #include "hakoniwa/pdu/endpoint_types.h"
 #include <netdb.h>
+#include <sys/socket.h>
 #include <nlohmann/json.hpp>
 #include <string>
 
 namespace hakoniwa {
 namespace pdu {
 
+// Flags for send() on stream sockets: a peer reset must surface as EPIPE, not SIGPIPE.
+#ifdef MSG_NOSIGNAL
+constexpr int kStreamSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kStreamSendFlags = 0;
+#endif
+
 HakoPduErrorType map_errno_to_error(int error_number) noexcept;
 HakoPduEndpointDirectionType parse_direction(const std::string& direction);
 HakoPduErrorType resolve_address(const nlohmann::json& endpoint_json, int socket_type, addrinfo** res);
 
+// Wakeup handle for comm loops blocked in poll(): stop() calls notify() and the
+// loop returns immediately instead of waiting for a socket timeout.
+// eventfd on Linux, a non-blocking pipe elsewhere.
+class WakeupFd
+{
+public:
+    WakeupFd() = default;
+    ~WakeupFd() { close(); }
+    WakeupFd(const WakeupFd&) = delete;
+    WakeupFd& operator=(const WakeupFd&) = delete;
+
+    HakoPduErrorType open() noexcept;
+    void close() noexcept;
+    // Make fd() readable until the next drain(). Safe from any thread.
+    void notify() noexcept;
+    void drain() noexcept;
+    // Read end to poll for POLLIN; -1 when not open.
+    int fd() const noexcept { return read_fd_; }
+
+private:
+    int read_fd_ = -1;
+    int write_fd_ = -1;
+};
+
+// Wait until `fd` reports `events` (POLLIN/POLLOUT) or `wakeup` is notified.
+// Returns HAKO_PDU_ERR_OK when fd is ready, HAKO_PDU_ERR_NOT_RUNNING when woken,
+// HAKO_PDU_ERR_TIMEOUT after timeout_ms (-1 waits forever), IO_ERROR otherwise.
+// fd may be -1 to just sleep until timeout or wakeup.
+HakoPduErrorType poll_with_wakeup(int fd, short events, const WakeupFd& wakeup, int timeout_ms) noexcept;
+
 }  // namespace pdu
 }  // namespace hakoniwa
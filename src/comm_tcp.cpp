@@ -1,4 +1,5 @@
 #include "hakoniwa/pdu/comm/comm_tcp.hpp"
+#include "hakoniwa/pdu/comm/frame_assembler.hpp"
 #include "hakoniwa/pdu/socket_utils.hpp"
 #include <nlohmann/json.hpp>
 #include <fstream>
@@ -11,8 +12,11 @@
 #include <netinet/tcp.h>
 #include <poll.h>
 #include <iostream>
+#include <algorithm>
 #include <array>
 #include <cstddef>
+#include <ctime>
+#include <string_view>
 
 namespace hakoniwa {
 namespace pdu {
@@ -121,7 +125,28 @@ HakoPduErrorType TcpComm::raw_open(const std::string& config_path) {
             options_.linger_enabled = linger_opts.value("enabled", options_.linger_enabled);
             options_.linger_timeout_sec = linger_opts.value("timeout_sec", options_.linger_timeout_sec);
         }
+        if (parse_io_backend_options(opts, options_.use_io_uring, options_.io_uring) != HAKO_PDU_ERR_OK) {
+            return HAKO_PDU_ERR_INVALID_ARGUMENT;
+        }
+        if (opts.contains("reconnect")) {
+            const auto& reconnect_opts = opts.at("reconnect");
+            options_.reconnect_initial_delay_ms = reconnect_opts.value("initial_delay_ms", options_.reconnect_initial_delay_ms);
+            options_.reconnect_max_delay_ms = reconnect_opts.value("max_delay_ms", options_.reconnect_max_delay_ms);
+            options_.reconnect_multiplier = reconnect_opts.value("multiplier", options_.reconnect_multiplier);
+            options_.reconnect_jitter = reconnect_opts.value("jitter", options_.reconnect_jitter);
+            // A zero delay would stay zero under the multiplier and busy-loop.
+            if (options_.reconnect_initial_delay_ms < 1
+                || options_.reconnect_max_delay_ms < options_.reconnect_initial_delay_ms
+                || options_.reconnect_multiplier < 1.0
+                || options_.reconnect_jitter < 0.0 || options_.reconnect_jitter > 1.0) {
+                std::cerr << "TCP Comm config error: invalid 'reconnect' options." << std::endl;
+                return HAKO_PDU_ERR_INVALID_ARGUMENT;
+            }
+        }
+        options_.resync_on_connect = opts.value("resync_on_connect", options_.resync_on_connect);
+        options_.latency_tracking = opts.value("latency_tracking", options_.latency_tracking);
     }
+    set_latency_tracking(options_.latency_tracking);
 
     if (role_ == Role::Server) {
         addrinfo* local_addr_info = nullptr;
@@ -174,6 +199,21 @@ HakoPduErrorType TcpComm::raw_open(const std::string& config_path) {
         freeaddrinfo(remote_addr_info);
     }
 
+    if (options_.use_io_uring) {
+        auto recv_uring = std::make_unique<IoUringIo>();
+        auto send_uring = std::make_unique<IoUringIo>();
+        const bool needs_recv = config_direction_ != HAKO_PDU_ENDPOINT_DIRECTION_OUT;
+        if ((needs_recv && recv_uring->init(options_.io_uring, true) != HAKO_PDU_ERR_OK)
+            || send_uring->init(options_.io_uring, false) != HAKO_PDU_ERR_OK) {
+            std::cerr << "TCP Comm: io_uring backend unavailable, falling back to socket I/O." << std::endl;
+        } else {
+            if (needs_recv) {
+                recv_uring_ = std::move(recv_uring);
+            }
+            send_uring_ = std::move(send_uring);
+        }
+    }
+
     return HAKO_PDU_ERR_OK;
 }
 
@@ -189,6 +229,9 @@ HakoPduErrorType TcpComm::raw_close() noexcept {
         ::close(current_listen_fd);
         listen_fd_ = -1;
     }
+    recv_uring_.reset();
+    send_uring_.reset();
+    wakeup_.close();
     return HAKO_PDU_ERR_OK;
 }
 
@@ -197,6 +240,11 @@ HakoPduErrorType TcpComm::raw_start() noexcept {
         std::cerr << "TCP Comm start requested while already running." << std::endl;
         return HAKO_PDU_ERR_BUSY;
     }
+    if (wakeup_.open() != HAKO_PDU_ERR_OK) {
+        std::cerr << "TCP Comm start failed: cannot create wakeup fd." << std::endl;
+        return HAKO_PDU_ERR_IO_ERROR;
+    }
+    wakeup_.drain();
     is_running_flag_ = true;
     if (role_ == Role::Server) {
         comm_thread_ = std::thread(&TcpComm::server_loop, this);
@@ -211,13 +259,8 @@ HakoPduErrorType TcpComm::raw_stop() noexcept {
         return HAKO_PDU_ERR_OK;
     }
     is_running_flag_ = false;
-
-    int current_listen_fd = listen_fd_.load();
-    if (current_listen_fd >= 0) {
-        ::shutdown(current_listen_fd, SHUT_RD);
-        ::close(current_listen_fd);
-        listen_fd_ = -1;
-    }
+    // Wakes accept/connect/backoff/read waits; shutdown also unblocks a writer.
+    wakeup_.notify();
     int current_client_fd = client_fd_.load();
     if (current_client_fd >= 0) {
         ::shutdown(current_client_fd, SHUT_RDWR);
@@ -226,6 +269,7 @@ HakoPduErrorType TcpComm::raw_stop() noexcept {
     if (comm_thread_.joinable()) {
         comm_thread_.join();
     }
+    // The listen socket stays open until raw_close() so the comm can be restarted.
     is_connected_ = false;
     return HAKO_PDU_ERR_OK;
 }
@@ -235,6 +279,19 @@ HakoPduErrorType TcpComm::raw_is_running(bool& running) noexcept {
     return HAKO_PDU_ERR_OK;
 }
 
+HakoPduErrorType TcpComm::get_socket_stats(PduCommSocketStats& stats) const noexcept {
+    stats = PduCommSocketStats{};
+    const int fd = client_fd_.load();
+    if (fd < 0) {
+        return HAKO_PDU_ERR_NOT_RUNNING;
+    }
+    socklen_t len = sizeof(stats.recv_buffer_size);
+    if (getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &stats.recv_buffer_size, &len) != 0) {
+        return map_errno_to_error(errno);
+    }
+    return HAKO_PDU_ERR_OK;
+}
+
 HakoPduErrorType TcpComm::raw_send(const std::vector<std::byte>& data) noexcept {
     #ifdef ENABLE_DEBUG_MESSAGES
     std::cout << "DEBUG: TCP Comm raw_send called with " << data.size() << " bytes." << std::endl;
@@ -254,8 +311,32 @@ HakoPduErrorType TcpComm::raw_send(const std::vector<std::byte>& data) noexcept
     return write_data(current_client_fd, data.data(), data.size());
 }
 
+HakoPduErrorType TcpComm::raw_send_batch(std::span<const std::vector<std::byte>> frames) noexcept {
+    if (!send_uring_) {
+        return PduCommRaw::raw_send_batch(frames);
+    }
+    int current_client_fd = client_fd_.load();
+    if (current_client_fd < 0) {
+        std::cout << "TCP Comm send failed: not connected." << std::endl;
+        return HAKO_PDU_ERR_NOT_RUNNING;
+    }
+    if (config_direction_ == HAKO_PDU_ENDPOINT_DIRECTION_IN) {
+        std::cerr << "TCP Comm send failed: endpoint configured as IN only." << std::endl;
+        return HAKO_PDU_ERR_INVALID_ARGUMENT;
+    }
+    // Linked sends keep frame order and go out with one io_uring_enter.
+    return send_uring_->send_batch(current_client_fd, frames, nullptr, 0, false);
+}
+
 void TcpComm::server_loop() {
     while (is_running_flag_) {
+        HakoPduErrorType wait_err = poll_with_wakeup(listen_fd_.load(), POLLIN, wakeup_, -1);
+        if (wait_err == HAKO_PDU_ERR_NOT_RUNNING) {
+            break;
+        }
+        if (wait_err != HAKO_PDU_ERR_OK) {
+            continue;
+        }
         sockaddr_storage client_addr{};
         socklen_t client_len = sizeof(client_addr);
         int accepted_fd = ::accept(listen_fd_.load(), reinterpret_cast<sockaddr*>(&client_addr), &client_len);
@@ -270,60 +351,9 @@ void TcpComm::server_loop() {
         client_fd_ = accepted_fd;
         configure_socket_options(client_fd_.load(), options_);
         is_connected_ = true;
+        on_connected();
 
-        while (is_running_flag_) {
-            if (packet_version() == "v1") {
-                std::array<std::byte, 4> header_len_buf{};
-                HakoPduErrorType err = read_data(client_fd_.load(), header_len_buf.data(), header_len_buf.size());
-                if (err != HAKO_PDU_ERR_OK) {
-                    std::cerr << "TCP Comm read v1 header length failed: " << static_cast<int>(err) << std::endl;
-                    break;
-                }
-                uint32_t header_len = read_le32(header_len_buf.data());
-                if (header_len == 0 || header_len > kMaxV1PacketSize) {
-                    std::cerr << "TCP Comm v1 header length invalid: " << header_len << std::endl;
-                    break;
-                }
-                std::vector<std::byte> packet_buf(4 + header_len);
-                std::memcpy(packet_buf.data(), header_len_buf.data(), header_len_buf.size());
-                err = read_data(client_fd_.load(), packet_buf.data() + 4, header_len);
-                if (err != HAKO_PDU_ERR_OK) {
-                    std::cerr << "TCP Comm read v1 payload failed: " << static_cast<int>(err) << std::endl;
-                    break;
-                }
-                on_raw_data_received(packet_buf);
-                continue;
-            }
-
-            std::vector<std::byte> header_buf(sizeof(MetaPdu));
-            HakoPduErrorType err = read_data(client_fd_.load(), header_buf.data(), header_buf.size());
-            if (err != HAKO_PDU_ERR_OK) {
-                std::cerr << "TCP Comm read header failed: " << static_cast<int>(err) << std::endl;
-                // Connection closed or error
-                break;
-            }
-            #ifdef ENABLE_DEBUG_MESSAGES
-            std::cout << "DEBUG: TCP Comm server received header." << std::endl;
-            #endif
-            MetaPdu meta;
-            std::memcpy(&meta, header_buf.data(), sizeof(MetaPdu));
-            meta.body_len = from_le32(meta.body_len);
-
-            if (meta.body_len > 0) {
-                std::vector<std::byte> body_buf(meta.body_len);
-                err = read_data(client_fd_.load(), body_buf.data(), body_buf.size());
-                if (err != HAKO_PDU_ERR_OK) {
-                    std::cerr << "TCP Comm read body failed: " << static_cast<int>(err) << std::endl;
-                    // Incomplete packet or error
-                    break;
-                }
-                header_buf.insert(header_buf.end(), body_buf.begin(), body_buf.end());
-            }
-            #ifdef ENABLE_DEBUG_MESSAGES
-            std::cout << "DEBUG: TCP Comm server received full packet." << std::endl;
-            #endif
-            on_raw_data_received(header_buf);
-        }
+        read_loop(client_fd_.load());
         is_connected_ = false;
         int current_client_fd = client_fd_.load();
         if (current_client_fd >= 0) {
@@ -334,11 +364,12 @@ void TcpComm::server_loop() {
 }
 
 void TcpComm::client_loop() {
+    int reconnect_delay_ms = options_.reconnect_initial_delay_ms;
     while (is_running_flag_) {
         client_fd_ = ::socket(remote_addr_info_.ss_family, kTcpSocketType, 0);
         if (client_fd_.load() < 0) {
             std::cerr << "TCP Comm client socket create failed: " << std::strerror(errno) << std::endl;
-            std::this_thread::sleep_for(std::chrono::seconds(1));
+            sleep_while_running(next_reconnect_delay_ms(reconnect_delay_ms));
             continue;
         }
 
@@ -352,80 +383,193 @@ void TcpComm::client_loop() {
             std::cerr << "TCP Comm connect failed: " << static_cast<int>(connect_err) << std::endl;
             ::close(client_fd_.load());
             client_fd_ = -1;
-            std::this_thread::sleep_for(std::chrono::seconds(1));
+            sleep_while_running(next_reconnect_delay_ms(reconnect_delay_ms));
             continue;
         }
 
         configure_socket_options(client_fd_.load(), options_);
         is_connected_ = true;
+        reconnect_delay_ms = options_.reconnect_initial_delay_ms;
+        on_connected();
 
-        while (is_running_flag_) {
-            if (packet_version() == "v1") {
-                std::array<std::byte, 4> header_len_buf{};
-                HakoPduErrorType err = read_data(client_fd_.load(), header_len_buf.data(), header_len_buf.size());
-                if (err != HAKO_PDU_ERR_OK) {
-                    std::cerr << "TCP Comm read v1 header length failed: " << static_cast<int>(err) << std::endl;
-                    break;
-                }
-                uint32_t header_len = read_le32(header_len_buf.data());
-                if (header_len == 0 || header_len > kMaxV1PacketSize) {
-                    std::cerr << "TCP Comm v1 header length invalid: " << header_len << std::endl;
-                    break;
-                }
-                std::vector<std::byte> packet_buf(4 + header_len);
-                std::memcpy(packet_buf.data(), header_len_buf.data(), header_len_buf.size());
-                err = read_data(client_fd_.load(), packet_buf.data() + 4, header_len);
-                if (err != HAKO_PDU_ERR_OK) {
-                    std::cerr << "TCP Comm read v1 payload failed: " << static_cast<int>(err) << std::endl;
-                    break;
-                }
-                on_raw_data_received(packet_buf);
-                continue;
-            }
+        read_loop(client_fd_.load());
+        is_connected_ = false;
+        ::close(client_fd_.load());
+        client_fd_ = -1;
+        if (rejected_) {
+            // The server is full or rate limited: retrying early only gets refused again.
+            rejected_ = false;
+            reconnect_delay_ms = options_.reconnect_max_delay_ms;
+        }
+        // Retry quickly after a drop (e.g. server restart), then back off.
+        sleep_while_running(next_reconnect_delay_ms(reconnect_delay_ms));
+    }
+}
+
+void TcpComm::raw_on_control_packet(const DataPacketView& packet) noexcept {
+    if (packet.meta.meta_request_type != static_cast<uint32_t>(MetaRequestType::SESSION_REJECTED)) {
+        PduCommRaw::raw_on_control_packet(packet);
+        return;
+    }
+    rejected_count_.fetch_add(1);
+    rejected_ = (role_ == Role::Client);
+    std::cerr << "TCP Comm: connection rejected by server ("
+              << std::string_view(reinterpret_cast<const char*>(packet.body.data()), packet.body.size())
+              << ")." << std::endl;
+}
 
-            std::vector<std::byte> header_buf(sizeof(MetaPdu));
-            HakoPduErrorType err = read_data(client_fd_.load(), header_buf.data(), header_buf.size());
+void TcpComm::on_connected() {
+    if (on_connected_callback_) {
+        on_connected_callback_();
+    }
+}
+
+int TcpComm::next_reconnect_delay_ms(int& current_delay_ms) {
+    int delay_ms = current_delay_ms;
+    if (options_.reconnect_jitter > 0.0 && delay_ms > 0) {
+        std::uniform_real_distribution<double> jitter(-options_.reconnect_jitter, options_.reconnect_jitter);
+        delay_ms = std::max(1, static_cast<int>(delay_ms * (1.0 + jitter(reconnect_rng_))));
+    }
+    const double next = current_delay_ms * options_.reconnect_multiplier;
+    current_delay_ms = (next > options_.reconnect_max_delay_ms)
+        ? options_.reconnect_max_delay_ms
+        : static_cast<int>(next);
+    return delay_ms;
+}
+
+void TcpComm::sleep_while_running(int delay_ms) {
+    if (delay_ms > 0 && is_running_flag_) {
+        (void)poll_with_wakeup(-1, 0, wakeup_, delay_ms);
+    }
+}
+
+void TcpComm::read_loop(int fd) {
+    if (recv_uring_ && read_loop_uring(fd)) {
+        return;
+    }
+    while (is_running_flag_) {
+        if (packet_version() == "v1") {
+            std::array<std::byte, 4> header_len_buf{};
+            HakoPduErrorType err = read_data(fd, header_len_buf.data(), header_len_buf.size());
             if (err != HAKO_PDU_ERR_OK) {
-                std::cerr << "TCP Comm read header failed: " << static_cast<int>(err) << std::endl;
-                break; // Disconnected
+                std::cerr << "TCP Comm read v1 header length failed: " << static_cast<int>(err) << std::endl;
+                break;
             }
-            #ifdef ENABLE_DEBUG_MESSAGES
-            std::cout << "DEBUG: TCP Comm client received header." << std::endl;
-            #endif
-            MetaPdu meta;
-            std::memcpy(&meta, header_buf.data(), sizeof(MetaPdu));
-            meta.body_len = from_le32(meta.body_len);
-
-            std::vector<std::byte> body_buf;
-            if (meta.body_len > 0) {
-                body_buf.resize(meta.body_len);
-                err = read_data(client_fd_.load(), body_buf.data(), body_buf.size());
-                if (err != HAKO_PDU_ERR_OK) {
-                    std::cerr << "TCP Comm read body failed: " << static_cast<int>(err) << std::endl;
-                    break; // Incomplete packet
-                }
+            uint32_t header_len = read_le32(header_len_buf.data());
+            if (header_len == 0 || header_len > kMaxV1PacketSize) {
+                std::cerr << "TCP Comm v1 header length invalid: " << header_len << std::endl;
+                break;
+            }
+            std::vector<std::byte> packet_buf(4 + header_len);
+            std::memcpy(packet_buf.data(), header_len_buf.data(), header_len_buf.size());
+            err = read_data(fd, packet_buf.data() + 4, header_len);
+            if (err != HAKO_PDU_ERR_OK) {
+                std::cerr << "TCP Comm read v1 payload failed: " << static_cast<int>(err) << std::endl;
+                break;
             }
+            on_raw_data_received(packet_buf, last_rx_time_ns_);
+            continue;
+        }
 
-            std::vector<std::byte> full_packet = header_buf;
-            full_packet.insert(full_packet.end(), body_buf.begin(), body_buf.end());
-            on_raw_data_received(full_packet);
+        std::vector<std::byte> header_buf(sizeof(MetaPdu));
+        HakoPduErrorType err = read_data(fd, header_buf.data(), header_buf.size());
+        if (err != HAKO_PDU_ERR_OK) {
+            std::cerr << "TCP Comm read header failed: " << static_cast<int>(err) << std::endl;
+            break; // Disconnected
         }
-        ::close(client_fd_.load());
-        client_fd_ = -1;
+        #ifdef ENABLE_DEBUG_MESSAGES
+        std::cout << "DEBUG: TCP Comm received header." << std::endl;
+        #endif
+        MetaPdu meta;
+        std::memcpy(&meta, header_buf.data(), sizeof(MetaPdu));
+        meta.body_len = from_le32(meta.body_len);
+
+        if (meta.body_len > 0) {
+            std::vector<std::byte> body_buf(meta.body_len);
+            err = read_data(fd, body_buf.data(), body_buf.size());
+            if (err != HAKO_PDU_ERR_OK) {
+                std::cerr << "TCP Comm read body failed: " << static_cast<int>(err) << std::endl;
+                break; // Incomplete packet
+            }
+            header_buf.insert(header_buf.end(), body_buf.begin(), body_buf.end());
+        }
+        on_raw_data_received(header_buf, last_rx_time_ns_);
     }
 }
 
+bool TcpComm::read_loop_uring(int fd) {
+    StreamFrameAssembler assembler(packet_version());
+    bool framing_ok = true;
+    auto on_chunk = [&](std::span<const std::byte> data, const sockaddr*, socklen_t) {
+        if (framing_ok) {
+            framing_ok = assembler.feed(data, [this](const std::vector<std::byte>& frame) {
+                on_raw_data_received(frame);
+            });
+        }
+    };
+    const int poll_interval_ms = (options_.read_timeout_ms > 0) ? options_.read_timeout_ms : 1000;
+    HakoPduErrorType err = recv_uring_->run_recv(fd, false, is_running_flag_, poll_interval_ms, on_chunk,
+                                                 wakeup_.fd());
+    if (err == HAKO_PDU_ERR_UNSUPPORTED) {
+        std::cerr << "TCP Comm: io_uring multishot receive unsupported, falling back to recv()." << std::endl;
+        recv_uring_.reset();
+        return false;
+    }
+    if (!framing_ok) {
+        std::cerr << "TCP Comm frame invalid, dropping connection." << std::endl;
+    } else if (err != HAKO_PDU_ERR_OK && is_running_flag_) {
+        std::cerr << "TCP Comm io_uring receive stopped: " << static_cast<int>(err) << std::endl;
+    }
+    return true;
+}
+
+ssize_t TcpComm::recv_timestamped(int fd, std::byte* buffer, size_t size) noexcept {
+    iovec iov{buffer, size};
+    union {
+        char buf[CMSG_SPACE(sizeof(timespec))];
+        cmsghdr align;
+    } control;
+    msghdr hdr{};
+    hdr.msg_iov = &iov;
+    hdr.msg_iovlen = 1;
+    hdr.msg_control = control.buf;
+    hdr.msg_controllen = sizeof(control.buf);
+    ssize_t received = ::recvmsg(fd, &hdr, MSG_DONTWAIT);
+    if (received <= 0) {
+        return received;
+    }
+    last_rx_time_ns_ = 0;
+    for (cmsghdr* cm = CMSG_FIRSTHDR(&hdr); cm != nullptr; cm = CMSG_NXTHDR(&hdr, cm)) {
+        if (cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_TIMESTAMPNS) {
+            timespec ts{};
+            std::memcpy(&ts, CMSG_DATA(cm), sizeof(ts));
+            last_rx_time_ns_ = static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+        }
+    }
+    return received;
+}
+
 HakoPduErrorType TcpComm::read_data(int fd, std::byte* buffer, size_t size) noexcept {
     size_t total_received = 0;
     while (total_received < size) {
-        ssize_t received = ::recv(fd, buffer + total_received, size - total_received, 0);
+        // Non-blocking read first; poll (with the stop wakeup) only when the socket is empty.
+        ssize_t received = options_.latency_tracking
+            ? recv_timestamped(fd, buffer + total_received, size - total_received)
+            : ::recv(fd, buffer + total_received, size - total_received, MSG_DONTWAIT);
         if (received > 0) {
             total_received += received;
         } else if (received == 0) {
             return HAKO_PDU_ERR_IO_ERROR; // Connection closed
         } else {
             if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                // Should use poll/select for non-blocking
+                HakoPduErrorType wait_err = poll_with_wakeup(fd, POLLIN, wakeup_,
+                                                             options_.read_timeout_ms > 0 ? options_.read_timeout_ms : -1);
+                if (wait_err == HAKO_PDU_ERR_NOT_RUNNING) {
+                    return wait_err;
+                }
+                continue;
+            }
+            if (errno == EINTR) {
                 continue;
             }
             return map_errno_to_error(errno);
@@ -437,7 +581,7 @@ HakoPduErrorType TcpComm::read_data(int fd, std::byte* buffer, size_t size) noex
 HakoPduErrorType TcpComm::write_data(int fd, const std::byte* buffer, size_t size) noexcept {
     size_t total_sent = 0;
     while (total_sent < size) {
-        ssize_t sent = ::send(fd, buffer + total_sent, size - total_sent, 0);
+        ssize_t sent = ::send(fd, buffer + total_sent, size - total_sent, kStreamSendFlags);
         if (sent > 0) {
             total_sent += sent;
         } else if (sent == 0) {
@@ -489,6 +633,12 @@ HakoPduErrorType TcpComm::configure_socket_options(int fd, const Options& option
             return HAKO_PDU_ERR_IO_ERROR;
         }
     }
+    if (options.latency_tracking) {
+        int on = 1;
+        if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) != 0) {
+            return HAKO_PDU_ERR_IO_ERROR;
+        }
+    }
     if (options.linger_enabled) {
         linger linger_opts{};
         linger_opts.l_onoff = 1;
@@ -544,12 +694,9 @@ HakoPduErrorType TcpComm::connect_with_timeout(int fd, addrinfo* remote_addr, co
     if (errno != EINPROGRESS) {
         return HAKO_PDU_ERR_IO_ERROR;
     }
-    pollfd poll_fd{};
-    poll_fd.fd = fd;
-    poll_fd.events = POLLOUT;
-    int poll_result = ::poll(&poll_fd, 1, options.connect_timeout_ms);
-    if (poll_result <= 0) {
-        return HAKO_PDU_ERR_TIMEOUT;
+    HakoPduErrorType wait_err = poll_with_wakeup(fd, POLLOUT, wakeup_, options.connect_timeout_ms);
+    if (wait_err != HAKO_PDU_ERR_OK) {
+        return wait_err; // TIMEOUT, or NOT_RUNNING when stop() interrupted the connect
     }
     int so_error = 0;
     socklen_t so_error_len = sizeof(so_error);
@@ -10,9 +10,21 @@
 #include <netinet/tcp.h>
 #include <poll.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
+#if defined(__linux__)
+#include <sys/epoll.h>
+#endif
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
 #include <iostream>
+#include <system_error>
+#include <unordered_map>
 #include <vector>
 
 namespace hakoniwa {
@@ -48,11 +60,18 @@ uint32_t from_le32(uint32_t value) noexcept
 #endif
 }
 
-class TcpSessionComm final : public PduCommRaw
+// Session config parsing and socket setup shared by both I/O models.
+class TcpMuxSessionBase : public PduCommRaw
 {
 public:
-    explicit TcpSessionComm(int fd) : fd_(fd) {}
-    ~TcpSessionComm() override { (void)raw_close(); }
+    // config: the mux's parsed config, used instead of reading config_path again.
+    // live_sessions: the mux's admission count, already incremented for this session.
+    TcpMuxSessionBase(int fd, std::shared_ptr<const nlohmann::json> config,
+                      std::shared_ptr<std::atomic<size_t>> live_sessions)
+        : fd_(fd), config_(std::move(config)), live_sessions_(std::move(live_sessions))
+    {
+    }
+    ~TcpMuxSessionBase() override { release_admission_slot_(); }
 
 protected:
     HakoPduErrorType raw_open(const std::string& config_path) override
@@ -61,19 +80,21 @@ protected:
             return HAKO_PDU_ERR_IO_ERROR;
         }
 
-        std::ifstream config_stream(config_path);
-        if (!config_stream) {
-            std::cerr << "Failed to open TCP Mux Comm config file: " << config_path << std::endl;
-            return HAKO_PDU_ERR_IO_ERROR;
-        }
-
-        nlohmann::json config_json;
-        try {
-            config_stream >> config_json;
-        } catch (const nlohmann::json::exception& e) {
-            std::cerr << "TCP Mux Comm config JSON parse error: " << e.what() << std::endl;
-            return HAKO_PDU_ERR_INVALID_ARGUMENT;
+        nlohmann::json file_json;
+        if (!config_) {
+            std::ifstream config_stream(config_path);
+            if (!config_stream) {
+                std::cerr << "Failed to open TCP Mux Comm config file: " << config_path << std::endl;
+                return HAKO_PDU_ERR_IO_ERROR;
+            }
+            try {
+                config_stream >> file_json;
+            } catch (const nlohmann::json::exception& e) {
+                std::cerr << "TCP Mux Comm config JSON parse error: " << e.what() << std::endl;
+                return HAKO_PDU_ERR_INVALID_ARGUMENT;
+            }
         }
+        const nlohmann::json& config_json = config_ ? *config_ : file_json;
 
         if (!config_json.contains("protocol") || config_json.at("protocol").get<std::string>() != "tcp") {
             std::cerr << "TCP Mux Comm config error: protocol is not 'tcp'." << std::endl;
@@ -115,59 +136,6 @@ protected:
         return configure_socket_options_(fd_, options_);
     }
 
-    HakoPduErrorType raw_close() noexcept override
-    {
-        raw_stop();
-        if (fd_ >= 0) {
-            ::close(fd_);
-            fd_ = -1;
-        }
-        return HAKO_PDU_ERR_OK;
-    }
-
-    HakoPduErrorType raw_start() noexcept override
-    {
-        if (is_running_) {
-            return HAKO_PDU_ERR_BUSY;
-        }
-        is_running_ = true;
-        recv_thread_ = std::thread(&TcpSessionComm::recv_loop_, this);
-        return HAKO_PDU_ERR_OK;
-    }
-
-    HakoPduErrorType raw_stop() noexcept override
-    {
-        if (!is_running_) {
-            return HAKO_PDU_ERR_OK;
-        }
-        is_running_ = false;
-        if (fd_ >= 0) {
-            ::shutdown(fd_, SHUT_RDWR);
-        }
-        if (recv_thread_.joinable()) {
-            recv_thread_.join();
-        }
-        return HAKO_PDU_ERR_OK;
-    }
-
-    HakoPduErrorType raw_is_running(bool& running) noexcept override
-    {
-        running = is_running_.load();
-        return HAKO_PDU_ERR_OK;
-    }
-
-    HakoPduErrorType raw_send(const std::vector<std::byte>& data) noexcept override
-    {
-        if (fd_ < 0) {
-            return HAKO_PDU_ERR_NOT_RUNNING;
-        }
-        if (config_direction_ == HAKO_PDU_ENDPOINT_DIRECTION_IN) {
-            return HAKO_PDU_ERR_INVALID_ARGUMENT;
-        }
-        return write_data_(fd_, data.data(), data.size());
-    }
-
-private:
     struct Options {
         int read_timeout_ms = 1000;
         int write_timeout_ms = 1000;
@@ -244,17 +212,118 @@ private:
         return HAKO_PDU_ERR_OK;
     }
 
+    // Once the session is closed or its peer has gone away.
+    void release_admission_slot_() noexcept
+    {
+        if (live_sessions_ && !slot_released_.exchange(true)) {
+            live_sessions_->fetch_sub(1);
+        }
+    }
+
+    int fd_ = -1;
+    std::shared_ptr<const nlohmann::json> config_;
+    HakoPduEndpointDirectionType config_direction_ = HAKO_PDU_ENDPOINT_DIRECTION_INOUT;
+    Options options_{};
+
+private:
+    std::shared_ptr<std::atomic<size_t>> live_sessions_;
+    std::atomic<bool> slot_released_{false};
+};
+
+class TcpSessionComm final : public TcpMuxSessionBase
+{
+public:
+    TcpSessionComm(int fd, std::shared_ptr<const nlohmann::json> config,
+                   std::shared_ptr<std::atomic<size_t>> live_sessions)
+        : TcpMuxSessionBase(fd, std::move(config), std::move(live_sessions))
+    {
+    }
+    ~TcpSessionComm() override { (void)raw_close(); }
+
+protected:
+    HakoPduErrorType raw_close() noexcept override
+    {
+        raw_stop();
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+        wakeup_.close();
+        release_admission_slot_();
+        return HAKO_PDU_ERR_OK;
+    }
+
+    HakoPduErrorType raw_start() noexcept override
+    {
+        if (is_running_) {
+            return HAKO_PDU_ERR_BUSY;
+        }
+        if (wakeup_.open() != HAKO_PDU_ERR_OK) {
+            return HAKO_PDU_ERR_IO_ERROR;
+        }
+        wakeup_.drain();
+        if (recv_thread_.joinable()) {
+            recv_thread_.join(); // ended by the peer closing
+        }
+        is_running_ = true;
+        recv_thread_ = std::thread(&TcpSessionComm::recv_loop_, this);
+        return HAKO_PDU_ERR_OK;
+    }
+
+    HakoPduErrorType raw_stop() noexcept override
+    {
+        // recv_loop_ also ends on its own when the peer closes; join it then too.
+        if (!is_running_ && !recv_thread_.joinable()) {
+            return HAKO_PDU_ERR_OK;
+        }
+        is_running_ = false;
+        wakeup_.notify();
+        if (fd_ >= 0) {
+            ::shutdown(fd_, SHUT_RDWR);
+        }
+        if (recv_thread_.joinable()) {
+            recv_thread_.join();
+        }
+        return HAKO_PDU_ERR_OK;
+    }
+
+    HakoPduErrorType raw_is_running(bool& running) noexcept override
+    {
+        running = is_running_.load();
+        return HAKO_PDU_ERR_OK;
+    }
+
+    HakoPduErrorType raw_send(const std::vector<std::byte>& data) noexcept override
+    {
+        if (fd_ < 0) {
+            return HAKO_PDU_ERR_NOT_RUNNING;
+        }
+        if (config_direction_ == HAKO_PDU_ENDPOINT_DIRECTION_IN) {
+            return HAKO_PDU_ERR_INVALID_ARGUMENT;
+        }
+        return write_data_(fd_, data.data(), data.size());
+    }
+
+private:
     HakoPduErrorType read_data_(int fd, std::byte* buffer, size_t size) noexcept
     {
         size_t total_received = 0;
         while (total_received < size) {
-            ssize_t received = ::recv(fd, buffer + total_received, size - total_received, 0);
+            ssize_t received = ::recv(fd, buffer + total_received, size - total_received, MSG_DONTWAIT);
             if (received > 0) {
                 total_received += received;
             } else if (received == 0) {
                 return HAKO_PDU_ERR_IO_ERROR;
             } else {
                 if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    HakoPduErrorType wait_err = poll_with_wakeup(fd, POLLIN, wakeup_,
+                                                                 options_.read_timeout_ms > 0 ? options_.read_timeout_ms : -1);
+                    if (wait_err == HAKO_PDU_ERR_NOT_RUNNING) {
+                        return wait_err;
+                    }
+                    continue;
+                }
+                if (errno == EINTR) {
                     continue;
                 }
                 return map_errno_to_error(errno);
@@ -267,7 +336,7 @@ private:
     {
         size_t total_sent = 0;
         while (total_sent < size) {
-            ssize_t sent = ::send(fd, buffer + total_sent, size - total_sent, 0);
+            ssize_t sent = ::send(fd, buffer + total_sent, size - total_sent, kStreamSendFlags);
             if (sent > 0) {
                 total_sent += sent;
             } else if (sent == 0) {
@@ -324,18 +393,490 @@ private:
             }
             on_raw_data_received(header_buf);
         }
+        if (is_running_) {
+            release_admission_slot_(); // the peer closed, not raw_stop()
+        }
         is_running_ = false;
     }
 
-    int fd_ = -1;
     std::atomic<bool> is_running_{false};
+    WakeupFd wakeup_;
     std::thread recv_thread_;
-    HakoPduEndpointDirectionType config_direction_ = HAKO_PDU_ENDPOINT_DIRECTION_INOUT;
-    Options options_{};
 };
 
 } // namespace
 
+#if defined(__linux__)
+// N epoll loops shared by the reactor sessions of one mux. Sessions register
+// and deregister under the loop mutex. The loop thread looks a ready fd up
+// under it, marks the session as current and runs its events (and so the user
+// callbacks) with the mutex released. raw_stop() from another thread waits
+// until its session is no longer current, so a session is never called after
+// raw_stop() returns; a callback may stop or close any session of its loop.
+struct TcpCommMultiplexer::Reactor {
+    static constexpr int kMaxEvents = 256;
+
+    struct Loop {
+        int epoll_fd = -1;
+        WakeupFd wakeup;
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable dispatched; // current went back to null
+        ReactorSession* current = nullptr;  // session whose events are running
+        std::unordered_map<int, ReactorSession*> sessions;
+    };
+
+    ~Reactor();
+    HakoPduErrorType start(int threads) noexcept;
+    Loop& pick() noexcept { return *loops[next_loop.fetch_add(1) % loops.size()]; }
+    void run(Loop& loop) noexcept;
+
+    std::vector<std::unique_ptr<Loop>> loops;
+    std::atomic<bool> running{false};
+    std::atomic<size_t> next_loop{0};
+};
+
+// Session comm driven by a reactor loop: a non-blocking fd whose input is
+// parsed incrementally into frames, and whose output goes straight to the
+// socket, with the part the socket does not take queued until EPOLLOUT.
+class TcpCommMultiplexer::ReactorSession final : public TcpMuxSessionBase
+{
+public:
+    ReactorSession(int fd, std::shared_ptr<const nlohmann::json> config,
+                   std::shared_ptr<std::atomic<size_t>> live_sessions, std::shared_ptr<Reactor> reactor,
+                   size_t max_send_queue_bytes)
+        : TcpMuxSessionBase(fd, std::move(config), std::move(live_sessions)), reactor_(std::move(reactor)), max_send_queue_bytes_(max_send_queue_bytes)
+    {
+    }
+    ~ReactorSession() override { (void)raw_close(); }
+
+    // Loop thread, loop mutex not held (this session is the loop's current one).
+    void on_events_(uint32_t events) noexcept
+    {
+        if ((events & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0 && !read_ready_()) {
+            fail_();
+            return;
+        }
+        if ((events & EPOLLOUT) != 0) {
+            bool failed = false;
+            {
+                std::lock_guard<std::mutex> lock(tx_mutex_);
+                failed = flush_locked_() != HAKO_PDU_ERR_OK;
+                if (!failed && tx_queue_.empty()) {
+                    set_events_(EPOLLIN);
+                }
+            }
+            if (failed) {
+                fail_();
+            }
+        }
+    }
+
+protected:
+    HakoPduErrorType raw_open(const std::string& config_path) override
+    {
+        HakoPduErrorType err = TcpMuxSessionBase::raw_open(config_path);
+        if (err != HAKO_PDU_ERR_OK) {
+            return err;
+        }
+        int flags = fcntl(fd_, F_GETFL, 0);
+        if (flags < 0 || fcntl(fd_, F_SETFL, flags | O_NONBLOCK) != 0) {
+            return HAKO_PDU_ERR_IO_ERROR;
+        }
+        return HAKO_PDU_ERR_OK;
+    }
+
+    HakoPduErrorType raw_close() noexcept override
+    {
+        raw_stop();
+        std::lock_guard<std::mutex> lock(tx_mutex_);
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+        tx_queue_.clear();
+        tx_queued_bytes_ = 0;
+        tx_offset_ = 0;
+        release_admission_slot_();
+        return HAKO_PDU_ERR_OK;
+    }
+
+    HakoPduErrorType raw_start() noexcept override
+    {
+        if (is_running_) {
+            return HAKO_PDU_ERR_BUSY;
+        }
+        if (fd_ < 0) {
+            return HAKO_PDU_ERR_NOT_RUNNING;
+        }
+        Reactor::Loop& loop = reactor_->pick();
+        std::lock_guard<std::mutex> loop_lock(loop.mutex);
+        std::lock_guard<std::mutex> lock(tx_mutex_);
+        try {
+            loop.sessions[fd_] = this;
+        } catch (const std::bad_alloc&) {
+            return HAKO_PDU_ERR_OUT_OF_MEMORY;
+        }
+        epoll_event ev{};
+        ev.events = tx_queue_.empty() ? EPOLLIN : (EPOLLIN | EPOLLOUT);
+        ev.data.fd = fd_;
+        if (epoll_ctl(loop.epoll_fd, EPOLL_CTL_ADD, fd_, &ev) != 0) {
+            const int saved_errno = errno;
+            loop.sessions.erase(fd_);
+            return map_errno_to_error(saved_errno);
+        }
+        loop_ = &loop;
+        home_loop_ = &loop;
+        is_running_ = true;
+        return HAKO_PDU_ERR_OK;
+    }
+
+    HakoPduErrorType raw_stop() noexcept override
+    {
+        Reactor::Loop* loop = home_loop_;
+        if (loop == nullptr) {
+            return HAKO_PDU_ERR_OK;
+        }
+        std::unique_lock<std::mutex> loop_lock(loop->mutex);
+        deregister_locked_();
+        {
+            std::lock_guard<std::mutex> lock(tx_mutex_);
+            is_running_ = false;
+        }
+        // Called from the loop thread (a callback), the dispatch is this call's caller.
+        if (std::this_thread::get_id() != loop->thread.get_id()) {
+            while (loop->current == this) {
+                loop->dispatched.wait_for(loop_lock, std::chrono::milliseconds(100));
+            }
+        }
+        return HAKO_PDU_ERR_OK;
+    }
+
+    HakoPduErrorType raw_is_running(bool& running) noexcept override
+    {
+        running = is_running_.load();
+        return HAKO_PDU_ERR_OK;
+    }
+
+    HakoPduErrorType raw_send(const std::vector<std::byte>& data) noexcept override
+    {
+        return send_locked_(data, nullptr);
+    }
+
+    HakoPduErrorType raw_send_frame(const PduSharedFrame& frame) noexcept override
+    {
+        return send_locked_(frame->bytes, frame);
+    }
+
+private:
+    static constexpr size_t kInitialRxBufferSize = 64 * 1024;
+    static constexpr size_t kMaxFlushFrames = 64;
+
+    // Read or flush failed (or the peer closed): leave the loop for good.
+    void fail_() noexcept
+    {
+        Reactor::Loop* loop = loop_;
+        if (loop != nullptr) {
+            std::lock_guard<std::mutex> loop_lock(loop->mutex);
+            deregister_locked_();
+        }
+        release_admission_slot_();
+        std::lock_guard<std::mutex> lock(tx_mutex_);
+        is_running_ = false;
+    }
+
+    // Loop mutex held.
+    void deregister_locked_() noexcept
+    {
+        Reactor::Loop* loop = loop_;
+        if (loop == nullptr) {
+            return;
+        }
+        if (fd_ >= 0) {
+            (void)epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, fd_, nullptr);
+            loop->sessions.erase(fd_);
+        }
+        loop_ = nullptr;
+    }
+
+    // tx_mutex_ held.
+    void set_events_(uint32_t events) noexcept
+    {
+        Reactor::Loop* loop = loop_;
+        if (loop == nullptr || fd_ < 0) {
+            return;
+        }
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.fd = fd_;
+        (void)epoll_ctl(loop->epoll_fd, EPOLL_CTL_MOD, fd_, &ev);
+    }
+
+    // Called with send_mutex_ held (PduCommRaw). Writes what the socket takes
+    // now and queues the rest; a shared frame is queued by reference.
+    HakoPduErrorType send_locked_(std::span<const std::byte> data, const PduSharedFrame& shared) noexcept
+    {
+        if (config_direction_ == HAKO_PDU_ENDPOINT_DIRECTION_IN) {
+            return HAKO_PDU_ERR_INVALID_ARGUMENT;
+        }
+        std::lock_guard<std::mutex> lock(tx_mutex_);
+        if (fd_ < 0 || !is_running_) {
+            return HAKO_PDU_ERR_NOT_RUNNING;
+        }
+        size_t sent = 0;
+        if (tx_queue_.empty()) {
+            while (sent < data.size()) {
+                ssize_t n = ::send(fd_, data.data() + sent, data.size() - sent, MSG_DONTWAIT | kStreamSendFlags);
+                if (n > 0) {
+                    sent += static_cast<size_t>(n);
+                } else if (n < 0 && errno == EINTR) {
+                    continue;
+                } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                    break;
+                } else {
+                    return (n == 0) ? HAKO_PDU_ERR_IO_ERROR : map_errno_to_error(errno);
+                }
+            }
+            if (sent == data.size()) {
+                return HAKO_PDU_ERR_OK;
+            }
+        } else if (max_send_queue_bytes_ > 0 && tx_queued_bytes_ + data.size() > max_send_queue_bytes_) {
+            // Frames stay whole: one that does not fit is refused, not truncated.
+            return HAKO_PDU_ERR_NO_SPACE;
+        }
+        // The rest of a partly sent frame must follow it, whatever the queue limit.
+        try {
+            if (shared) {
+                tx_queue_.push_back(shared);
+            } else {
+                auto copy = std::make_shared<PduEncodedFrame>();
+                copy->bytes.assign(data.begin(), data.end());
+                tx_queue_.push_back(std::move(copy));
+            }
+        } catch (const std::bad_alloc&) {
+            return HAKO_PDU_ERR_OUT_OF_MEMORY;
+        }
+        tx_queued_bytes_ += data.size() - sent;
+        if (tx_queue_.size() == 1) {
+            tx_offset_ = sent;
+            set_events_(EPOLLIN | EPOLLOUT);
+        }
+        return HAKO_PDU_ERR_OK;
+    }
+
+    // tx_mutex_ held. Writes queued frames with one sendmsg per kMaxFlushFrames.
+    HakoPduErrorType flush_locked_() noexcept
+    {
+        while (!tx_queue_.empty()) {
+            std::array<iovec, kMaxFlushFrames> iov{};
+            size_t count = 0;
+            for (auto it = tx_queue_.begin(); it != tx_queue_.end() && count < iov.size(); ++it, ++count) {
+                const size_t offset = (count == 0) ? tx_offset_ : 0;
+                iov[count].iov_base = const_cast<std::byte*>((*it)->bytes.data() + offset);
+                iov[count].iov_len = (*it)->bytes.size() - offset;
+            }
+            msghdr msg{};
+            msg.msg_iov = iov.data();
+            msg.msg_iovlen = count;
+            ssize_t n = ::sendmsg(fd_, &msg, MSG_DONTWAIT | kStreamSendFlags);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return HAKO_PDU_ERR_OK;
+            }
+            if (n <= 0) {
+                return HAKO_PDU_ERR_IO_ERROR;
+            }
+            size_t written = static_cast<size_t>(n);
+            tx_queued_bytes_ -= written;
+            while (written > 0) {
+                const size_t remaining = tx_queue_.front()->bytes.size() - tx_offset_;
+                if (written < remaining) {
+                    tx_offset_ += written;
+                    break;
+                }
+                written -= remaining;
+                tx_queue_.pop_front();
+                tx_offset_ = 0;
+            }
+        }
+        return HAKO_PDU_ERR_OK;
+    }
+
+    // One recv per wakeup (level-triggered), so a busy client cannot starve the
+    // other sessions of its loop. Returns false on EOF, error or a bad frame.
+    bool read_ready_() noexcept
+    {
+        try {
+            if (rx_buffer_.empty()) {
+                rx_buffer_.resize(kInitialRxBufferSize);
+            }
+            const size_t need = std::max(rx_frame_size_, kInitialRxBufferSize / 4);
+            if (rx_buffer_.size() - rx_end_ < need) {
+                std::memmove(rx_buffer_.data(), rx_buffer_.data() + rx_begin_, rx_end_ - rx_begin_);
+                rx_end_ -= rx_begin_;
+                rx_begin_ = 0;
+                if (rx_buffer_.size() < rx_frame_size_) {
+                    rx_buffer_.resize(rx_frame_size_);
+                }
+            }
+        } catch (const std::bad_alloc&) {
+            std::cerr << "TCP Mux reactor: out of memory, session closed." << std::endl;
+            return false;
+        }
+        ssize_t n = ::recv(fd_, rx_buffer_.data() + rx_end_, rx_buffer_.size() - rx_end_, MSG_DONTWAIT);
+        if (n == 0) {
+            return false;
+        }
+        if (n < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        rx_end_ += static_cast<size_t>(n);
+        return parse_frames_();
+    }
+
+    // Deliver every complete frame in [rx_begin_, rx_end_) in place.
+    bool parse_frames_() noexcept
+    {
+        const bool v1 = packet_version() == "v1";
+        const size_t header_size = v1 ? 4 : sizeof(MetaPdu);
+        while (rx_end_ - rx_begin_ >= header_size) {
+            const std::byte* frame = rx_buffer_.data() + rx_begin_;
+            if (v1) {
+                const uint32_t len = read_le32(frame);
+                if (len == 0 || len > kMaxV1PacketSize) {
+                    return false;
+                }
+                rx_frame_size_ = 4 + static_cast<size_t>(len);
+            } else {
+                uint32_t body_len = 0;
+                std::memcpy(&body_len, frame + offsetof(MetaPdu, body_len), sizeof(body_len));
+                rx_frame_size_ = sizeof(MetaPdu) + static_cast<size_t>(from_le32(body_len));
+            }
+            if (rx_end_ - rx_begin_ < rx_frame_size_) {
+                return true;
+            }
+            on_raw_data_received(std::span<const std::byte>(frame, rx_frame_size_));
+            rx_begin_ += rx_frame_size_;
+            rx_frame_size_ = 0;
+            if (!is_running_) {
+                return true; // the callback stopped this session
+            }
+        }
+        if (rx_begin_ == rx_end_) {
+            rx_begin_ = 0;
+            rx_end_ = 0;
+        }
+        return true;
+    }
+
+    std::shared_ptr<Reactor> reactor_;
+    std::atomic<Reactor::Loop*> loop_{nullptr}; // set while registered
+    Reactor::Loop* home_loop_ = nullptr;         // last loop registered on, kept after a failure
+    std::atomic<bool> is_running_{false};
+
+    // Loop thread only.
+    std::vector<std::byte> rx_buffer_;
+    size_t rx_begin_ = 0;
+    size_t rx_end_ = 0;
+    size_t rx_frame_size_ = 0; // size of the frame being assembled, 0 before its header
+
+    std::mutex tx_mutex_;
+    std::deque<PduSharedFrame> tx_queue_; // unsent frames, oldest first
+    size_t tx_offset_ = 0;                // bytes of the front frame already sent
+    size_t tx_queued_bytes_ = 0;
+    const size_t max_send_queue_bytes_;
+};
+
+TcpCommMultiplexer::Reactor::~Reactor()
+{
+    running = false;
+    for (auto& loop : loops) {
+        loop->wakeup.notify();
+        if (loop->thread.joinable()) {
+            loop->thread.join();
+        }
+        if (loop->epoll_fd >= 0) {
+            ::close(loop->epoll_fd);
+        }
+    }
+}
+
+HakoPduErrorType TcpCommMultiplexer::Reactor::start(int threads) noexcept
+{
+    running = true;
+    try {
+        for (int i = 0; i < threads; ++i) {
+            auto loop = std::make_unique<Loop>();
+            loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+            if (loop->epoll_fd < 0 || loop->wakeup.open() != HAKO_PDU_ERR_OK) {
+                std::cerr << "TCP Mux reactor: cannot create epoll loop: " << std::strerror(errno) << std::endl;
+                if (loop->epoll_fd >= 0) {
+                    ::close(loop->epoll_fd);
+                }
+                return HAKO_PDU_ERR_IO_ERROR;
+            }
+            epoll_event ev{};
+            ev.events = EPOLLIN;
+            ev.data.fd = loop->wakeup.fd();
+            if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->wakeup.fd(), &ev) != 0) {
+                ::close(loop->epoll_fd);
+                return HAKO_PDU_ERR_IO_ERROR;
+            }
+            Loop& ref = *loop;
+            loops.push_back(std::move(loop));
+            ref.thread = std::thread(&Reactor::run, this, std::ref(ref));
+        }
+    } catch (const std::bad_alloc&) {
+        return HAKO_PDU_ERR_OUT_OF_MEMORY;
+    } catch (const std::system_error& e) {
+        std::cerr << "TCP Mux reactor: cannot create loop thread: " << e.what() << std::endl;
+        return HAKO_PDU_ERR_IO_ERROR;
+    }
+    return HAKO_PDU_ERR_OK;
+}
+
+void TcpCommMultiplexer::Reactor::run(Loop& loop) noexcept
+{
+    std::array<epoll_event, kMaxEvents> events{};
+    while (running) {
+        const int n = epoll_wait(loop.epoll_fd, events.data(), kMaxEvents, -1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "TCP Mux reactor: epoll_wait failed: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == loop.wakeup.fd()) {
+                loop.wakeup.drain();
+                continue;
+            }
+            // Looked up per event: an earlier callback may have stopped this session.
+            ReactorSession* session = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(loop.mutex);
+                auto it = loop.sessions.find(fd);
+                if (it == loop.sessions.end()) {
+                    continue;
+                }
+                session = it->second;
+                loop.current = session;
+            }
+            session->on_events_(events[i].events);
+            {
+                std::lock_guard<std::mutex> lock(loop.mutex);
+                loop.current = nullptr;
+            }
+            loop.dispatched.notify_all();
+        }
+    }
+}
+#endif
+
 TcpCommMultiplexer::TcpCommMultiplexer() {}
 TcpCommMultiplexer::~TcpCommMultiplexer() { close(); }
 
@@ -390,7 +931,53 @@ HakoPduErrorType TcpCommMultiplexer::open(const std::string& config_path)
             options_.linger_enabled = linger_opts.value("enabled", options_.linger_enabled);
             options_.linger_timeout_sec = linger_opts.value("timeout_sec", options_.linger_timeout_sec);
         }
+        if (opts.contains("reactor")) {
+            const auto& reactor_opts = opts.at("reactor");
+            options_.reactor_enabled = reactor_opts.value("enabled", options_.reactor_enabled);
+            options_.reactor_threads = reactor_opts.value("threads", options_.reactor_threads);
+            options_.reactor_max_send_queue_bytes =
+                reactor_opts.value("max_send_queue_bytes", options_.reactor_max_send_queue_bytes);
+            if (options_.reactor_threads < 0 || options_.reactor_threads > kMaxReactorThreads) {
+                std::cerr << "TCP Mux config error: 'reactor.threads' must be 0.." << kMaxReactorThreads << "." << std::endl;
+                return HAKO_PDU_ERR_INVALID_ARGUMENT;
+            }
+        }
+        if (opts.contains("admission")) {
+            const auto& admission_opts = opts.at("admission");
+            options_.max_sessions = admission_opts.value("max_sessions", options_.max_sessions);
+            options_.accept_rate = admission_opts.value("accept_rate", options_.accept_rate);
+            options_.accept_burst = admission_opts.value("accept_burst", options_.accept_burst);
+            options_.reject_reason = admission_opts.value("reject_reason", options_.reject_reason);
+            if (options_.accept_rate < 0.0 || options_.accept_burst < 0.0) {
+                std::cerr << "TCP Mux config error: 'admission.accept_rate' and 'accept_burst' must be >= 0." << std::endl;
+                return HAKO_PDU_ERR_INVALID_ARGUMENT;
+            }
+        }
     }
+    if (options_.accept_rate > 0.0 && options_.accept_burst == 0.0) {
+        options_.accept_burst = std::max(1.0, options_.accept_rate);
+    }
+
+    // v1 frames have no request type a client could tell apart from data.
+    reject_frame_max_sessions_.clear();
+    reject_frame_rate_.clear();
+    if (options_.reject_reason && config_json.value("comm_raw_version", std::string("v2")) == "v2") {
+        MetaPdu meta;
+        DataPacket::init_meta(meta, "", 0);
+        auto encode_reason = [&meta](std::vector<std::byte>& frame, const std::string& reason) {
+            DataPacket::encode_into(frame, meta, std::as_bytes(std::span<const char>(reason.data(), reason.size())),
+                                    "v2", SESSION_REJECTED);
+        };
+        encode_reason(reject_frame_max_sessions_, "max_sessions");
+        encode_reason(reject_frame_rate_, "accept_rate");
+    }
+
+#if !defined(__linux__)
+    if (options_.reactor_enabled) {
+        std::cerr << "TCP Mux config error: 'reactor' needs epoll (Linux)." << std::endl;
+        return HAKO_PDU_ERR_UNSUPPORTED;
+    }
+#endif
 
     addrinfo* local_addr_info = nullptr;
     if (resolve_address(config_json.at("local"), kTcpSocketType, &local_addr_info) != HAKO_PDU_ERR_OK) {
@@ -423,6 +1010,23 @@ HakoPduErrorType TcpCommMultiplexer::open(const std::string& config_path)
         return HAKO_PDU_ERR_IO_ERROR;
     }
     freeaddrinfo(local_addr_info);
+    session_config_ = std::make_shared<const nlohmann::json>(std::move(config_json));
+
+#if defined(__linux__)
+    if (options_.reactor_enabled) {
+        int threads = options_.reactor_threads;
+        if (threads == 0) {
+            threads = std::clamp(static_cast<int>(std::thread::hardware_concurrency()), 1, kMaxReactorThreads);
+        }
+        auto reactor = std::make_shared<Reactor>();
+        HakoPduErrorType err = reactor->start(threads);
+        if (err != HAKO_PDU_ERR_OK) {
+            close();
+            return err;
+        }
+        reactor_ = std::move(reactor);
+    }
+#endif
     return HAKO_PDU_ERR_OK;
 }
 
@@ -434,6 +1038,9 @@ HakoPduErrorType TcpCommMultiplexer::close() noexcept
         ::close(current_listen_fd);
         listen_fd_ = -1;
     }
+    wakeup_.close();
+    session_config_.reset();
+    reactor_.reset(); // the loops run on while taken reactor sessions use them
     return HAKO_PDU_ERR_OK;
 }
 
@@ -442,31 +1049,42 @@ HakoPduErrorType TcpCommMultiplexer::start() noexcept
     if (is_running_) {
         return HAKO_PDU_ERR_BUSY;
     }
+    if (wakeup_.open() != HAKO_PDU_ERR_OK) {
+        std::cerr << "TCP Mux start failed: cannot create wakeup fd." << std::endl;
+        return HAKO_PDU_ERR_IO_ERROR;
+    }
+    wakeup_.drain();
+    try {
+        closing_.reserve(kMaxClosingSockets);
+    } catch (const std::bad_alloc&) {
+        return HAKO_PDU_ERR_OUT_OF_MEMORY;
+    }
+    accept_tokens_ = options_.accept_burst;
+    accept_refill_at_ = std::chrono::steady_clock::now();
     is_running_ = true;
+    session_signal_->start();
     accept_thread_ = std::thread(&TcpCommMultiplexer::accept_loop_, this);
     return HAKO_PDU_ERR_OK;
 }
 
 HakoPduErrorType TcpCommMultiplexer::stop() noexcept
 {
+    session_signal_->stop();
     if (!is_running_) {
         return HAKO_PDU_ERR_OK;
     }
     is_running_ = false;
-    int current_listen_fd = listen_fd_.load();
-    if (current_listen_fd >= 0) {
-        ::shutdown(current_listen_fd, SHUT_RD);
-        ::close(current_listen_fd);
-        listen_fd_ = -1;
-    }
+    wakeup_.notify();
     if (accept_thread_.joinable()) {
         accept_thread_.join();
     }
+    // The listen socket stays open until close() so the mux can be restarted.
     return HAKO_PDU_ERR_OK;
 }
 
 std::vector<std::shared_ptr<PduComm>> TcpCommMultiplexer::take_sessions()
 {
+    session_signal_->clear();
     std::lock_guard<std::mutex> lock(sessions_mutex_);
     std::vector<std::shared_ptr<PduComm>> out;
     out.swap(pending_sessions_);
@@ -483,9 +1101,123 @@ size_t TcpCommMultiplexer::expected_count() const noexcept
     return expected_clients_;
 }
 
+HakoPduErrorType TcpCommMultiplexer::get_admission_stats(CommMuxAdmissionStats& stats) const noexcept
+{
+    stats.accepted = accepted_total_.load();
+    stats.rejected_max_sessions = rejected_max_sessions_.load();
+    stats.rejected_rate = rejected_rate_.load();
+    stats.live_sessions = live_sessions_->load();
+    return HAKO_PDU_ERR_OK;
+}
+
+TcpCommMultiplexer::Rejection TcpCommMultiplexer::admit_() noexcept
+{
+    if (options_.max_sessions > 0 && live_sessions_->load() >= options_.max_sessions) {
+        return Rejection::MaxSessions;
+    }
+    if (options_.accept_rate > 0.0) {
+        const auto now = std::chrono::steady_clock::now();
+        const double elapsed = std::chrono::duration<double>(now - accept_refill_at_).count();
+        accept_refill_at_ = now;
+        accept_tokens_ = std::min(options_.accept_burst, accept_tokens_ + elapsed * options_.accept_rate);
+        if (accept_tokens_ < 1.0) {
+            return Rejection::Rate;
+        }
+        accept_tokens_ -= 1.0;
+    }
+    return Rejection::None;
+}
+
+void TcpCommMultiplexer::reject_(int fd, Rejection reason) noexcept
+{
+    // Counted first: the client may see the frame and EOF before this returns.
+    if (reason == Rejection::MaxSessions) {
+        rejected_max_sessions_.fetch_add(1);
+    } else {
+        rejected_rate_.fetch_add(1);
+    }
+    const std::vector<std::byte>& frame =
+        (reason == Rejection::MaxSessions) ? reject_frame_max_sessions_ : reject_frame_rate_;
+    if (!frame.empty()) {
+        // Best effort: a fresh socket's send buffer takes one small frame without blocking.
+        (void)::send(fd, frame.data(), frame.size(), MSG_DONTWAIT | kStreamSendFlags);
+    }
+    ::shutdown(fd, SHUT_WR);
+    linger_close_(fd);
+}
+
+void TcpCommMultiplexer::linger_close_(int fd) noexcept
+{
+    if (closing_.size() >= kMaxClosingSockets) {
+        ::close(closing_.front().fd);
+        closing_.erase(closing_.begin());
+    }
+    // Within the capacity reserved at start(): does not allocate.
+    closing_.push_back(ClosingSocket{fd, std::chrono::steady_clock::now() + std::chrono::milliseconds(kRejectLingerMs)});
+}
+
+void TcpCommMultiplexer::drain_closing_(const pollfd* fds, bool expire_all) noexcept
+{
+    const auto now = std::chrono::steady_clock::now();
+    size_t kept = 0;
+    for (size_t i = 0; i < closing_.size(); ++i) {
+        const ClosingSocket entry = closing_[i];
+        bool done = expire_all || now >= entry.deadline;
+        if (!done && fds != nullptr && fds[i].revents != 0) {
+            // Discard whatever the client sent; EOF or an error means it is gone.
+            std::byte discard[512];
+            for (;;) {
+                ssize_t n = ::recv(entry.fd, discard, sizeof(discard), MSG_DONTWAIT);
+                if (n > 0) {
+                    continue;
+                }
+                done = (n == 0) || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR);
+                break;
+            }
+        }
+        if (done) {
+            ::close(entry.fd);
+        } else {
+            closing_[kept++] = entry;
+        }
+    }
+    closing_.resize(kept);
+}
+
+int TcpCommMultiplexer::closing_timeout_ms_() const noexcept
+{
+    if (closing_.empty()) {
+        return -1;
+    }
+    auto nearest = closing_.front().deadline;
+    for (const auto& entry : closing_) {
+        nearest = std::min(nearest, entry.deadline);
+    }
+    const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(nearest - std::chrono::steady_clock::now());
+    return left.count() > 0 ? static_cast<int>(left.count()) + 1 : 0;
+}
+
 void TcpCommMultiplexer::accept_loop_()
 {
+    // listen fd, wakeup fd, then one entry per lingering rejected socket.
+    std::array<pollfd, 2 + kMaxClosingSockets> fds{};
     while (is_running_) {
+        fds[0] = pollfd{listen_fd_.load(), POLLIN, 0};
+        fds[1] = pollfd{wakeup_.fd(), POLLIN, 0};
+        for (size_t i = 0; i < closing_.size(); ++i) {
+            fds[2 + i] = pollfd{closing_[i].fd, POLLIN, 0};
+        }
+        int ret = ::poll(fds.data(), static_cast<nfds_t>(2 + closing_.size()), closing_timeout_ms_());
+        if (ret < 0) {
+            continue; // EINTR; other errors are not expected on these fds
+        }
+        if (fds[1].revents & POLLIN) {
+            break;
+        }
+        drain_closing_(fds.data() + 2, false);
+        if (fds[0].revents == 0) {
+            continue;
+        }
         sockaddr_storage client_addr{};
         socklen_t client_len = sizeof(client_addr);
         int accepted_fd = ::accept(listen_fd_.load(), reinterpret_cast<sockaddr*>(&client_addr), &client_len);
@@ -495,14 +1227,40 @@ void TcpCommMultiplexer::accept_loop_()
             }
             continue;
         }
+        const Rejection rejection = admit_();
+        if (rejection != Rejection::None) {
+            reject_(accepted_fd, rejection);
+            continue;
+        }
 
-        auto session = std::make_shared<TcpSessionComm>(accepted_fd);
+        std::shared_ptr<PduComm> session;
+        live_sessions_->fetch_add(1);
+        try {
+#if defined(__linux__)
+            if (reactor_) {
+                session = std::make_shared<ReactorSession>(accepted_fd, session_config_, live_sessions_, reactor_,
+                                                           options_.reactor_max_send_queue_bytes);
+            } else {
+                session = std::make_shared<TcpSessionComm>(accepted_fd, session_config_, live_sessions_);
+            }
+#else
+            session = std::make_shared<TcpSessionComm>(accepted_fd, session_config_, live_sessions_);
+#endif
+        } catch (const std::bad_alloc&) {
+            live_sessions_->fetch_sub(1);
+            ::close(accepted_fd);
+            std::cerr << "TCP Mux: out of memory, connection dropped." << std::endl;
+            continue;
+        }
+        accepted_total_.fetch_add(1);
         {
             std::lock_guard<std::mutex> lock(sessions_mutex_);
             pending_sessions_.push_back(std::move(session));
         }
         connected_clients_.fetch_add(1);
+        session_signal_->notify();
     }
+    drain_closing_(nullptr, true);
 }
 
 HakoPduErrorType TcpCommMultiplexer::configure_socket_options_(int fd, const Options& options) noexcept
@@ -9,6 +9,28 @@
 #include <cstring>
 #include <arpa/inet.h>
 #include <sys/socket.h>
+#include <poll.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <ctime>
+#include <random>
+#include <string_view>
+#include <unordered_map>
+#include <cstddef>
+#include <new>
+#if defined(__linux__)
+#include <netinet/udp.h>
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+#ifndef SO_RXQ_OVFL
+#define SO_RXQ_OVFL 40
+#endif
+#endif
 
 namespace hakoniwa {
 namespace pdu {
@@ -16,8 +38,203 @@ namespace comm {
 
 namespace {
 constexpr int kUdpSocketType = SOCK_DGRAM;
+constexpr size_t kMaxDatagramSize = 65536; // Max UDP packet size
+constexpr int kMaxMmsgBatch = 1024;        // UIO_MAXIOV
+constexpr size_t kUdpMaxSegments = 64;     // UDP_MAX_SEGMENTS (datagrams per GSO super-buffer)
+constexpr size_t kMaxGsoPayload = 65507;   // largest IPv4 UDP payload
+constexpr int kMaxReceiverThreads = 64;
+
+// Fragment datagram header (little endian):
+//   magic u32 | message_id u32 | robot_id u32 | channel_id u32 | total_len u32 | offset u32 | index u16 | count u16
+// robot_id is a hash of the frame's robot name (fragment_robot_id). The magic's
+// first byte (0xF7) cannot start a v2 frame (ASCII robot name) and the value is
+// far beyond any v1 header_len, so fragments and frames can share a port.
+constexpr uint32_t kFragmentMagic = 0x524648F7;
+constexpr size_t kFragmentHeaderSize = 28;
+constexpr size_t kMaxFragmentCount = 0xFFFF;
+
+void put_le32(std::byte* out, uint32_t value) noexcept
+{
+    for (int i = 0; i < 4; ++i) {
+        out[i] = static_cast<std::byte>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+void put_le16(std::byte* out, uint16_t value) noexcept
+{
+    out[0] = static_cast<std::byte>(value & 0xFF);
+    out[1] = static_cast<std::byte>((value >> 8) & 0xFF);
+}
+
+uint32_t get_le32(const std::byte* in) noexcept
+{
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value |= static_cast<uint32_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+uint16_t get_le16(const std::byte* in) noexcept
+{
+    return static_cast<uint16_t>(static_cast<uint16_t>(in[0]) | (static_cast<uint16_t>(in[1]) << 8));
+}
+
+bool is_fragment(std::span<const std::byte> data) noexcept
+{
+    return data.size() > kFragmentHeaderSize && get_le32(data.data()) == kFragmentMagic;
+}
+
+// FNV-1a of the robot name; separates the reassembly streams of robots sent
+// from one socket on the same channel.
+uint32_t fragment_robot_id(std::string_view robot) noexcept
+{
+    uint32_t hash = 2166136261u;
+    for (char c : robot) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+    }
+    return hash;
+}
+
+#if defined(__linux__)
+// Ancillary data of one read: the GRO segment size of a coalesced read (0 if
+// none), the socket's SO_RXQ_OVFL drop counter (only sent once it is non-zero)
+// and the SO_TIMESTAMPNS receive time (0 if not enabled).
+struct RecvControl {
+    size_t gro_segment = 0;
+    bool has_drops = false;
+    uint32_t drops = 0;
+    int64_t rx_time_ns = 0;
+};
+
+RecvControl parse_recv_control(const msghdr& hdr) noexcept
+{
+    RecvControl control;
+    if (hdr.msg_controllen == 0) {
+        return control;
+    }
+    for (const cmsghdr* cm = CMSG_FIRSTHDR(&hdr); cm != nullptr; cm = CMSG_NXTHDR(const_cast<msghdr*>(&hdr), const_cast<cmsghdr*>(cm))) {
+        if (cm->cmsg_level == SOL_UDP && cm->cmsg_type == UDP_GRO) {
+            int seg = 0;
+            std::memcpy(&seg, CMSG_DATA(cm), sizeof(seg));
+            control.gro_segment = seg > 0 ? static_cast<size_t>(seg) : 0;
+        } else if (cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SO_RXQ_OVFL) {
+            std::memcpy(&control.drops, CMSG_DATA(cm), sizeof(control.drops));
+            control.has_drops = true;
+        } else if (cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_TIMESTAMPNS) {
+            timespec ts{};
+            std::memcpy(&ts, CMSG_DATA(cm), sizeof(ts));
+            control.rx_time_ns = static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+        }
+    }
+    return control;
+}
+#endif
 }  // namespace
 
+// Fixed array of datagram slots for recvmmsg/sendmmsg. For receive every slot
+// owns kMaxDatagramSize bytes of one contiguous buffer; for send the iovecs
+// point at the caller's frames. With GSO a send message spans several iovecs,
+// so iov_count may exceed count. ctrl holds the UDP_SEGMENT cmsg of a send slot,
+// or the UDP_GRO, SO_RXQ_OVFL and SO_TIMESTAMPNS cmsgs of a receive slot.
+struct UdpComm::MmsgSlots {
+#if defined(__linux__)
+    MmsgSlots(size_t count, size_t iov_count, bool with_buffers)
+        : msgs(count), iovs(std::max(count, iov_count)), addrs(count), ctrl(count)
+    {
+        if (with_buffers) {
+            buffer.resize(count * kMaxDatagramSize);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            iovs[i].iov_base = with_buffers ? buffer.data() + i * kMaxDatagramSize : nullptr;
+            iovs[i].iov_len = with_buffers ? kMaxDatagramSize : 0;
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+    }
+    size_t size() const noexcept { return msgs.size(); }
+
+    union Control {
+        char buf[CMSG_SPACE(sizeof(int)) + CMSG_SPACE(sizeof(uint32_t)) + CMSG_SPACE(sizeof(timespec))];
+        cmsghdr align;
+    };
+    std::vector<mmsghdr> msgs;
+    std::vector<iovec> iovs;
+    std::vector<sockaddr_storage> addrs;
+    std::vector<Control> ctrl;
+    std::vector<std::byte> buffer;
+#endif
+};
+
+// Reassembly streams, one per (source address, robot, channel), each with one
+// message in flight. The max_streams slots and their max_message_size buffers
+// are allocated in raw_open, so reassembly itself never allocates.
+struct UdpComm::ReassemblyState {
+    struct StreamKey {
+        std::array<std::byte, 16> addr{}; // IPv4 or IPv6 source address
+        uint16_t port = 0;
+        uint16_t family = 0;
+        uint32_t robot_id = 0;
+        uint32_t channel_id = 0;
+        bool operator==(const StreamKey&) const = default;
+    };
+    struct Stream {
+        bool in_use = false;
+        StreamKey key;
+        std::chrono::steady_clock::time_point last_used{};
+        bool active = false;
+        uint32_t message_id = 0;
+        uint32_t total_len = 0;
+        uint16_t count = 0;
+        uint16_t received = 0;
+        std::unique_ptr<std::byte[]> buffer; // max_message_size bytes
+        std::vector<uint8_t> have;           // capacity kMaxFragmentCount
+        std::chrono::steady_clock::time_point started{};
+        // Last message completed or dropped; older ids are rejected within the timeout window.
+        bool has_last = false;
+        uint32_t last_message_id = 0;
+        std::chrono::steady_clock::time_point last_time{};
+    };
+    std::vector<Stream> streams;
+    std::chrono::steady_clock::time_point next_expiry{};
+
+    ReassemblyState(size_t stream_count, size_t max_message_size) : streams(stream_count)
+    {
+        for (auto& stream : streams) {
+            // Default-initialized: pages are only touched as messages arrive.
+            stream.buffer.reset(new std::byte[max_message_size]);
+            stream.have.reserve(kMaxFragmentCount);
+        }
+    }
+};
+
+// One receive socket and the state only its recv thread touches.
+struct UdpComm::Receiver {
+    int fd = -1;
+    bool owns_fd = false; // receiver 0 borrows socket_fd_
+    std::thread thread;
+    std::unique_ptr<IoUringIo> uring;
+    std::unique_ptr<MmsgSlots> slots;
+    std::unique_ptr<ReassemblyState> reassembly;
+    // Latest SO_RXQ_OVFL counter and SO_RCVBUF; written by the recv thread, read by get_socket_stats().
+    std::atomic<uint32_t> drops{0};
+    std::atomic<int> rcvbuf{0};
+    int rcvbuf_request = 0;       // last size passed to setsockopt (auto-tune)
+    bool rcvbuf_capped = false;   // the kernel stopped growing it (net.core.rmem_max)
+    // Source of the latest datagram on this socket (inout without a fixed remote);
+    // written by the recv thread, copied by senders.
+    std::mutex reply_mutex;
+    sockaddr_storage reply_addr{};
+    socklen_t reply_addr_len = 0;
+
+    ~Receiver()
+    {
+        if (owns_fd && fd >= 0) {
+            ::close(fd);
+        }
+    }
+};
+
 UdpComm::UdpComm()
 {
     // Constructor
@@ -83,17 +300,30 @@ HakoPduErrorType UdpComm::raw_open(const std::string& config_path)
             return HAKO_PDU_ERR_INVALID_ARGUMENT;
         }
     }
+    // "remotes" adds fan-out destinations; without "remote" its first entry takes that role.
+    const nlohmann::json* remote_json = config_json.contains("remote") ? &config_json.at("remote") : nullptr;
+    if (config_json.contains("remotes")) {
+        const auto& remotes = config_json.at("remotes");
+        if (!remotes.is_array() || remotes.empty() || config_direction_ == HAKO_PDU_ENDPOINT_DIRECTION_IN) {
+            std::cerr << "UDP Comm config error: 'remotes' must be a non-empty array for out/inout." << std::endl;
+            if(local_addr_info) freeaddrinfo(local_addr_info);
+            return HAKO_PDU_ERR_INVALID_ARGUMENT;
+        }
+        if (!remote_json) {
+            remote_json = &remotes.front();
+        }
+    }
     if (config_direction_ == HAKO_PDU_ENDPOINT_DIRECTION_OUT) {
-        if (!config_json.contains("remote")) {
+        if (!remote_json) {
             std::cerr << "UDP Comm config error: missing 'remote' for out." << std::endl;
             return HAKO_PDU_ERR_INVALID_ARGUMENT;
         }
-        if (resolve_address(config_json.at("remote"), kUdpSocketType, &remote_addr_info) != HAKO_PDU_ERR_OK) {
+        if (resolve_address(*remote_json, kUdpSocketType, &remote_addr_info) != HAKO_PDU_ERR_OK) {
             std::cerr << "UDP Comm config error: failed to resolve remote address." << std::endl;
             return HAKO_PDU_ERR_INVALID_ARGUMENT;
         }
-    } else if (config_direction_ == HAKO_PDU_ENDPOINT_DIRECTION_INOUT && config_json.contains("remote")) {
-        if (resolve_address(config_json.at("remote"), kUdpSocketType, &remote_addr_info) != HAKO_PDU_ERR_OK) {
+    } else if (config_direction_ == HAKO_PDU_ENDPOINT_DIRECTION_INOUT && remote_json) {
+        if (resolve_address(*remote_json, kUdpSocketType, &remote_addr_info) != HAKO_PDU_ERR_OK) {
             std::cerr << "UDP Comm config error: failed to resolve remote address." << std::endl;
             return HAKO_PDU_ERR_INVALID_ARGUMENT;
         }
@@ -122,6 +352,74 @@ HakoPduErrorType UdpComm::raw_open(const std::string& config_path)
         options.blocking = opts.value("blocking", true);
         options.reuse_address = opts.value("reuse_address", true);
         options.broadcast = opts.value("broadcast", false);
+        if (opts.contains("fragmentation")) {
+            const auto& frag = opts.at("fragmentation");
+            options.fragmentation.enabled = frag.value("enabled", false);
+            options.fragmentation.max_datagram_size = frag.value("max_datagram_size", options.fragmentation.max_datagram_size);
+            options.fragmentation.reassembly_timeout_ms = frag.value("reassembly_timeout_ms", options.fragmentation.reassembly_timeout_ms);
+            options.fragmentation.max_message_size = frag.value("max_message_size", options.fragmentation.max_message_size);
+            options.fragmentation.latest_wins = frag.value("latest_wins", options.fragmentation.latest_wins);
+            options.fragmentation.max_streams = frag.value("max_streams", options.fragmentation.max_streams);
+            if (options.fragmentation.max_datagram_size <= kFragmentHeaderSize
+                || options.fragmentation.max_datagram_size > kMaxGsoPayload
+                || options.fragmentation.reassembly_timeout_ms <= 0
+                || options.fragmentation.max_message_size == 0
+                || options.fragmentation.max_streams <= 0) {
+                std::cerr << "UDP Comm config error: invalid 'fragmentation' options." << std::endl;
+                raw_close();
+                if(local_addr_info) freeaddrinfo(local_addr_info);
+                if(remote_addr_info) freeaddrinfo(remote_addr_info);
+                return HAKO_PDU_ERR_INVALID_ARGUMENT;
+            }
+        }
+        options.sequence_numbers = opts.value("sequence_numbers", false);
+        if (options.sequence_numbers && packet_version() != "v2") {
+            std::cerr << "UDP Comm config error: 'sequence_numbers' requires comm_raw_version 'v2'." << std::endl;
+            raw_close();
+            if(local_addr_info) freeaddrinfo(local_addr_info);
+            if(remote_addr_info) freeaddrinfo(remote_addr_info);
+            return HAKO_PDU_ERR_INVALID_ARGUMENT;
+        }
+        options.latency_tracking = opts.value("latency_tracking", false);
+        options.receiver_threads = opts.value("receiver_threads", 1);
+        if (options.receiver_threads < 1 || options.receiver_threads > kMaxReceiverThreads) {
+            std::cerr << "UDP Comm config error: 'receiver_threads' must be in 1.." << kMaxReceiverThreads << "." << std::endl;
+            raw_close();
+            if(local_addr_info) freeaddrinfo(local_addr_info);
+            if(remote_addr_info) freeaddrinfo(remote_addr_info);
+            return HAKO_PDU_ERR_INVALID_ARGUMENT;
+        }
+        if (opts.contains("rcvbuf_autotune")) {
+            const auto& tune = opts.at("rcvbuf_autotune");
+            options.rcvbuf_autotune.enabled = tune.value("enabled", false);
+            options.rcvbuf_autotune.max_size = tune.value("max_size", options.rcvbuf_autotune.max_size);
+            options.rcvbuf_autotune.warmup_ms = tune.value("warmup_ms", options.rcvbuf_autotune.warmup_ms);
+            if (options.rcvbuf_autotune.max_size <= 0 || options.rcvbuf_autotune.warmup_ms < 0) {
+                std::cerr << "UDP Comm config error: invalid 'rcvbuf_autotune' options." << std::endl;
+                raw_close();
+                if(local_addr_info) freeaddrinfo(local_addr_info);
+                if(remote_addr_info) freeaddrinfo(remote_addr_info);
+                return HAKO_PDU_ERR_INVALID_ARGUMENT;
+            }
+        }
+        options.gso = opts.value("gso", false);
+        options.gro = opts.value("gro", false);
+        options.recv_batch = opts.value("recv_batch", options.recv_batch);
+        options.send_batch = opts.value("send_batch", options.send_batch);
+        if (options.recv_batch < 1 || options.recv_batch > kMaxMmsgBatch
+            || options.send_batch < 1 || options.send_batch > kMaxMmsgBatch) {
+            std::cerr << "UDP Comm config error: 'recv_batch'/'send_batch' must be in 1.." << kMaxMmsgBatch << "." << std::endl;
+            raw_close();
+            if(local_addr_info) freeaddrinfo(local_addr_info);
+            if(remote_addr_info) freeaddrinfo(remote_addr_info);
+            return HAKO_PDU_ERR_INVALID_ARGUMENT;
+        }
+        if (parse_io_backend_options(opts, options.use_io_uring, options.io_uring) != HAKO_PDU_ERR_OK) {
+            raw_close();
+            if(local_addr_info) freeaddrinfo(local_addr_info);
+            if(remote_addr_info) freeaddrinfo(remote_addr_info);
+            return HAKO_PDU_ERR_INVALID_ARGUMENT;
+        }
         if (opts.contains("multicast")) {
             const auto& mc = opts.at("multicast");
             options.multicast_enabled = mc.value("enabled", false);
@@ -129,6 +427,23 @@ HakoPduErrorType UdpComm::raw_open(const std::string& config_path)
                 options.multicast_group = mc.value("group", "");
                 options.multicast_interface = mc.value("interface", "0.0.0.0");
                 options.multicast_ttl = mc.value("ttl", 1);
+                options.multicast_port = mc.value("port", 0);
+                try {
+                    if (mc.contains("channel_groups")) {
+                        for (const auto& [channel, group] : mc.at("channel_groups").items()) {
+                            options.multicast_channel_groups[static_cast<uint32_t>(std::stoul(channel))] = group.get<std::string>();
+                        }
+                    }
+                    if (mc.contains("subscribe_channels")) {
+                        options.multicast_subscribe_channels = mc.at("subscribe_channels").get<std::vector<uint32_t>>();
+                    }
+                } catch (const std::exception&) {
+                    std::cerr << "UDP Comm config error: invalid multicast 'channel_groups'/'subscribe_channels'." << std::endl;
+                    raw_close();
+                    if(local_addr_info) freeaddrinfo(local_addr_info);
+                    if(remote_addr_info) freeaddrinfo(remote_addr_info);
+                    return HAKO_PDU_ERR_INVALID_ARGUMENT;
+                }
             }
         }
     }
@@ -137,8 +452,19 @@ HakoPduErrorType UdpComm::raw_open(const std::string& config_path)
     if (options.timeout_ms <= 0) {
         options.timeout_ms = 1000; // 1 sec default
     }
+    recv_timeout_ms_ = options.timeout_ms;
 
-    HakoPduErrorType option_result = configure_socket_options(options);
+    if (options.receiver_threads > 1
+        && (config_direction_ == HAKO_PDU_ENDPOINT_DIRECTION_OUT || options.broadcast || options.multicast_enabled)) {
+        // Multicast/broadcast datagrams are copied to every SO_REUSEPORT socket, not spread.
+        std::cerr << "UDP Comm config error: 'receiver_threads' > 1 needs a unicast in/inout socket." << std::endl;
+        raw_close();
+        if(local_addr_info) freeaddrinfo(local_addr_info);
+        if(remote_addr_info) freeaddrinfo(remote_addr_info);
+        return HAKO_PDU_ERR_INVALID_ARGUMENT;
+    }
+
+    HakoPduErrorType option_result = configure_socket_options(socket_fd_.load(), options);
     if (option_result != HAKO_PDU_ERR_OK) {
         std::cerr << "UDP Comm configure socket options failed: " << static_cast<int>(option_result) << std::endl;
         raw_close(); // Use raw_close for cleanup
@@ -157,10 +483,46 @@ HakoPduErrorType UdpComm::raw_open(const std::string& config_path)
         }
     }
 
+    if (local_addr_info && config_direction_ != HAKO_PDU_ENDPOINT_DIRECTION_OUT) {
+        HakoPduErrorType receiver_result = open_receivers_(options, local_addr_info);
+        if (receiver_result != HAKO_PDU_ERR_OK) {
+            raw_close();
+            freeaddrinfo(local_addr_info);
+            if(remote_addr_info) freeaddrinfo(remote_addr_info);
+            return receiver_result;
+        }
+    }
+
     if (remote_addr_info) {
         std::memcpy(&dest_addr_, remote_addr_info->ai_addr, remote_addr_info->ai_addrlen);
         dest_addr_len_ = remote_addr_info->ai_addrlen;
     }
+    if (config_json.contains("remotes")) {
+        std::vector<Destination> destinations;
+        if (config_json.contains("remote")) {
+            destinations.push_back(Destination{dest_addr_, dest_addr_len_});
+        }
+        for (const auto& entry : config_json.at("remotes")) {
+            addrinfo* entry_info = nullptr;
+            if (resolve_address(entry, kUdpSocketType, &entry_info) != HAKO_PDU_ERR_OK
+                || entry_info->ai_family != initial_addr->ai_family) {
+                std::cerr << "UDP Comm config error: failed to resolve an address in 'remotes' (or its family differs from the socket)." << std::endl;
+                if (entry_info) freeaddrinfo(entry_info);
+                raw_close();
+                if (local_addr_info) freeaddrinfo(local_addr_info);
+                if (remote_addr_info) freeaddrinfo(remote_addr_info);
+                return HAKO_PDU_ERR_INVALID_ARGUMENT;
+            }
+            Destination destination;
+            std::memcpy(&destination.addr, entry_info->ai_addr, entry_info->ai_addrlen);
+            destination.len = entry_info->ai_addrlen;
+            destinations.push_back(destination);
+            freeaddrinfo(entry_info);
+        }
+        if (destinations.size() > 1) {
+            destinations_ = std::move(destinations);
+        }
+    }
 
     if (local_addr_info) freeaddrinfo(local_addr_info);
     if (remote_addr_info) freeaddrinfo(remote_addr_info);
@@ -174,12 +536,108 @@ HakoPduErrorType UdpComm::raw_open(const std::string& config_path)
         }
     }
 
+    if (options.use_io_uring) {
+        auto send_uring = std::make_unique<IoUringIo>();
+        bool ready = send_uring->init(options.io_uring, false) == HAKO_PDU_ERR_OK;
+        for (auto& receiver : receivers_) {
+            if (!ready) {
+                break;
+            }
+            receiver->uring = std::make_unique<IoUringIo>();
+            ready = receiver->uring->init(options.io_uring, true) == HAKO_PDU_ERR_OK;
+        }
+        if (!ready) {
+            std::cerr << "UDP Comm: io_uring backend unavailable, falling back to socket I/O." << std::endl;
+            for (auto& receiver : receivers_) {
+                receiver->uring.reset();
+            }
+        } else {
+            send_uring_ = std::move(send_uring);
+        }
+    }
+
+    configure_segmentation_offload(options);
+    configure_drop_accounting(options);
+    configure_rx_timestamps(options);
+    fragmentation_ = options.fragmentation;
+    sequence_numbers_ = options.sequence_numbers;
+    sequence_epoch_ = static_cast<uint32_t>(std::random_device{}());
+    if (sequence_numbers_ && pdu_def_) {
+        // Counters for every defined channel now, so stamping only looks them up.
+        try {
+            pdu_def_->for_each([this](const std::string& robot_name, const PduDef& def) {
+                tx_sequences_.try_emplace(PduResolvedKey{robot_name, def.channel_id}, 0);
+            });
+        } catch (const std::bad_alloc&) {
+            raw_close();
+            return HAKO_PDU_ERR_OUT_OF_MEMORY;
+        }
+    }
+    if (fragmentation_.enabled) {
+        // Random start so a restarted sender is not taken for a stale one.
+        next_message_id_ = static_cast<uint32_t>(std::random_device{}());
+        try {
+            for (auto& receiver : receivers_) {
+                receiver->reassembly = std::make_unique<ReassemblyState>(
+                    static_cast<size_t>(fragmentation_.max_streams), fragmentation_.max_message_size);
+            }
+        } catch (const std::bad_alloc&) {
+            std::cerr << "UDP Comm: cannot allocate reassembly buffers (max_streams x max_message_size)." << std::endl;
+            raw_close();
+            return HAKO_PDU_ERR_OUT_OF_MEMORY;
+        }
+    }
+#if defined(__linux__)
+    if (options.recv_batch > 1 || gro_enabled_) {
+        for (auto& receiver : receivers_) {
+            receiver->slots = std::make_unique<MmsgSlots>(static_cast<size_t>(options.recv_batch), 0, true);
+        }
+    }
+    if ((options.send_batch > 1 || gso_enabled_) && config_direction_ != HAKO_PDU_ENDPOINT_DIRECTION_IN) {
+        send_slots_ = std::make_unique<MmsgSlots>(static_cast<size_t>(options.send_batch),
+                                                  gso_enabled_ ? static_cast<size_t>(options.send_batch) * kUdpMaxSegments : 0,
+                                                  false);
+    }
+#endif
+
+    return HAKO_PDU_ERR_OK;
+}
+
+HakoPduErrorType UdpComm::open_receivers_(const Options& options, const addrinfo* local_addr) noexcept
+{
+    try {
+        receivers_.push_back(std::make_unique<Receiver>());
+        receivers_.back()->fd = socket_fd_.load();
+        for (int i = 1; i < options.receiver_threads; ++i) {
+            auto receiver = std::make_unique<Receiver>();
+            receiver->fd = ::socket(local_addr->ai_family, local_addr->ai_socktype, local_addr->ai_protocol);
+            if (receiver->fd < 0) {
+                std::cerr << "UDP Comm socket create failed: " << std::strerror(errno) << std::endl;
+                return HAKO_PDU_ERR_IO_ERROR;
+            }
+            receiver->owns_fd = true;
+            HakoPduErrorType err = configure_socket_options(receiver->fd, options);
+            if (err != HAKO_PDU_ERR_OK) {
+                std::cerr << "UDP Comm configure socket options failed: " << static_cast<int>(err) << std::endl;
+                return err;
+            }
+            if (::bind(receiver->fd, local_addr->ai_addr, local_addr->ai_addrlen) != 0) {
+                std::cerr << "UDP Comm bind (receiver " << i << ") failed: " << std::strerror(errno) << std::endl;
+                return HAKO_PDU_ERR_IO_ERROR;
+            }
+            receivers_.push_back(std::move(receiver));
+        }
+    } catch (const std::bad_alloc&) {
+        return HAKO_PDU_ERR_OUT_OF_MEMORY;
+    }
     return HAKO_PDU_ERR_OK;
 }
 
 HakoPduErrorType UdpComm::raw_close() noexcept
 {
     raw_stop(); // Stop the thread
+    reply_receiver_ = nullptr;
+    receivers_.clear(); // closes the extra receive sockets
     int current_socket_fd = socket_fd_.load();
     if (current_socket_fd >= 0) {
         ::close(current_socket_fd);
@@ -187,7 +645,26 @@ HakoPduErrorType UdpComm::raw_close() noexcept
     }
     has_fixed_remote_ = false;
     dest_addr_len_ = 0;
-    last_client_addr_len_ = 0;
+    destinations_.clear();
+    channel_groups_.clear();
+    send_uring_.reset();
+    send_slots_.reset();
+    gso_enabled_ = false;
+    gro_enabled_ = false;
+    fragmentation_ = FragmentOptions{};
+    fragment_frames_.clear();
+    sequence_numbers_ = false;
+    tx_sequences_.clear();
+    rxq_ovfl_enabled_ = false;
+    rx_timestamps_enabled_ = false;
+    set_latency_tracking(false);
+    rcvbuf_autotune_ = RecvBufferAutotune{};
+    recv_buffer_grows_ = 0;
+    {
+        std::lock_guard<std::mutex> lock(rx_sequence_mutex_);
+        rx_sequences_.clear();
+    }
+    wakeup_.close();
     return HAKO_PDU_ERR_OK;
 }
 
@@ -202,8 +679,16 @@ HakoPduErrorType UdpComm::raw_start() noexcept
         is_running_flag_ = true;
         return HAKO_PDU_ERR_OK;
     }
+    if (wakeup_.open() != HAKO_PDU_ERR_OK) {
+        std::cerr << "UDP Comm start failed: cannot create wakeup fd." << std::endl;
+        return HAKO_PDU_ERR_IO_ERROR;
+    }
+    wakeup_.drain();
+    recv_started_ = std::chrono::steady_clock::now();
     is_running_flag_ = true;
-    recv_thread_ = std::thread(&UdpComm::recv_loop, this);
+    for (auto& receiver : receivers_) {
+        receiver->thread = std::thread(&UdpComm::recv_loop, this, std::ref(*receiver));
+    }
     return HAKO_PDU_ERR_OK;
 }
 
@@ -214,13 +699,13 @@ HakoPduErrorType UdpComm::raw_stop() noexcept
     }
     is_running_flag_ = false;
 
-    if (recv_thread_.joinable()) {
-        // Unblock recvfrom by shutting down the read part of the socket
-        int current_socket_fd = socket_fd_.load();
-        if (current_socket_fd >= 0) {
-             ::shutdown(current_socket_fd, SHUT_RD);
+    // Wake the recv threads out of poll() (the wakeup stays readable until the
+    // next start, so one notify reaches all of them); the sockets stay usable for restart.
+    wakeup_.notify();
+    for (auto& receiver : receivers_) {
+        if (receiver->thread.joinable()) {
+            receiver->thread.join();
         }
-        recv_thread_.join();
     }
     return HAKO_PDU_ERR_OK;
 }
@@ -242,126 +727,1008 @@ HakoPduErrorType UdpComm::raw_send(const std::vector<std::byte>& data) noexcept
         std::cerr << "UDP Comm send failed: direction is 'in'." << std::endl;
         return HAKO_PDU_ERR_INVALID_ARGUMENT;
     }
+    return send_routed_(current_socket_fd, std::span<const std::vector<std::byte>>(&data, 1));
+}
+
+HakoPduErrorType UdpComm::raw_send_batch(std::span<const std::vector<std::byte>> frames) noexcept
+{
+    if (!send_uring_ && (!send_slots_ || frames.size() < 2) && destinations_.empty() && channel_groups_.empty()) {
+        return PduCommRaw::raw_send_batch(frames);
+    }
+    int current_socket_fd = socket_fd_.load();
+    if (current_socket_fd < 0) {
+        std::cerr << "UDP Comm send failed: invalid socket." << std::endl;
+        return HAKO_PDU_ERR_INVALID_ARGUMENT;
+    }
+    if (config_direction_ == HAKO_PDU_ENDPOINT_DIRECTION_IN) {
+        std::cerr << "UDP Comm send failed: direction is 'in'." << std::endl;
+        return HAKO_PDU_ERR_INVALID_ARGUMENT;
+    }
+    return send_routed_(current_socket_fd, frames);
+}
+
+HakoPduErrorType UdpComm::send_routed_(int fd, std::span<const std::vector<std::byte>> frames) noexcept
+{
+    // Default targets: the fan-out list, else "remote" / the last inout client.
+    Destination single;
+    std::span<const Destination> defaults = destinations_;
+    HakoPduErrorType target_result = HAKO_PDU_ERR_OK;
+    if (destinations_.empty()) {
+        target_result = resolve_send_target_(single);
+        if (target_result == HAKO_PDU_ERR_OK) {
+            defaults = std::span<const Destination>(&single, 1);
+        } else if (channel_groups_.empty()) {
+            return target_result;
+        }
+    }
+    if (channel_groups_.empty() && !fragmentation_.enabled) {
+        return send_frames_(fd, frames, defaults);
+    }
+    // Consecutive frames with the same targets go out together; oversized frames
+    // are fragmented on their own.
+    size_t run_begin = 0;
+    std::span<const Destination> run_targets;
+    for (size_t i = 0; i < frames.size(); ++i) {
+        std::span<const Destination> targets = defaults;
+        uint32_t channel_id = 0;
+        if (!channel_groups_.empty() && frame_channel_id_(frames[i], channel_id)) {
+            auto it = channel_groups_.find(channel_id);
+            if (it != channel_groups_.end()) {
+                targets = std::span<const Destination>(&it->second, 1);
+            }
+        }
+        if (targets.empty()) {
+            return target_result;
+        }
+        const bool oversized = fragmentation_.enabled && frames[i].size() > fragmentation_.max_datagram_size;
+        if (i > run_begin && (oversized || targets.data() != run_targets.data())) {
+            HakoPduErrorType err = send_frames_(fd, frames.subspan(run_begin, i - run_begin), run_targets);
+            if (err != HAKO_PDU_ERR_OK) {
+                return err;
+            }
+            run_begin = i;
+        }
+        if (oversized) {
+            HakoPduErrorType err = send_fragmented_(fd, frames[i], targets);
+            if (err != HAKO_PDU_ERR_OK) {
+                return err;
+            }
+            run_begin = i + 1;
+            continue;
+        }
+        run_targets = targets;
+    }
+    return send_frames_(fd, frames.subspan(run_begin), run_targets);
+}
+
+bool UdpComm::frame_channel_id_(const std::vector<std::byte>& frame, uint32_t& channel_id,
+                                 uint32_t* robot_id) const noexcept
+{
+    if (packet_version() == "v2") {
+        if (frame.size() < sizeof(MetaPdu)) {
+            return false;
+        }
+        channel_id = get_le32(frame.data() + offsetof(MetaPdu, channel_id));
+        if (robot_id) {
+            const char* name = reinterpret_cast<const char*>(frame.data() + offsetof(MetaPdu, robot_name));
+            *robot_id = fragment_robot_id(std::string_view(name, strnlen(name, sizeof(MetaPdu::robot_name))));
+        }
+        return true;
+    }
+    DataPacketView view;
+    if (!DataPacket::decode_view(frame, packet_version(), view)) {
+        return false;
+    }
+    channel_id = view.meta.channel_id;
+    if (robot_id) {
+        *robot_id = fragment_robot_id(view.robot_name);
+    }
+    return true;
+}
+
+HakoPduErrorType UdpComm::send_frames_(int fd, std::span<const std::vector<std::byte>> frames,
+                                       std::span<const Destination> targets) noexcept
+{
+    if (frames.empty() || targets.empty()) {
+        return HAKO_PDU_ERR_OK;
+    }
+    const bool mmsg_fanout = targets.size() > 1 && send_slots_ && !send_uring_ && !gso_enabled_;
+    if (targets.size() > 1 && !mmsg_fanout) {
+        // io_uring/GSO batch per destination; the frames are still encoded only once.
+        for (const auto& target : targets) {
+            HakoPduErrorType err = send_frames_(fd, frames, std::span<const Destination>(&target, 1));
+            if (err != HAKO_PDU_ERR_OK) {
+                return err;
+            }
+        }
+        return HAKO_PDU_ERR_OK;
+    }
+    const sockaddr* target_addr = reinterpret_cast<const sockaddr*>(&targets.front().addr);
+    const socklen_t target_addr_len = targets.front().len;
+    if (send_uring_ && frames.size() > 1) {
+        // One io_uring_enter for the whole batch.
+        return send_uring_->send_batch(fd, frames, target_addr, target_addr_len, true);
+    }
+#if defined(__linux__)
+    if (send_slots_ && (frames.size() > 1 || mmsg_fanout)) {
+        if (gso_enabled_) {
+            HakoPduErrorType err = send_batch_gso_(fd, frames, target_addr, target_addr_len);
+            if (err != HAKO_PDU_ERR_UNSUPPORTED) {
+                return err;
+            }
+            // The route/device rejected GSO before anything was sent: resend without it.
+        }
+        // sendmmsg over frames x targets in chunks of send_batch: every target's
+        // message points at the same frame bytes. A short count means the kernel
+        // stopped at a datagram it could not queue, so resume from there.
+        MmsgSlots& slots = *send_slots_;
+        const size_t total = frames.size() * targets.size();
+        size_t next = 0;
+        while (next < total) {
+            const size_t count = std::min(slots.size(), total - next);
+            for (size_t i = 0; i < count; ++i) {
+                const auto& frame = frames[(next + i) / targets.size()];
+                const Destination& target = targets[(next + i) % targets.size()];
+                slots.iovs[i].iov_base = const_cast<std::byte*>(frame.data());
+                slots.iovs[i].iov_len = frame.size();
+                msghdr& hdr = slots.msgs[i].msg_hdr;
+                hdr.msg_iov = &slots.iovs[i];
+                hdr.msg_iovlen = 1;
+                hdr.msg_control = nullptr;
+                hdr.msg_controllen = 0;
+                hdr.msg_name = const_cast<sockaddr_storage*>(&target.addr);
+                hdr.msg_namelen = target.len;
+            }
+            int sent = ::sendmmsg(fd, slots.msgs.data(), static_cast<unsigned int>(count), 0);
+            if (sent < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                std::cerr << "UDP Comm sendmmsg failed: " << std::strerror(errno) << std::endl;
+                return map_errno_to_error(errno);
+            }
+            next += static_cast<size_t>(sent);
+        }
+        return HAKO_PDU_ERR_OK;
+    }
+#endif
+    for (const auto& frame : frames) {
+        ssize_t sent = ::sendto(fd, frame.data(), frame.size(), 0, target_addr, target_addr_len);
+        if (sent < 0) {
+            std::cerr << "UDP Comm sendto failed: " << std::strerror(errno) << std::endl;
+            return map_errno_to_error(errno);
+        }
+    }
+    return HAKO_PDU_ERR_OK;
+}
+
+HakoPduErrorType UdpComm::send_fragmented_(int fd, const std::vector<std::byte>& frame,
+                                           std::span<const Destination> targets) noexcept
+{
+    const size_t chunk = fragmentation_.max_datagram_size - kFragmentHeaderSize;
+    const size_t count = (frame.size() + chunk - 1) / chunk;
+    if (frame.size() > fragmentation_.max_message_size || count > kMaxFragmentCount) {
+        std::cerr << "UDP Comm send failed: frame of " << frame.size() << " bytes exceeds fragmentation limits." << std::endl;
+        return HAKO_PDU_ERR_INVALID_ARGUMENT;
+    }
+    uint32_t channel_id = 0;
+    uint32_t robot_id = 0;
+    frame_channel_id_(frame, channel_id, &robot_id);
+    const uint32_t message_id = next_message_id_++;
+
+    // fragment_frames_ keeps its capacity, so steady-state sends do not allocate.
+    if (fragment_frames_.size() < count) {
+        fragment_frames_.resize(count);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const size_t offset = i * chunk;
+        const size_t len = std::min(chunk, frame.size() - offset);
+        auto& out = fragment_frames_[i];
+        out.resize(kFragmentHeaderSize + len);
+        put_le32(out.data(), kFragmentMagic);
+        put_le32(out.data() + 4, message_id);
+        put_le32(out.data() + 8, robot_id);
+        put_le32(out.data() + 12, channel_id);
+        put_le32(out.data() + 16, static_cast<uint32_t>(frame.size()));
+        put_le32(out.data() + 20, static_cast<uint32_t>(offset));
+        put_le16(out.data() + 24, static_cast<uint16_t>(i));
+        put_le16(out.data() + 26, static_cast<uint16_t>(count));
+        std::memcpy(out.data() + kFragmentHeaderSize, frame.data() + offset, len);
+    }
+    return send_frames_(fd, std::span<const std::vector<std::byte>>(fragment_frames_.data(), count), targets);
+}
+
+HakoPduErrorType UdpComm::send_batch_gso_(int fd, std::span<const std::vector<std::byte>> frames,
+                                          const sockaddr* target_addr, socklen_t target_addr_len) noexcept
+{
+#if defined(__linux__)
+    // Runs of equal-sized frames become one UDP_SEGMENT super-buffer each: the
+    // kernel splits it back into gso_size datagrams (the last one may be
+    // shorter). The iovecs point at the frames, so nothing is copied.
+    MmsgSlots& slots = *send_slots_;
+    size_t next = 0;
+    while (next < frames.size()) {
+        size_t msg_count = 0;
+        size_t iov_used = 0;
+        size_t pos = next;
+        while (pos < frames.size() && msg_count < slots.size()) {
+            const size_t seg_size = frames[pos].size();
+            size_t segs = 0;
+            size_t bytes = 0;
+            while (pos + segs < frames.size() && segs < kUdpMaxSegments && iov_used + segs < slots.iovs.size()) {
+                const size_t len = frames[pos + segs].size();
+                if (len > seg_size || bytes + len > kMaxGsoPayload || (segs > 0 && frames[pos + segs - 1].size() != seg_size)) {
+                    break;
+                }
+                slots.iovs[iov_used + segs].iov_base = const_cast<std::byte*>(frames[pos + segs].data());
+                slots.iovs[iov_used + segs].iov_len = len;
+                bytes += len;
+                ++segs;
+            }
+            if (segs == 0) {
+                break;
+            }
+            msghdr& hdr = slots.msgs[msg_count].msg_hdr;
+            hdr.msg_name = const_cast<sockaddr*>(target_addr);
+            hdr.msg_namelen = target_addr_len;
+            hdr.msg_iov = &slots.iovs[iov_used];
+            hdr.msg_iovlen = segs;
+            if (segs > 1) {
+                hdr.msg_control = slots.ctrl[msg_count].buf;
+                hdr.msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+                cmsghdr* cm = CMSG_FIRSTHDR(&hdr);
+                cm->cmsg_level = SOL_UDP;
+                cm->cmsg_type = UDP_SEGMENT;
+                cm->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+                const uint16_t gso_size = static_cast<uint16_t>(seg_size);
+                std::memcpy(CMSG_DATA(cm), &gso_size, sizeof(gso_size));
+            } else {
+                hdr.msg_control = nullptr;
+                hdr.msg_controllen = 0;
+            }
+            iov_used += segs;
+            pos += segs;
+            ++msg_count;
+        }
 
-    const sockaddr* target_addr = nullptr;
-    socklen_t target_addr_len = 0;
+        int sent = ::sendmmsg(fd, slots.msgs.data(), static_cast<unsigned int>(msg_count), 0);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno == EIO || errno == EINVAL) && next == 0) {
+                std::cerr << "UDP Comm: UDP_SEGMENT rejected (" << std::strerror(errno) << "), disabling GSO." << std::endl;
+                gso_enabled_ = false;
+                return HAKO_PDU_ERR_UNSUPPORTED;
+            }
+            std::cerr << "UDP Comm sendmmsg (GSO) failed: " << std::strerror(errno) << std::endl;
+            return map_errno_to_error(errno);
+        }
+        for (int i = 0; i < sent; ++i) {
+            next += slots.msgs[i].msg_hdr.msg_iovlen;
+        }
+    }
+    return HAKO_PDU_ERR_OK;
+#else
+    (void)fd;
+    (void)frames;
+    (void)target_addr;
+    (void)target_addr_len;
+    return HAKO_PDU_ERR_UNSUPPORTED;
+#endif
+}
 
-    if (has_fixed_remote_) {
-        target_addr = reinterpret_cast<const sockaddr*>(&dest_addr_);
-        target_addr_len = dest_addr_len_;
-    } else if (config_direction_ == HAKO_PDU_ENDPOINT_DIRECTION_INOUT) {
-        if (last_client_addr_len_ == 0) {
+HakoPduErrorType UdpComm::resolve_send_target_(Destination& target) noexcept
+{
+    target.len = 0;
+    if (has_fixed_remote_ || config_direction_ != HAKO_PDU_ENDPOINT_DIRECTION_INOUT) {
+        std::memcpy(&target.addr, &dest_addr_, sizeof(dest_addr_));
+        target.len = dest_addr_len_;
+    } else {
+        // Reply to the latest client, as seen by whichever receive socket heard it last.
+        Receiver* receiver = reply_receiver_.load(std::memory_order_acquire);
+        if (receiver == nullptr) {
             std::cerr << "UDP Comm send failed: no remote address received yet." << std::endl;
             return HAKO_PDU_ERR_IO_ERROR; // Not received yet
         }
-        target_addr = reinterpret_cast<const sockaddr*>(&last_client_addr_);
-        target_addr_len = last_client_addr_len_;
-    } else { // OUT
-        target_addr = reinterpret_cast<const sockaddr*>(&dest_addr_);
-        target_addr_len = dest_addr_len_;
+        std::lock_guard<std::mutex> lock(receiver->reply_mutex);
+        std::memcpy(&target.addr, &receiver->reply_addr, receiver->reply_addr_len);
+        target.len = receiver->reply_addr_len;
     }
 
-    if (target_addr == nullptr || target_addr_len == 0) {
+    if (target.len == 0) {
         std::cerr << "UDP Comm send failed: target address not set." << std::endl;
         return HAKO_PDU_ERR_INVALID_ARGUMENT;
     }
+    return HAKO_PDU_ERR_OK;
+}
+
+// UdpComm's recv method is removed as it's now handled by PduCommRaw.
+
+void UdpComm::on_datagram_(Receiver& receiver, std::span<const std::byte> data, const sockaddr* from, socklen_t from_len,
+                           int64_t rx_time_ns)
+{
+    if (from && from_len > 0 && config_direction_ == HAKO_PDU_ENDPOINT_DIRECTION_INOUT && !has_fixed_remote_) {
+        {
+            std::lock_guard<std::mutex> lock(receiver.reply_mutex);
+            std::memcpy(&receiver.reply_addr, from, from_len);
+            receiver.reply_addr_len = from_len;
+        }
+        if (reply_receiver_.load(std::memory_order_relaxed) != &receiver) {
+            reply_receiver_.store(&receiver, std::memory_order_release);
+        }
+    }
+    if (receiver.reassembly) {
+        if (is_fragment(data)) {
+            on_fragment_(*receiver.reassembly, data, from, from_len, rx_time_ns);
+            return;
+        }
+        expire_reassembly_(*receiver.reassembly);
+    }
+    // Call the base class's method to handle raw data
+    on_raw_data_received(data, rx_time_ns);
+}
+
+HakoPduErrorType UdpComm::raw_send_frame(const PduSharedFrame& frame) noexcept
+{
+    if (!sequence_numbers_) {
+        return raw_send(frame->bytes);
+    }
+    // The shared frame stays untouched; this comm's sequence goes into a copy.
+    thread_local std::vector<std::byte> stamped;
+    try {
+        stamped = frame->bytes;
+    } catch (const std::bad_alloc&) {
+        return HAKO_PDU_ERR_OUT_OF_MEMORY;
+    }
+    raw_stamp_frame(stamped);
+    return raw_send(stamped);
+}
+
+void UdpComm::raw_stamp_frame(std::vector<std::byte>& frame) noexcept
+{
+    if (!sequence_numbers_ || frame.size() < sizeof(MetaPdu)) {
+        return;
+    }
+    const char* name = reinterpret_cast<const char*>(frame.data() + offsetof(MetaPdu, robot_name));
+    try {
+        tx_sequence_key_.robot.assign(name, strnlen(name, sizeof(MetaPdu::robot_name)));
+        tx_sequence_key_.channel_id = static_cast<HakoPduChannelIdType>(get_le32(frame.data() + offsetof(MetaPdu, channel_id)));
+        auto it = tx_sequences_.find(tx_sequence_key_);
+        if (it == tx_sequences_.end()) {
+            // Channel outside the PDU definition (or none given): first frame adds it.
+            it = tx_sequences_.try_emplace(tx_sequence_key_, 0).first;
+        }
+        DataPacket::stamp_sequence(frame, ++it->second, sequence_epoch_);
+    } catch (const std::bad_alloc&) {
+        // Out of memory: the frame goes out unstamped and is delivered as such.
+    }
+}
 
-    ssize_t sent = ::sendto(current_socket_fd, data.data(), data.size(), 0, target_addr, target_addr_len);
-    if (sent < 0) {
-        std::cerr << "UDP Comm sendto failed: " << std::strerror(errno) << std::endl;
-        return map_errno_to_error(errno);
+bool UdpComm::raw_accept_packet(const DataPacketView& packet) noexcept
+{
+    uint64_t sequence = 0;
+    uint32_t epoch = 0;
+    if (!sequence_numbers_ || !DataPacket::get_sequence(packet.meta, sequence, epoch)) {
+        return true; // unsequenced frames are delivered as before
+    }
+    std::lock_guard<std::mutex> lock(rx_sequence_mutex_);
+    rx_sequence_key_.robot.assign(packet.robot_name.data(), packet.robot_name.size());
+    rx_sequence_key_.channel_id = static_cast<HakoPduChannelIdType>(packet.meta.channel_id);
+    auto [it, inserted] = rx_sequences_.try_emplace(rx_sequence_key_);
+    RxSequence& rx = it->second;
+    PduChannelStats& stats = rx.stats;
+    if (inserted || rx.epoch != epoch) {
+        // First sample from this sender (or it restarted): take it as the baseline.
+        stats.key = rx_sequence_key_;
+        rx.epoch = epoch;
+        stats.last_sequence = sequence;
+        ++stats.received;
+        return true;
+    }
+    if (sequence > stats.last_sequence) {
+        stats.lost += sequence - stats.last_sequence - 1;
+        stats.last_sequence = sequence;
+        ++stats.received;
+        return true;
+    }
+    if (sequence == stats.last_sequence) {
+        ++stats.duplicates;
+        return false;
+    }
+    // Late sample: it was counted as lost when the gap opened, but a newer value
+    // is already in the cache, so it must not overwrite it.
+    ++stats.reordered;
+    if (stats.lost > 0) {
+        --stats.lost;
+    }
+    return false;
+}
+
+HakoPduErrorType UdpComm::get_channel_stats(std::vector<PduChannelStats>& stats) const noexcept
+{
+    stats.clear();
+    if (!sequence_numbers_) {
+        return HAKO_PDU_ERR_UNSUPPORTED;
+    }
+    try {
+        std::lock_guard<std::mutex> lock(rx_sequence_mutex_);
+        stats.reserve(rx_sequences_.size());
+        for (const auto& entry : rx_sequences_) {
+            stats.push_back(entry.second.stats);
+        }
+    } catch (const std::bad_alloc&) {
+        return HAKO_PDU_ERR_OUT_OF_MEMORY;
     }
     return HAKO_PDU_ERR_OK;
 }
 
-// UdpComm's recv method is removed as it's now handled by PduCommRaw.
+HakoPduErrorType UdpComm::get_socket_stats(PduCommSocketStats& stats) const noexcept
+{
+    stats = PduCommSocketStats{};
+    const int fd = socket_fd_.load();
+    if (fd < 0) {
+        return HAKO_PDU_ERR_NOT_RUNNING;
+    }
+    if (receivers_.empty()) {
+        // out: no receivers, but report the socket's buffer anyway.
+        socklen_t len = sizeof(stats.recv_buffer_size);
+        (void)getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &stats.recv_buffer_size, &len);
+    }
+    for (const auto& receiver : receivers_) {
+        stats.rx_dropped += receiver->drops.load(std::memory_order_relaxed);
+        const int rcvbuf = receiver->rcvbuf.load(std::memory_order_relaxed);
+        if (stats.recv_buffer_size == 0 || rcvbuf < stats.recv_buffer_size) {
+            stats.recv_buffer_size = rcvbuf;
+        }
+    }
+    stats.recv_buffer_grows = recv_buffer_grows_.load();
+    return HAKO_PDU_ERR_OK;
+}
 
-void UdpComm::recv_loop()
+void UdpComm::on_rxq_drops_(Receiver& receiver, uint32_t drops) noexcept
 {
-    std::vector<std::byte> buffer(65536); // Max UDP packet size
+    const uint32_t previous = receiver.drops.exchange(drops, std::memory_order_relaxed);
+    if (drops == previous || !rcvbuf_autotune_.enabled || receiver.rcvbuf_capped) {
+        return;
+    }
+    if (rcvbuf_autotune_.warmup_ms > 0
+        && std::chrono::steady_clock::now() - recv_started_ > std::chrono::milliseconds(rcvbuf_autotune_.warmup_ms)) {
+        return;
+    }
+    const int request = static_cast<int>(std::min<int64_t>(static_cast<int64_t>(receiver.rcvbuf_request) * 2,
+                                                           rcvbuf_autotune_.max_size));
+    if (request <= receiver.rcvbuf_request) {
+        return;
+    }
+    int actual = 0;
+    socklen_t len = sizeof(actual);
+    if (setsockopt(receiver.fd, SOL_SOCKET, SO_RCVBUF, &request, sizeof(request)) != 0
+        || getsockopt(receiver.fd, SOL_SOCKET, SO_RCVBUF, &actual, &len) != 0
+        || actual <= receiver.rcvbuf.load(std::memory_order_relaxed)) {
+        std::cerr << "UDP Comm: SO_RCVBUF cannot grow past " << receiver.rcvbuf.load()
+                  << " bytes (net.core.rmem_max), auto-tune stopped." << std::endl;
+        receiver.rcvbuf_capped = true;
+        return;
+    }
+    receiver.rcvbuf_request = request;
+    receiver.rcvbuf.store(actual, std::memory_order_relaxed);
+    recv_buffer_grows_.fetch_add(1);
+    std::cerr << "UDP Comm: receive queue overflow (" << drops << " drops), SO_RCVBUF grown to "
+              << actual << " bytes." << std::endl;
+}
+
+void UdpComm::on_fragment_(ReassemblyState& reassembly, std::span<const std::byte> data, const sockaddr* from,
+                           socklen_t from_len, int64_t rx_time_ns)
+{
+    const std::byte* hdr = data.data();
+    ReassemblyState::StreamKey key;
+    const uint32_t message_id = get_le32(hdr + 4);
+    key.robot_id = get_le32(hdr + 8);
+    key.channel_id = get_le32(hdr + 12);
+    const uint32_t total_len = get_le32(hdr + 16);
+    const uint32_t offset = get_le32(hdr + 20);
+    const uint16_t index = get_le16(hdr + 24);
+    const uint16_t count = get_le16(hdr + 26);
+    const std::span<const std::byte> payload = data.subspan(kFragmentHeaderSize);
+    if (count == 0 || index >= count || total_len == 0 || total_len > fragmentation_.max_message_size
+        || offset > total_len || payload.size() > total_len - offset) {
+        return; // malformed
+    }
+    if (from && from_len >= static_cast<socklen_t>(sizeof(sockaddr_in)) && from->sa_family == AF_INET) {
+        const auto* in = reinterpret_cast<const sockaddr_in*>(from);
+        key.family = AF_INET;
+        key.port = in->sin_port;
+        std::memcpy(key.addr.data(), &in->sin_addr, sizeof(in->sin_addr));
+    } else if (from && from_len >= static_cast<socklen_t>(sizeof(sockaddr_in6)) && from->sa_family == AF_INET6) {
+        const auto* in6 = reinterpret_cast<const sockaddr_in6*>(from);
+        key.family = AF_INET6;
+        key.port = in6->sin6_port;
+        std::memcpy(key.addr.data(), &in6->sin6_addr, sizeof(in6->sin6_addr));
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    const auto timeout = std::chrono::milliseconds(fragmentation_.reassembly_timeout_ms);
+    ReassemblyState::Stream* stream = nullptr;
+    for (auto& candidate : reassembly.streams) {
+        if (candidate.in_use && candidate.key == key) {
+            stream = &candidate;
+            break;
+        }
+    }
+    if (stream == nullptr) {
+        // New stream: a free slot, else the least recently used one that is idle
+        // or holds an expired message. Live partial messages are never evicted.
+        for (auto& candidate : reassembly.streams) {
+            if (!candidate.in_use) {
+                stream = &candidate;
+                break;
+            }
+            if ((!candidate.active || now - candidate.started > timeout)
+                && (stream == nullptr || candidate.last_used < stream->last_used)) {
+                stream = &candidate;
+            }
+        }
+        if (stream == nullptr) {
+            return; // every slot is reassembling a live message
+        }
+        stream->in_use = true;
+        stream->key = key;
+        stream->active = false;
+        stream->has_last = false;
+    }
+    auto& ch = *stream;
+    ch.last_used = now;
+    auto finish = [&ch, now]() {
+        ch.active = false;
+        ch.has_last = true;
+        ch.last_message_id = ch.message_id;
+        ch.last_time = now;
+    };
+
+    if (ch.active) {
+        const int32_t diff = static_cast<int32_t>(message_id - ch.message_id);
+        const bool expired = now - ch.started > timeout;
+        if (diff < 0) {
+            return; // fragment of an older message
+        }
+        if (diff == 0 && expired) {
+            finish(); // timed out: discard what we have
+            return;
+        }
+        if (diff > 0) {
+            if (!fragmentation_.latest_wins && !expired) {
+                return; // finish the older message first
+            }
+            finish(); // newer message supersedes the incomplete one
+        }
+    }
+    if (!ch.active) {
+        if (ch.has_last && now - ch.last_time <= timeout
+            && static_cast<int32_t>(message_id - ch.last_message_id) <= 0) {
+            return; // late fragment of a message already completed or dropped
+        }
+        ch.active = true;
+        ch.message_id = message_id;
+        ch.total_len = total_len;
+        ch.count = count;
+        ch.received = 0;
+        ch.have.assign(count, 0); // within the reserved capacity
+        ch.started = now;
+    }
+    if (ch.total_len != total_len || ch.count != count || ch.have[index]) {
+        return; // inconsistent header or duplicate
+    }
+    std::memcpy(ch.buffer.get() + offset, payload.data(), payload.size());
+    ch.have[index] = 1;
+    if (++ch.received == ch.count) {
+        finish();
+        on_raw_data_received(std::span<const std::byte>(ch.buffer.get(), ch.total_len), rx_time_ns);
+    }
+}
+
+void UdpComm::expire_reassembly_(ReassemblyState& reassembly) noexcept
+{
+    const auto now = std::chrono::steady_clock::now();
+    if (now < reassembly.next_expiry) {
+        return;
+    }
+    const auto timeout = std::chrono::milliseconds(fragmentation_.reassembly_timeout_ms);
+    reassembly.next_expiry = now + timeout / 2;
+    for (auto& stream : reassembly.streams) {
+        if (stream.active && now - stream.started > timeout) {
+            // Discard the stale partial message; its late fragments are still rejected.
+            stream.active = false;
+            stream.has_last = true;
+            stream.last_message_id = stream.message_id;
+            stream.last_time = now;
+        } else if (stream.in_use && !stream.active && (!stream.has_last || now - stream.last_time > timeout)) {
+            stream.in_use = false; // quiet stream: free the slot
+        }
+    }
+}
+
+int UdpComm::recv_poll_ms_(const Receiver& receiver) const noexcept
+{
+    // Wake up often enough to expire partial messages while the socket is idle.
+    return receiver.reassembly ? std::min(recv_timeout_ms_, fragmentation_.reassembly_timeout_ms) : recv_timeout_ms_;
+}
+
+bool UdpComm::recv_loop_uring_(Receiver& receiver)
+{
+    auto on_datagram = [this, &receiver](std::span<const std::byte> data, const sockaddr* from, socklen_t from_len) {
+        on_datagram_(receiver, data, from, from_len);
+    };
+    auto on_idle = [this, &receiver]() {
+        if (receiver.reassembly) {
+            expire_reassembly_(*receiver.reassembly);
+        }
+    };
+    HakoPduErrorType err = receiver.uring->run_recv(receiver.fd, true, is_running_flag_, recv_poll_ms_(receiver),
+                                                 on_datagram, wakeup_.fd(), on_idle);
+    if (err == HAKO_PDU_ERR_UNSUPPORTED) {
+        std::cerr << "UDP Comm: io_uring multishot receive unsupported, falling back to recvfrom." << std::endl;
+        return false;
+    }
+    if (err != HAKO_PDU_ERR_OK && is_running_flag_) {
+        // A datagram socket outlives a failed ring: keep receiving without it.
+        std::cerr << "UDP Comm io_uring receive failed: " << static_cast<int>(err)
+                  << ", falling back to recvfrom." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool UdpComm::recv_loop_mmsg_(Receiver& receiver)
+{
+#if defined(__linux__)
+    MmsgSlots& slots = *receiver.slots;
+    const int fd = receiver.fd;
+    while (is_running_flag_) {
+        for (size_t i = 0; i < slots.size(); ++i) {
+            msghdr& hdr = slots.msgs[i].msg_hdr;
+            hdr.msg_name = &slots.addrs[i];
+            hdr.msg_namelen = sizeof(sockaddr_storage);
+            const bool with_control = gro_enabled_ || rxq_ovfl_enabled_ || rx_timestamps_enabled_;
+            hdr.msg_control = with_control ? slots.ctrl[i].buf : nullptr;
+            hdr.msg_controllen = with_control ? sizeof(slots.ctrl[i].buf) : 0;
+            hdr.msg_flags = 0;
+        }
+        // Drain up to recv_batch datagrams per syscall; poll only when the socket is empty.
+        int received = ::recvmmsg(fd, slots.msgs.data(), static_cast<unsigned int>(slots.size()), MSG_DONTWAIT, nullptr);
+        if (received < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                if (poll_with_wakeup(fd, POLLIN, wakeup_, recv_poll_ms_(receiver)) == HAKO_PDU_ERR_NOT_RUNNING) {
+                    break;
+                }
+                if (receiver.reassembly) {
+                    expire_reassembly_(*receiver.reassembly);
+                }
+                continue;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == ENOSYS) {
+                return false;
+            }
+            if (!is_running_flag_) {
+                break;
+            }
+            std::cerr << "UDP Comm recvmmsg failed: " << std::strerror(errno) << std::endl;
+            continue;
+        }
+        for (int i = 0; i < received; ++i) {
+            const mmsghdr& msg = slots.msgs[i];
+            const sockaddr* from = reinterpret_cast<const sockaddr*>(msg.msg_hdr.msg_name);
+            std::span<const std::byte> payload(slots.buffer.data() + i * kMaxDatagramSize, msg.msg_len);
+            const RecvControl control = parse_recv_control(msg.msg_hdr);
+            if (control.has_drops) {
+                on_rxq_drops_(receiver, control.drops);
+            }
+            const size_t seg_size = control.gro_segment;
+            if (seg_size == 0 || seg_size >= payload.size()) {
+                on_datagram_(receiver, payload, from, msg.msg_hdr.msg_namelen, control.rx_time_ns);
+                continue;
+            }
+            // GRO coalesced several datagrams of seg_size bytes (the last may be shorter).
+            for (size_t off = 0; off < payload.size(); off += seg_size) {
+                on_datagram_(receiver, payload.subspan(off, std::min(seg_size, payload.size() - off)), from,
+                             msg.msg_hdr.msg_namelen, control.rx_time_ns);
+            }
+        }
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void UdpComm::recv_loop(Receiver& receiver)
+{
+    if (receiver.uring && recv_loop_uring_(receiver)) {
+        return;
+    }
+    if (receiver.slots && recv_loop_mmsg_(receiver)) {
+        return;
+    }
+    const int fd = receiver.fd;
+    std::vector<std::byte> buffer(kMaxDatagramSize);
+#if defined(__linux__)
+    union {
+        char buf[CMSG_SPACE(sizeof(uint32_t)) + CMSG_SPACE(sizeof(timespec))];
+        cmsghdr align;
+    } control;
+#endif
     while (is_running_flag_) {
         sockaddr_storage from{};
-        socklen_t from_len = sizeof(from);
-        ssize_t received = ::recvfrom(socket_fd_.load(), buffer.data(), buffer.size(), 0,
-                                      reinterpret_cast<sockaddr*>(&from), &from_len);
+        iovec iov{buffer.data(), buffer.size()};
+        msghdr hdr{};
+        hdr.msg_name = &from;
+        hdr.msg_namelen = sizeof(from);
+        hdr.msg_iov = &iov;
+        hdr.msg_iovlen = 1;
+#if defined(__linux__)
+        if (rxq_ovfl_enabled_ || rx_timestamps_enabled_) {
+            hdr.msg_control = control.buf;
+            hdr.msg_controllen = sizeof(control.buf);
+        }
+#endif
+        // Non-blocking read first; poll (with the stop wakeup) only when the socket is empty.
+        ssize_t received = ::recvmsg(fd, &hdr, MSG_DONTWAIT);
 
         if (received < 0) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
-                // Timeout or interrupted, just continue loop
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                HakoPduErrorType wait_err = poll_with_wakeup(fd, POLLIN, wakeup_, recv_poll_ms_(receiver));
+                if (wait_err == HAKO_PDU_ERR_NOT_RUNNING) {
+                    break;
+                }
+                if (receiver.reassembly) {
+                    expire_reassembly_(*receiver.reassembly);
+                }
+                continue;
+            }
+            if (errno == EINTR) {
                 continue;
             }
             if (!is_running_flag_) {
-                // Expected error after stop() called shutdown()
                 break;
             }
             // Real error
-            std::cerr << "UDP Comm recvfrom failed: " << std::strerror(errno) << std::endl;
+            std::cerr << "UDP Comm recvmsg failed: " << std::strerror(errno) << std::endl;
             continue;
         }
-
-        if (config_direction_ == HAKO_PDU_ENDPOINT_DIRECTION_INOUT && !has_fixed_remote_) {
-            std::memcpy(&last_client_addr_, &from, from_len);
-            last_client_addr_len_ = from_len;
+        int64_t rx_time_ns = 0;
+#if defined(__linux__)
+        const RecvControl recv_control = parse_recv_control(hdr);
+        if (recv_control.has_drops) {
+            on_rxq_drops_(receiver, recv_control.drops);
         }
+        rx_time_ns = recv_control.rx_time_ns;
+#endif
 
-        // Call the base class's method to handle raw data
-        on_raw_data_received({buffer.begin(), buffer.begin() + received});
+        on_datagram_(receiver, std::span<const std::byte>(buffer.data(), static_cast<size_t>(received)),
+                     reinterpret_cast<const sockaddr*>(&from), hdr.msg_namelen, rx_time_ns);
     }
 }
 
 
-HakoPduErrorType UdpComm::configure_socket_options(const Options& options) noexcept
+HakoPduErrorType UdpComm::configure_socket_options(int fd, const Options& options) noexcept
 {
+    if (options.receiver_threads > 1) {
+#ifdef SO_REUSEPORT
+        int reuse_port = 1;
+        if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &reuse_port, sizeof(reuse_port)) != 0) {
+            return HAKO_PDU_ERR_IO_ERROR;
+        }
+#else
+        return HAKO_PDU_ERR_UNSUPPORTED;
+#endif
+    }
     if (options.reuse_address) {
         int reuse = 1;
-        if (setsockopt(socket_fd_.load(), SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0) {
+        if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0) {
             return HAKO_PDU_ERR_IO_ERROR;
         }
     }
     if (options.broadcast) {
         int broadcast = 1;
-        if (setsockopt(socket_fd_.load(), SOL_SOCKET, SO_BROADCAST, &broadcast, sizeof(broadcast)) != 0) {
+        if (setsockopt(fd, SOL_SOCKET, SO_BROADCAST, &broadcast, sizeof(broadcast)) != 0) {
             return HAKO_PDU_ERR_IO_ERROR;
         }
     }
     if (options.buffer_size > 0) {
-        if (setsockopt(socket_fd_.load(), SOL_SOCKET, SO_RCVBUF, &options.buffer_size, sizeof(options.buffer_size)) != 0) {
+        if (setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &options.buffer_size, sizeof(options.buffer_size)) != 0) {
             return HAKO_PDU_ERR_IO_ERROR;
         }
     }
     timeval timeout{};
     timeout.tv_sec = options.timeout_ms / 1000;
     timeout.tv_usec = (options.timeout_ms % 1000) * 1000;
-    if (setsockopt(socket_fd_.load(), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) != 0) {
+    if (setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) != 0) {
         return HAKO_PDU_ERR_IO_ERROR;
     }
-    if (setsockopt(socket_fd_.load(), SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) != 0) {
+    if (setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) != 0) {
         return HAKO_PDU_ERR_IO_ERROR;
     }
     if (!options.blocking) {
-        int flags = fcntl(socket_fd_.load(), F_GETFL, 0);
-        if (flags < 0 || fcntl(socket_fd_.load(), F_SETFL, flags | O_NONBLOCK) != 0) {
+        int flags = fcntl(fd, F_GETFL, 0);
+        if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) != 0) {
             return HAKO_PDU_ERR_IO_ERROR;
         }
     }
     return HAKO_PDU_ERR_OK;
 }
 
+void UdpComm::configure_segmentation_offload(const Options& options) noexcept
+{
+    gso_enabled_ = false;
+    gro_enabled_ = false;
+#if defined(__linux__)
+    if (options.gso && config_direction_ != HAKO_PDU_ENDPOINT_DIRECTION_IN) {
+        int probe = 0;
+        socklen_t probe_len = sizeof(probe);
+        if (send_uring_) {
+            std::cerr << "UDP Comm: 'gso' is ignored with the io_uring backend." << std::endl;
+        } else if (getsockopt(socket_fd_.load(), SOL_UDP, UDP_SEGMENT, &probe, &probe_len) != 0) {
+            std::cerr << "UDP Comm: UDP_SEGMENT unsupported, GSO disabled: " << std::strerror(errno) << std::endl;
+        } else {
+            gso_enabled_ = true;
+        }
+    }
+    if (options.gro && config_direction_ != HAKO_PDU_ENDPOINT_DIRECTION_OUT) {
+        int on = 1;
+        if (!receivers_.empty() && receivers_.front()->uring) {
+            std::cerr << "UDP Comm: 'gro' is ignored with the io_uring backend." << std::endl;
+        } else {
+            gro_enabled_ = true;
+            for (auto& receiver : receivers_) {
+                if (setsockopt(receiver->fd, SOL_UDP, UDP_GRO, &on, sizeof(on)) != 0) {
+                    std::cerr << "UDP Comm: UDP_GRO unsupported, GRO disabled: " << std::strerror(errno) << std::endl;
+                    gro_enabled_ = false;
+                    break;
+                }
+            }
+        }
+    }
+#else
+    if (options.gso || options.gro) {
+        std::cerr << "UDP Comm: 'gso'/'gro' are only supported on Linux." << std::endl;
+    }
+#endif
+}
+
+void UdpComm::configure_drop_accounting(const Options& options) noexcept
+{
+    rxq_ovfl_enabled_ = false;
+    rcvbuf_autotune_ = options.rcvbuf_autotune;
+    for (auto& receiver : receivers_) {
+        int rcvbuf = 0;
+        socklen_t len = sizeof(rcvbuf);
+        if (getsockopt(receiver->fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, &len) == 0) {
+            receiver->rcvbuf = rcvbuf;
+        }
+        // The kernel reports twice the requested size; start doubling from the request.
+        receiver->rcvbuf_request = options.buffer_size > 0 ? options.buffer_size : rcvbuf / 2;
+    }
+#if defined(__linux__)
+    if (receivers_.empty()) {
+        return;
+    }
+    if (receivers_.front()->uring) {
+        if (options.rcvbuf_autotune.enabled) {
+            std::cerr << "UDP Comm: 'rcvbuf_autotune' is ignored with the io_uring backend." << std::endl;
+        }
+        rcvbuf_autotune_.enabled = false;
+        return;
+    }
+    int on = 1;
+    rxq_ovfl_enabled_ = true;
+    for (auto& receiver : receivers_) {
+        if (setsockopt(receiver->fd, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof(on)) != 0) {
+            std::cerr << "UDP Comm: SO_RXQ_OVFL unsupported, drop accounting disabled: " << std::strerror(errno) << std::endl;
+            rxq_ovfl_enabled_ = false;
+            break;
+        }
+    }
+#endif
+    if (!rxq_ovfl_enabled_) {
+        rcvbuf_autotune_.enabled = false;
+    }
+}
+
+void UdpComm::configure_rx_timestamps(const Options& options) noexcept
+{
+    rx_timestamps_enabled_ = false;
+    set_latency_tracking(options.latency_tracking);
+    if (!options.latency_tracking) {
+        return;
+    }
+#if defined(__linux__)
+    if (receivers_.empty() || receivers_.front()->uring) {
+        return; // io_uring completions carry no cmsgs: the arrival time is taken in userspace
+    }
+    int on = 1;
+    rx_timestamps_enabled_ = true;
+    for (auto& receiver : receivers_) {
+        if (setsockopt(receiver->fd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) != 0) {
+            std::cerr << "UDP Comm: SO_TIMESTAMPNS unsupported, using userspace receive time: " << std::strerror(errno) << std::endl;
+            rx_timestamps_enabled_ = false;
+            break;
+        }
+    }
+#endif
+}
+
 HakoPduErrorType UdpComm::configure_multicast(const Options& options) noexcept
 {
-    if (options.multicast_group.empty()) {
+    const auto& channel_groups = options.multicast_channel_groups;
+    if (options.multicast_group.empty() && channel_groups.empty()) {
         return HAKO_PDU_ERR_INVALID_ARGUMENT;
     }
     if (config_direction_ == HAKO_PDU_ENDPOINT_DIRECTION_IN || config_direction_ == HAKO_PDU_ENDPOINT_DIRECTION_INOUT) {
-        ip_mreq mreq{};
-        if (inet_pton(AF_INET, options.multicast_group.c_str(), &mreq.imr_multiaddr) != 1) return HAKO_PDU_ERR_INVALID_ARGUMENT;
-        if (inet_pton(AF_INET, options.multicast_interface.c_str(), &mreq.imr_interface) != 1) return HAKO_PDU_ERR_INVALID_ARGUMENT;
-        if (setsockopt(socket_fd_.load(), IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) != 0) return HAKO_PDU_ERR_IO_ERROR;
+        // Join the default group and the groups of the subscribed channels only; the
+        // NIC/kernel drops traffic of the other groups before it reaches the socket.
+        std::vector<std::string> groups;
+        try {
+            if (!options.multicast_group.empty()) {
+                groups.push_back(options.multicast_group);
+            }
+            for (const auto& [channel, group] : channel_groups) {
+                const auto& subscribe = options.multicast_subscribe_channels;
+                if ((subscribe.empty() || std::find(subscribe.begin(), subscribe.end(), channel) != subscribe.end())
+                    && std::find(groups.begin(), groups.end(), group) == groups.end()) {
+                    groups.push_back(group);
+                }
+            }
+        } catch (const std::bad_alloc&) {
+            return HAKO_PDU_ERR_OUT_OF_MEMORY;
+        }
+        for (const auto& group : groups) {
+            ip_mreq mreq{};
+            if (inet_pton(AF_INET, group.c_str(), &mreq.imr_multiaddr) != 1) return HAKO_PDU_ERR_INVALID_ARGUMENT;
+            if (inet_pton(AF_INET, options.multicast_interface.c_str(), &mreq.imr_interface) != 1) return HAKO_PDU_ERR_INVALID_ARGUMENT;
+            if (setsockopt(socket_fd_.load(), IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) != 0) return HAKO_PDU_ERR_IO_ERROR;
+        }
+#if defined(__linux__) && defined(IP_MULTICAST_ALL)
+        if (!channel_groups.empty()) {
+            // Linux otherwise delivers every group joined by any socket on this port.
+            int all = 0;
+            if (setsockopt(socket_fd_.load(), IPPROTO_IP, IP_MULTICAST_ALL, &all, sizeof(all)) != 0) return HAKO_PDU_ERR_IO_ERROR;
+        }
+#endif
     }
     if (config_direction_ == HAKO_PDU_ENDPOINT_DIRECTION_OUT || config_direction_ == HAKO_PDU_ENDPOINT_DIRECTION_INOUT) {
         if (setsockopt(socket_fd_.load(), IPPROTO_IP, IP_MULTICAST_TTL, &options.multicast_ttl, sizeof(options.multicast_ttl)) != 0) {
             return HAKO_PDU_ERR_IO_ERROR;
         }
+        if (options.multicast_interface != "0.0.0.0") {
+            in_addr interface_addr{};
+            if (inet_pton(AF_INET, options.multicast_interface.c_str(), &interface_addr) != 1) return HAKO_PDU_ERR_INVALID_ARGUMENT;
+            if (setsockopt(socket_fd_.load(), IPPROTO_IP, IP_MULTICAST_IF, &interface_addr, sizeof(interface_addr)) != 0) return HAKO_PDU_ERR_IO_ERROR;
+        }
+        // Send side of the channel map: group address plus "port" (default: the remote's port).
+        uint16_t port = htons(static_cast<uint16_t>(options.multicast_port));
+        if (options.multicast_port == 0 && dest_addr_len_ > 0 && dest_addr_.ss_family == AF_INET) {
+            port = reinterpret_cast<const sockaddr_in*>(&dest_addr_)->sin_port;
+        }
+        if (!channel_groups.empty() && port == 0) {
+            std::cerr << "UDP Comm config error: multicast 'channel_groups' needs 'port' or an IPv4 'remote'." << std::endl;
+            return HAKO_PDU_ERR_INVALID_ARGUMENT;
+        }
+        for (const auto& [channel, group] : channel_groups) {
+            Destination destination;
+            auto* addr = reinterpret_cast<sockaddr_in*>(&destination.addr);
+            addr->sin_family = AF_INET;
+            addr->sin_port = port;
+            if (inet_pton(AF_INET, group.c_str(), &addr->sin_addr) != 1) return HAKO_PDU_ERR_INVALID_ARGUMENT;
+            destination.len = sizeof(sockaddr_in);
+            try {
+                channel_groups_[channel] = destination;
+            } catch (const std::bad_alloc&) {
+                return HAKO_PDU_ERR_OUT_OF_MEMORY;
+            }
+        }
     }
     return HAKO_PDU_ERR_OK;
 }
@@ -0,0 +1,473 @@
+#include "hakoniwa/pdu/comm/comm_udp_mux.hpp"
+#include "hakoniwa/pdu/comm/comm_raw.hpp"
+#include "hakoniwa/pdu/comm/packet.hpp"
+#include "hakoniwa/pdu/socket_utils.hpp"
+#include <nlohmann/json.hpp>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+namespace hakoniwa {
+namespace pdu {
+namespace comm {
+
+namespace {
+constexpr int kUdpSocketType = SOCK_DGRAM;
+constexpr size_t kMaxDatagramSize = 65536;
+// Datagrams kept per session until its endpoint is started (the first one is
+// the datagram that created the session).
+constexpr size_t kMaxPendingDatagrams = 64;
+constexpr int kMaxPollIntervalMs = 1000;
+} // namespace
+
+// The bound socket outlives the mux while sessions still reference it.
+struct UdpCommMultiplexer::SharedSocket {
+    int fd = -1;
+    ~SharedSocket()
+    {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+};
+
+// One peer of the mux socket. Receive data is pushed by the mux recv thread;
+// send goes to the peer address through the shared socket.
+class UdpCommMultiplexer::Session final : public PduCommRaw
+{
+public:
+    // config: the mux's parsed config, used instead of reading config_path again.
+    Session(std::shared_ptr<SharedSocket> socket, const PeerKey& peer, std::shared_ptr<const nlohmann::json> config)
+        : socket_(std::move(socket)), peer_(peer), config_(std::move(config)) {}
+    ~Session() override { (void)raw_close(); }
+
+    // Called by the mux recv thread.
+    void deliver(std::span<const std::byte> data)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_) {
+            on_raw_data_received(data);
+        } else if (!expired_ && pending_.size() < kMaxPendingDatagrams) {
+            try {
+                pending_.emplace_back(data.begin(), data.end());
+            } catch (const std::bad_alloc&) {
+                std::cerr << "UDP Mux: out of memory, datagram dropped." << std::endl;
+            }
+        }
+    }
+
+    // Last datagram from the peer; recv thread only.
+    std::chrono::steady_clock::time_point last_seen{};
+
+    void expire() noexcept
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        expired_ = true;
+        running_ = false;
+        pending_.clear();
+    }
+
+protected:
+    HakoPduErrorType raw_open(const std::string& config_path) override
+    {
+        nlohmann::json file_json;
+        if (!config_) {
+            std::ifstream config_stream(config_path);
+            if (!config_stream) {
+                std::cerr << "Failed to open UDP Mux Comm config file: " << config_path << std::endl;
+                return HAKO_PDU_ERR_IO_ERROR;
+            }
+            try {
+                config_stream >> file_json;
+            } catch (const nlohmann::json::exception& e) {
+                std::cerr << "UDP Mux Comm config JSON parse error: " << e.what() << std::endl;
+                return HAKO_PDU_ERR_INVALID_ARGUMENT;
+            }
+        }
+        const nlohmann::json& config_json = config_ ? *config_ : file_json;
+
+        if (!config_json.contains("protocol") || config_json.at("protocol").get<std::string>() != "udp") {
+            std::cerr << "UDP Mux Comm config error: protocol is not 'udp'." << std::endl;
+            return HAKO_PDU_ERR_INVALID_ARGUMENT;
+        }
+        if (config_json.contains("direction")) {
+            config_direction_ = parse_direction(config_json.at("direction").get<std::string>());
+        }
+
+        if (config_json.contains("comm_raw_version")) {
+            if (!config_json.at("comm_raw_version").is_string()) {
+                std::cerr << "UDP Mux Comm config error: 'comm_raw_version' must be a string." << std::endl;
+                return HAKO_PDU_ERR_INVALID_ARGUMENT;
+            }
+            const std::string version = config_json.at("comm_raw_version").get<std::string>();
+            if (!set_packet_version(version)) {
+                std::cerr << "UDP Mux Comm config error: unsupported comm_raw_version '" << version << "'." << std::endl;
+                return HAKO_PDU_ERR_INVALID_ARGUMENT;
+            }
+        }
+        return HAKO_PDU_ERR_OK;
+    }
+
+    HakoPduErrorType raw_close() noexcept override
+    {
+        (void)raw_stop();
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.clear();
+        return HAKO_PDU_ERR_OK;
+    }
+
+    HakoPduErrorType raw_start() noexcept override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_) {
+            return HAKO_PDU_ERR_BUSY;
+        }
+        if (expired_) {
+            return HAKO_PDU_ERR_NOT_RUNNING;
+        }
+        running_ = true;
+        // Datagrams that arrived before the endpoint was ready.
+        for (const auto& data : pending_) {
+            on_raw_data_received(data);
+        }
+        pending_.clear();
+        return HAKO_PDU_ERR_OK;
+    }
+
+    HakoPduErrorType raw_stop() noexcept override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+        return HAKO_PDU_ERR_OK;
+    }
+
+    HakoPduErrorType raw_is_running(bool& running) noexcept override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running = running_;
+        return HAKO_PDU_ERR_OK;
+    }
+
+    HakoPduErrorType raw_send(const std::vector<std::byte>& data) noexcept override
+    {
+        if (config_direction_ == HAKO_PDU_ENDPOINT_DIRECTION_IN) {
+            return HAKO_PDU_ERR_INVALID_ARGUMENT;
+        }
+        if (expired_) {
+            return HAKO_PDU_ERR_NOT_RUNNING;
+        }
+        ssize_t sent = ::sendto(socket_->fd, data.data(), data.size(), 0,
+                                reinterpret_cast<const sockaddr*>(&peer_.addr), peer_.len);
+        if (sent < 0) {
+            return map_errno_to_error(errno);
+        }
+        return HAKO_PDU_ERR_OK;
+    }
+
+private:
+    std::shared_ptr<SharedSocket> socket_;
+    const PeerKey peer_;
+    const std::shared_ptr<const nlohmann::json> config_;
+    std::mutex mutex_; // recv thread (deliver/expire) vs the endpoint's start/stop
+    bool running_ = false;
+    std::atomic<bool> expired_{false};
+    std::deque<std::vector<std::byte>> pending_;
+    HakoPduEndpointDirectionType config_direction_ = HAKO_PDU_ENDPOINT_DIRECTION_INOUT;
+};
+
+bool UdpCommMultiplexer::PeerKey::operator==(const PeerKey& other) const noexcept
+{
+    return len == other.len && std::memcmp(&addr, &other.addr, len) == 0;
+}
+
+size_t UdpCommMultiplexer::PeerKeyHash::operator()(const PeerKey& key) const noexcept
+{
+    // FNV-1a over the address bytes.
+    const auto* bytes = reinterpret_cast<const unsigned char*>(&key.addr);
+    size_t hash = 1469598103934665603ULL;
+    for (socklen_t i = 0; i < key.len; ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+UdpCommMultiplexer::UdpCommMultiplexer() {}
+UdpCommMultiplexer::~UdpCommMultiplexer() { close(); }
+
+HakoPduErrorType UdpCommMultiplexer::open(const std::string& config_path)
+{
+    if (socket_) {
+        return HAKO_PDU_ERR_BUSY;
+    }
+
+    std::ifstream config_stream(config_path);
+    if (!config_stream) {
+        std::cerr << "Failed to open UDP Mux config file: " << config_path << std::endl;
+        return HAKO_PDU_ERR_IO_ERROR;
+    }
+
+    nlohmann::json config_json;
+    try {
+        config_stream >> config_json;
+    } catch (const nlohmann::json::exception& e) {
+        std::cerr << "UDP Mux config JSON parse error: " << e.what() << std::endl;
+        return HAKO_PDU_ERR_INVALID_ARGUMENT;
+    }
+
+    if (!config_json.contains("protocol") || config_json.at("protocol").get<std::string>() != "udp") {
+        std::cerr << "UDP Mux config error: protocol is not 'udp'." << std::endl;
+        return HAKO_PDU_ERR_INVALID_ARGUMENT;
+    }
+    if (!config_json.contains("local")) {
+        std::cerr << "UDP Mux config error: missing 'local'." << std::endl;
+        return HAKO_PDU_ERR_INVALID_ARGUMENT;
+    }
+    if (!config_json.contains("expected_clients")) {
+        std::cerr << "UDP Mux config error: missing 'expected_clients'." << std::endl;
+        return HAKO_PDU_ERR_INVALID_ARGUMENT;
+    }
+
+    expected_clients_ = config_json.at("expected_clients").get<size_t>();
+
+    if (config_json.contains("options")) {
+        const auto& opts = config_json.at("options");
+        options_.buffer_size = opts.value("buffer_size", options_.buffer_size);
+        options_.reuse_address = opts.value("reuse_address", options_.reuse_address);
+        options_.idle_timeout_ms = opts.value("idle_timeout_ms", options_.idle_timeout_ms);
+        if (options_.idle_timeout_ms < 0) {
+            std::cerr << "UDP Mux config error: 'idle_timeout_ms' must be >= 0." << std::endl;
+            return HAKO_PDU_ERR_INVALID_ARGUMENT;
+        }
+        options_.max_peers = opts.value("max_peers", options_.max_peers);
+    }
+    if (config_json.contains("comm_raw_version") && config_json.at("comm_raw_version").is_string()) {
+        packet_version_ = config_json.at("comm_raw_version").get<std::string>(); // validated by the sessions
+    }
+
+    addrinfo* local_addr_info = nullptr;
+    if (resolve_address(config_json.at("local"), kUdpSocketType, &local_addr_info) != HAKO_PDU_ERR_OK) {
+        std::cerr << "UDP Mux config error: failed to resolve local address." << std::endl;
+        return HAKO_PDU_ERR_INVALID_ARGUMENT;
+    }
+
+    auto socket = std::make_shared<SharedSocket>();
+    socket->fd = ::socket(local_addr_info->ai_family, local_addr_info->ai_socktype, local_addr_info->ai_protocol);
+    if (socket->fd < 0) {
+        freeaddrinfo(local_addr_info);
+        std::cerr << "Failed to create socket: " << std::strerror(errno) << std::endl;
+        return HAKO_PDU_ERR_IO_ERROR;
+    }
+    if (configure_socket_options_(socket->fd, options_) != HAKO_PDU_ERR_OK) {
+        freeaddrinfo(local_addr_info);
+        std::cerr << "Failed to configure socket options." << std::endl;
+        return HAKO_PDU_ERR_IO_ERROR;
+    }
+    if (::bind(socket->fd, local_addr_info->ai_addr, local_addr_info->ai_addrlen) != 0) {
+        freeaddrinfo(local_addr_info);
+        std::cerr << "Failed to bind socket: " << std::strerror(errno) << std::endl;
+        return HAKO_PDU_ERR_IO_ERROR;
+    }
+    freeaddrinfo(local_addr_info);
+    session_config_ = std::make_shared<const nlohmann::json>(std::move(config_json));
+    socket_ = std::move(socket);
+    return HAKO_PDU_ERR_OK;
+}
+
+HakoPduErrorType UdpCommMultiplexer::close() noexcept
+{
+    stop();
+    for (auto& entry : peers_) {
+        entry.second->expire();
+    }
+    peers_.clear();
+    connected_clients_ = 0;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        pending_sessions_.clear();
+    }
+    socket_.reset(); // closed once the last taken session is gone
+    session_config_.reset();
+    wakeup_.close();
+    return HAKO_PDU_ERR_OK;
+}
+
+HakoPduErrorType UdpCommMultiplexer::start() noexcept
+{
+    if (is_running_) {
+        return HAKO_PDU_ERR_BUSY;
+    }
+    if (!socket_) {
+        std::cerr << "UDP Mux start failed: not opened." << std::endl;
+        return HAKO_PDU_ERR_INVALID_ARGUMENT;
+    }
+    if (wakeup_.open() != HAKO_PDU_ERR_OK) {
+        std::cerr << "UDP Mux start failed: cannot create wakeup fd." << std::endl;
+        return HAKO_PDU_ERR_IO_ERROR;
+    }
+    wakeup_.drain();
+    is_running_ = true;
+    session_signal_->start();
+    recv_thread_ = std::thread(&UdpCommMultiplexer::recv_loop_, this);
+    return HAKO_PDU_ERR_OK;
+}
+
+HakoPduErrorType UdpCommMultiplexer::stop() noexcept
+{
+    session_signal_->stop();
+    if (!is_running_) {
+        return HAKO_PDU_ERR_OK;
+    }
+    is_running_ = false;
+    wakeup_.notify();
+    if (recv_thread_.joinable()) {
+        recv_thread_.join();
+    }
+    // The socket stays open until close(): taken sessions can still send.
+    return HAKO_PDU_ERR_OK;
+}
+
+std::vector<std::shared_ptr<PduComm>> UdpCommMultiplexer::take_sessions()
+{
+    session_signal_->clear();
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    std::vector<std::shared_ptr<PduComm>> out;
+    out.swap(pending_sessions_);
+    return out;
+}
+
+size_t UdpCommMultiplexer::connected_count() const noexcept
+{
+    return connected_clients_.load();
+}
+
+size_t UdpCommMultiplexer::expected_count() const noexcept
+{
+    return expected_clients_;
+}
+
+HakoPduErrorType UdpCommMultiplexer::get_admission_stats(CommMuxAdmissionStats& stats) const noexcept
+{
+    stats.accepted = accepted_peers_.load();
+    stats.rejected_max_sessions = rejected_max_peers_.load();
+    stats.rejected_rate = 0;
+    stats.live_sessions = connected_clients_.load();
+    return HAKO_PDU_ERR_OK;
+}
+
+void UdpCommMultiplexer::recv_loop_()
+{
+    const int fd = socket_->fd;
+    const int poll_ms = options_.idle_timeout_ms > 0
+        ? std::clamp(options_.idle_timeout_ms / 4, 1, kMaxPollIntervalMs)
+        : -1;
+    std::vector<std::byte> buffer(kMaxDatagramSize);
+    last_expiry_scan_ = std::chrono::steady_clock::now();
+    while (is_running_) {
+        HakoPduErrorType wait_err = poll_with_wakeup(fd, POLLIN, wakeup_, poll_ms);
+        if (wait_err == HAKO_PDU_ERR_NOT_RUNNING) {
+            break;
+        }
+        // Drain what is queued, then go back to poll.
+        while (wait_err == HAKO_PDU_ERR_OK && is_running_) {
+            PeerKey peer;
+            peer.len = sizeof(peer.addr);
+            ssize_t received = ::recvfrom(fd, buffer.data(), buffer.size(), MSG_DONTWAIT,
+                                          reinterpret_cast<sockaddr*>(&peer.addr), &peer.len);
+            if (received < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                    std::cerr << "UDP Mux recvfrom failed: " << std::strerror(errno) << std::endl;
+                }
+                break;
+            }
+            on_datagram_(peer, std::span<const std::byte>(buffer.data(), static_cast<size_t>(received)),
+                         std::chrono::steady_clock::now());
+        }
+        if (poll_ms > 0) {
+            expire_idle_(std::chrono::steady_clock::now());
+        }
+    }
+}
+
+void UdpCommMultiplexer::on_datagram_(const PeerKey& peer, std::span<const std::byte> data,
+                                      std::chrono::steady_clock::time_point now)
+{
+    auto it = peers_.find(peer);
+    if (it == peers_.end()) {
+        // A stray or spoofed source costs no session: the first datagram must
+        // decode as a PDU, and at most max_peers peers are live.
+        DataPacketView packet;
+        if (!DataPacket::decode_view(data, packet_version_, packet)) {
+            return;
+        }
+        if (options_.max_peers > 0 && peers_.size() >= options_.max_peers) {
+            rejected_max_peers_.fetch_add(1);
+            return;
+        }
+        try {
+            auto session = std::make_shared<Session>(socket_, peer, session_config_);
+            it = peers_.emplace(peer, session).first;
+            try {
+                std::lock_guard<std::mutex> lock(sessions_mutex_);
+                pending_sessions_.push_back(std::move(session));
+            } catch (const std::bad_alloc&) {
+                peers_.erase(it);
+                throw;
+            }
+        } catch (const std::bad_alloc&) {
+            std::cerr << "UDP Mux: out of memory, datagram from a new peer dropped." << std::endl;
+            return;
+        }
+        accepted_peers_.fetch_add(1);
+        connected_clients_.fetch_add(1);
+        session_signal_->notify();
+    }
+    it->second->last_seen = now;
+    it->second->deliver(data);
+}
+
+void UdpCommMultiplexer::expire_idle_(std::chrono::steady_clock::time_point now) noexcept
+{
+    const auto idle_timeout = std::chrono::milliseconds(options_.idle_timeout_ms);
+    if (now - last_expiry_scan_ < idle_timeout / 4) {
+        return;
+    }
+    last_expiry_scan_ = now;
+    for (auto it = peers_.begin(); it != peers_.end();) {
+        if (now - it->second->last_seen >= idle_timeout) {
+            // A later datagram from the same address starts a new session.
+            it->second->expire();
+            it = peers_.erase(it);
+            connected_clients_.fetch_sub(1);
+        } else {
+            ++it;
+        }
+    }
+}
+
+HakoPduErrorType UdpCommMultiplexer::configure_socket_options_(int fd, const Options& options) noexcept
+{
+    if (options.reuse_address) {
+        int reuse = 1;
+        if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0) {
+            return HAKO_PDU_ERR_IO_ERROR;
+        }
+    }
+    if (options.buffer_size > 0) {
+        if (setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &options.buffer_size, sizeof(options.buffer_size)) != 0) {
+            return HAKO_PDU_ERR_IO_ERROR;
+        }
+    }
+    return HAKO_PDU_ERR_OK;
+}
+
+} // namespace comm
+} // namespace pdu
+} // namespace hakoniwa
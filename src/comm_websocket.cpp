@@ -3,31 +3,112 @@
 #include <nlohmann/json.hpp>
 #include <fstream>
 #include <iostream>
+#include <deque>
+#include <system_error>
+#include <boost/version.hpp>
+#include <cstddef>
+#include <new>
 #include <vector>
 
 namespace hakoniwa {
 namespace pdu {
 namespace comm {
 
+namespace {
+constexpr int kMaxIoThreads = 64;
+
+// Storage for the one read a session has in flight. asio/beast allocate the
+// operation state of every async_read; handing them this block instead of the
+// heap keeps steady-state receive allocation free. Only used on the session strand.
+class ReadHandlerMemory {
+public:
+    void* allocate(std::size_t size)
+    {
+        if (!in_use_ && size <= sizeof(storage_)) {
+            in_use_ = true;
+            return &storage_;
+        }
+        return ::operator new(size);
+    }
+    void deallocate(void* pointer) noexcept
+    {
+        if (pointer == &storage_) {
+            in_use_ = false;
+        } else {
+            ::operator delete(pointer);
+        }
+    }
+
+private:
+    alignas(std::max_align_t) unsigned char storage_[1024];
+    bool in_use_ = false;
+};
+
+template <typename T>
+class ReadHandlerAllocator {
+public:
+    using value_type = T;
+    explicit ReadHandlerAllocator(ReadHandlerMemory& memory) noexcept : memory_(&memory) {}
+    template <typename U>
+    ReadHandlerAllocator(const ReadHandlerAllocator<U>& other) noexcept : memory_(other.memory_) {}
+    T* allocate(std::size_t n) const { return static_cast<T*>(memory_->allocate(sizeof(T) * n)); }
+    void deallocate(T* pointer, std::size_t) const noexcept { memory_->deallocate(pointer); }
+    bool operator==(const ReadHandlerAllocator& other) const noexcept { return memory_ == other.memory_; }
+    bool operator!=(const ReadHandlerAllocator& other) const noexcept { return memory_ != other.memory_; }
+
+private:
+    template <typename> friend class ReadHandlerAllocator;
+    ReadHandlerMemory* memory_;
+};
+
+// Completion handler whose associated allocator is the session's ReadHandlerMemory.
+template <typename Handler>
+class ReadHandler {
+public:
+    using allocator_type = ReadHandlerAllocator<Handler>;
+    ReadHandler(ReadHandlerMemory& memory, Handler handler) : memory_(&memory), handler_(std::move(handler)) {}
+    allocator_type get_allocator() const noexcept { return allocator_type(*memory_); }
+    template <typename... Args>
+    void operator()(Args&&... args) { handler_(std::forward<Args>(args)...); }
+
+private:
+    ReadHandlerMemory* memory_;
+    Handler handler_;
+};
+} // namespace
+
 // Handles a single WebSocket connection (session) for both client and server
 class WebSocketSession : public std::enable_shared_from_this<WebSocketSession> {
-    websocket::stream<beast::tcp_stream> ws_;
+    websocket::stream<WebSocketStream> ws_;
     beast::flat_buffer buffer_;
+    ReadHandlerMemory read_memory_;
     std::weak_ptr<WebSocketComm> comm_parent_;
-    std::vector<std::vector<std::byte>> write_queue_;
+    // Frames waiting to be written; shared with the other sessions of a broadcast.
+    // The front one is being written while is_writing_ is set.
+    std::deque<WebSocketFrame> write_queue_;
+    size_t queued_bytes_ = 0; // session executor only
     std::atomic<bool> is_writing_{false};
     std::atomic<bool> is_closing_{false};
     tcp::resolver::results_type endpoints_;
     std::atomic<bool> handshake_done_{false};
 
+    // Identity and counters for WebSocketComm::get_session_stats().
+    uint64_t id_ = 0;
+    std::string remote_;
+    std::atomic<size_t> stat_queued_messages_{0};
+    std::atomic<size_t> stat_queued_bytes_{0};
+    std::atomic<uint64_t> sent_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> conflated_{0};
+
 public:
     // Constructor for server-side sessions
-    explicit WebSocketSession(tcp::socket&& socket, std::shared_ptr<WebSocketComm> parent)
+    explicit WebSocketSession(WebSocketSocket&& socket, std::shared_ptr<WebSocketComm> parent)
         : ws_(std::move(socket)), comm_parent_(parent) {}
     
     // Constructor for client-side sessions
     explicit WebSocketSession(net::io_context& ioc, std::shared_ptr<WebSocketComm> parent)
-        : ws_(ioc), comm_parent_(parent) {}
+        : ws_(net::make_strand(ioc)), comm_parent_(parent) {}
 
     // Gracefully close the WebSocket connection
     void close() {
@@ -50,8 +131,47 @@ public:
         return handshake_done_.load() && ws_.is_open() && !is_closing_.load();
     }
 
+    void set_identity(uint64_t id, std::string remote) {
+        id_ = id;
+        remote_ = std::move(remote);
+    }
+    WebSocketSessionStats stats() const {
+        WebSocketSessionStats st;
+        st.id = id_;
+        st.remote = remote_;
+        st.queued_messages = stat_queued_messages_.load();
+        st.queued_bytes = stat_queued_bytes_.load();
+        st.sent = sent_.load();
+        st.dropped = dropped_.load();
+        st.conflated = conflated_.load();
+        return st;
+    }
+
+    // Offer/accept permessage-deflate; must be set before the handshake.
+    void apply_deflate(const WebSocketComm::DeflateOptions& options) {
+        if (!options.enabled) {
+            return;
+        }
+        websocket::permessage_deflate pmd;
+        pmd.server_enable = true;
+        pmd.client_enable = true;
+        pmd.server_max_window_bits = options.window_bits;
+        pmd.client_max_window_bits = options.window_bits;
+        pmd.server_no_context_takeover = options.no_context_takeover;
+        pmd.client_no_context_takeover = options.no_context_takeover;
+        pmd.compLevel = options.compression_level;
+        pmd.memLevel = options.mem_level;
+#if BOOST_VERSION >= 108000
+        pmd.msg_size_threshold = options.min_size;
+#endif
+        ws_.set_option(pmd);
+    }
+
     // Start the server-side session
     void start_server_session() {
+        if (auto parent = comm_parent_.lock()) {
+            apply_deflate(parent->deflate_);
+        }
         ws_.set_option(websocket::stream_base::decorator(
             [](websocket::response_type& res) {
                 res.set(http::field::server, std::string(BOOST_BEAST_VERSION_STRING) + " websocket-comm-server");
@@ -78,6 +198,7 @@ public:
         }
         if (auto parent = comm_parent_.lock()) {
             beast::get_lowest_layer(ws_).expires_never();
+            apply_deflate(parent->deflate_);
             ws_.async_handshake(parent->remote_host_, parent->remote_path_,
                 beast::bind_front_handler(&WebSocketSession::on_handshake, shared_from_this()));
         } else {
@@ -96,6 +217,7 @@ public:
         }
         std::cout << "Session: Client handshake successful." << std::endl;
         handshake_done_.store(true);
+        flush_after_handshake();
         if (auto parent = comm_parent_.lock()) {
             do_read();
         } else {
@@ -113,16 +235,31 @@ public:
         }
         std::cout << "Session: Server connection accepted." << std::endl;
         handshake_done_.store(true);
+        flush_after_handshake();
         if (auto parent = comm_parent_.lock()) {
+            if (parent->role_ == WebSocketComm::Role::MuxSession) {
+                parent->on_mux_handshake_(); // reads start with the session endpoint
+                return;
+            }
             do_read();
         } else {
             std::cerr << "Session: Parent comm object is no longer valid after accept. Terminating session." << std::endl;
         }
     }
 
+    // Begin the read loop of a mux session once its endpoint has started.
+    void start_reading() {
+        net::post(ws_.get_executor(), [self = shared_from_this()]() {
+            if (!self->is_closing_) {
+                self->do_read();
+            }
+        });
+    }
+
     void do_read() {
         if (auto parent = comm_parent_.lock()) {
-            ws_.async_read(buffer_, beast::bind_front_handler(&WebSocketSession::on_read, shared_from_this()));
+            ws_.async_read(buffer_, ReadHandler(read_memory_,
+                beast::bind_front_handler(&WebSocketSession::on_read, shared_from_this())));
         } else {
             std::cerr << "Session: Parent comm object is no longer valid during read initiation. Terminating session." << std::endl;
         }
@@ -148,11 +285,11 @@ public:
         }
 
         if (auto parent = comm_parent_.lock()) {
-            const auto& data = buffer_.data();
-            std::vector<std::byte> received_data(
-                static_cast<const std::byte*>(data.data()), 
-                static_cast<const std::byte*>(data.data()) + data.size());
-            parent->on_session_data_received(received_data);
+            // flat_buffer holds the whole message contiguously: decode it in place.
+            // consume() keeps the storage, so steady-state reads do not allocate.
+            const auto data = buffer_.data();
+            parent->on_session_data_received(std::span<const std::byte>(
+                static_cast<const std::byte*>(data.data()), data.size()));
             buffer_.consume(buffer_.size());
             do_read();
         } else {
@@ -161,13 +298,19 @@ public:
         }
     }
 
-    void do_write(const std::vector<std::byte>& data) {
+    void do_write(WebSocketFrame frame) {
         if (auto parent = comm_parent_.lock()) {
-            net::post(ws_.get_executor(), [self = shared_from_this(), data](){
+            net::post(ws_.get_executor(), [self = shared_from_this(), frame = std::move(frame)]() mutable {
                 if (auto p = self->comm_parent_.lock()) { // Check again inside the lambda
+                    if (self->is_closing_) {
+                        return;
+                    }
                     bool was_empty = self->write_queue_.empty();
-                    self->write_queue_.push_back(data);
-                    if (was_empty && !self->is_writing_) {
+                    if (!self->enqueue(std::move(frame), p->send_queue_, *p)) {
+                        return; // dropped as a slow consumer
+                    }
+                    // Before the handshake is done, frames wait for flush_after_handshake().
+                    if (was_empty && !self->is_writing_ && self->handshake_done_) {
                         self->process_write_queue();
                     }
                 } else {
@@ -186,6 +329,70 @@ public:
     }
 
 private:
+    // Frames sent while the handshake was in progress.
+    void flush_after_handshake() {
+        if (!write_queue_.empty() && !is_writing_) {
+            process_write_queue();
+        }
+    }
+
+    // Queue a frame and apply the send_queue limits. Runs on the session executor.
+    // Returns false when the session was disconnected as a slow consumer.
+    bool enqueue(WebSocketFrame frame, const WebSocketComm::SendQueueOptions& limits, WebSocketComm& parent) {
+        using Policy = WebSocketComm::SendQueueOptions::Policy;
+        const size_t first_unsent = is_writing_ ? 1 : 0;
+        if (limits.policy == Policy::Conflate) {
+            for (size_t i = first_unsent; i < write_queue_.size(); ++i) {
+                if (write_queue_[i]->key == frame->key) {
+                    queued_bytes_ = queued_bytes_ - write_queue_[i]->bytes.size() + frame->bytes.size();
+                    write_queue_[i] = std::move(frame);
+                    conflated_.fetch_add(1);
+                    update_queue_stats();
+                    return true;
+                }
+            }
+        }
+        queued_bytes_ += frame->bytes.size();
+        write_queue_.push_back(std::move(frame));
+        // The frame being written and the newest one always stay.
+        while (write_queue_.size() > first_unsent + 1
+               && ((limits.max_messages > 0 && write_queue_.size() > limits.max_messages)
+                   || (limits.max_bytes > 0 && queued_bytes_ > limits.max_bytes))) {
+            if (limits.policy == Policy::Disconnect) {
+                disconnect_slow_consumer(parent);
+                return false;
+            }
+            queued_bytes_ -= write_queue_[first_unsent]->bytes.size();
+            write_queue_.erase(write_queue_.begin() + static_cast<std::ptrdiff_t>(first_unsent));
+            dropped_.fetch_add(1);
+        }
+        update_queue_stats();
+        return true;
+    }
+
+    void update_queue_stats() {
+        stat_queued_messages_.store(write_queue_.size());
+        stat_queued_bytes_.store(queued_bytes_);
+    }
+
+    void clear_write_queue() {
+        write_queue_.clear();
+        queued_bytes_ = 0;
+        update_queue_stats();
+    }
+
+    // Close the socket without a close handshake: the peer is not reading, so
+    // a close frame would only queue behind the stalled writes.
+    void disconnect_slow_consumer(WebSocketComm& parent) {
+        std::cerr << "Session: slow consumer " << remote_ << " disconnected (send queue limit)." << std::endl;
+        parent.slow_consumer_disconnects_.fetch_add(1);
+        is_closing_ = true;
+        handshake_done_ = false;
+        clear_write_queue();
+        beast::get_lowest_layer(ws_).close();
+        parent.remove_session(shared_from_this());
+    }
+
     void process_write_queue() {
         if (write_queue_.empty()) {
             is_writing_ = false;
@@ -194,12 +401,12 @@ private:
         if (auto parent = comm_parent_.lock()) { // Check parent before async_write
             is_writing_ = true;
             ws_.binary(true);
-            ws_.async_write(net::buffer(write_queue_.front()),
+            ws_.async_write(net::buffer(write_queue_.front()->bytes),
                 beast::bind_front_handler(&WebSocketSession::on_write, shared_from_this()));
         } else {
             std::cerr << "Session: Parent comm object is no longer valid during write queue processing. Terminating write." << std::endl;
             is_writing_ = false; // Reset writing flag
-            write_queue_.clear(); // Clear pending writes
+            clear_write_queue(); // Clear pending writes
             if (auto self = shared_from_this()) {
                 self->close(); // Explicitly close the session
             }
@@ -210,6 +417,9 @@ private:
         is_writing_ = false;
         boost::ignore_unused(bytes_transferred);
         if (ec) {
+            if (is_closing_) {
+                return; // write aborted by close()
+            }
             std::cerr << "Session: Write error: " << ec.message() << std::endl;
             if (auto parent = comm_parent_.lock()) {
                 parent->remove_session(shared_from_this());
@@ -219,7 +429,10 @@ private:
             return;
         }
         if (auto parent = comm_parent_.lock()) {
-            write_queue_.erase(write_queue_.begin());
+            queued_bytes_ -= write_queue_.front()->bytes.size();
+            write_queue_.pop_front();
+            sent_.fetch_add(1);
+            update_queue_stats();
             if (!write_queue_.empty()) {
                 process_write_queue();
             }
@@ -228,14 +441,20 @@ private:
             if (auto self = shared_from_this()) {
                 self->close(); // Explicitly close the session
             }
-            write_queue_.clear(); // Clear pending writes
+            clear_write_queue(); // Clear pending writes
         }
     }
 };
 
 // WebSocketComm implementation
 WebSocketComm::WebSocketComm()
-    : acceptor_(ioc_), resolver_(ioc_), work_guard_(std::in_place, ioc_.get_executor()) {}
+    : WebSocketComm(std::make_shared<net::io_context>())
+{
+    work_guard_.emplace(ioc_->get_executor());
+}
+
+WebSocketComm::WebSocketComm(std::shared_ptr<net::io_context> ioc)
+    : ioc_(std::move(ioc)), acceptor_(*ioc_), resolver_(*ioc_) {}
 
 WebSocketComm::~WebSocketComm() {
     raw_close();
@@ -243,18 +462,21 @@ WebSocketComm::~WebSocketComm() {
 
 HakoPduErrorType WebSocketComm::raw_open(const std::string& config_path) {
     if (is_running_flag_) return HAKO_PDU_ERR_BUSY;
-    std::ifstream config_stream(config_path);
-    if (!config_stream) {
-        std::cerr << "WebSocket Comm config open failed: " << config_path << std::endl;
-        return HAKO_PDU_ERR_IO_ERROR;
-    }
-    nlohmann::json config_json;
-    try {
-        config_stream >> config_json;
-    } catch (const nlohmann::json::exception& e) {
-        std::cerr << "WebSocket Comm config JSON parse error: " << e.what() << std::endl;
-        return HAKO_PDU_ERR_INVALID_ARGUMENT;
+    nlohmann::json file_json;
+    if (!mux_config_) {
+        std::ifstream config_stream(config_path);
+        if (!config_stream) {
+            std::cerr << "WebSocket Comm config open failed: " << config_path << std::endl;
+            return HAKO_PDU_ERR_IO_ERROR;
+        }
+        try {
+            config_stream >> file_json;
+        } catch (const nlohmann::json::exception& e) {
+            std::cerr << "WebSocket Comm config JSON parse error: " << e.what() << std::endl;
+            return HAKO_PDU_ERR_INVALID_ARGUMENT;
+        }
     }
+    const nlohmann::json& config_json = mux_config_ ? *mux_config_ : file_json;
 
     if (!config_json.contains("protocol") || config_json.at("protocol").get<std::string>() != "websocket") {
         std::cerr << "WebSocket Comm config error: protocol is not 'websocket'." << std::endl;
@@ -264,7 +486,7 @@ HakoPduErrorType WebSocketComm::raw_open(const std::string& config_path) {
         std::cerr << "WebSocket Comm config error: missing 'direction'." << std::endl;
         return HAKO_PDU_ERR_INVALID_ARGUMENT;
     }
-    if (!config_json.contains("role")) {
+    if (role_ != Role::MuxSession && !config_json.contains("role")) {
         std::cerr << "WebSocket Comm config error: missing 'role'." << std::endl;
         return HAKO_PDU_ERR_INVALID_ARGUMENT;
     }
@@ -281,6 +503,63 @@ HakoPduErrorType WebSocketComm::raw_open(const std::string& config_path) {
             return HAKO_PDU_ERR_INVALID_ARGUMENT;
         }
     }
+    send_queue_ = SendQueueOptions{};
+    io_thread_count_ = 1;
+    if (config_json.contains("options")) {
+        io_thread_count_ = config_json.at("options").value("io_threads", 1);
+        if (io_thread_count_ < 1 || io_thread_count_ > kMaxIoThreads) {
+            std::cerr << "WebSocket Comm config error: 'io_threads' must be in 1.." << kMaxIoThreads << "." << std::endl;
+            return HAKO_PDU_ERR_INVALID_ARGUMENT;
+        }
+    }
+    if (config_json.contains("options") && config_json.at("options").contains("send_queue")) {
+        const auto& queue_opts = config_json.at("options").at("send_queue");
+        const int64_t max_messages = queue_opts.value("max_messages", int64_t{0});
+        const int64_t max_bytes = queue_opts.value("max_bytes", int64_t{0});
+        const std::string policy = queue_opts.value("policy", std::string("drop_oldest"));
+        if (max_messages < 0 || max_bytes < 0) {
+            std::cerr << "WebSocket Comm config error: 'send_queue' limits must not be negative." << std::endl;
+            return HAKO_PDU_ERR_INVALID_ARGUMENT;
+        }
+        send_queue_.max_messages = static_cast<size_t>(max_messages);
+        send_queue_.max_bytes = static_cast<size_t>(max_bytes);
+        if (policy == "drop_oldest") {
+            send_queue_.policy = SendQueueOptions::Policy::DropOldest;
+        } else if (policy == "conflate") {
+            send_queue_.policy = SendQueueOptions::Policy::Conflate;
+        } else if (policy == "disconnect") {
+            send_queue_.policy = SendQueueOptions::Policy::Disconnect;
+        } else {
+            std::cerr << "WebSocket Comm config error: unknown send_queue policy '" << policy << "'." << std::endl;
+            return HAKO_PDU_ERR_INVALID_ARGUMENT;
+        }
+    }
+    deflate_ = DeflateOptions{};
+    if (config_json.contains("options") && config_json.at("options").contains("permessage_deflate")) {
+        const auto& pmd_opts = config_json.at("options").at("permessage_deflate");
+        deflate_.enabled = pmd_opts.value("enabled", deflate_.enabled);
+        deflate_.window_bits = pmd_opts.value("window_bits", deflate_.window_bits);
+        deflate_.compression_level = pmd_opts.value("compression_level", deflate_.compression_level);
+        deflate_.mem_level = pmd_opts.value("mem_level", deflate_.mem_level);
+        deflate_.no_context_takeover = pmd_opts.value("no_context_takeover", deflate_.no_context_takeover);
+        const int64_t min_size = pmd_opts.value("min_size", int64_t{0});
+        if (deflate_.window_bits < 9 || deflate_.window_bits > 15
+            || deflate_.compression_level < 0 || deflate_.compression_level > 9
+            || deflate_.mem_level < 1 || deflate_.mem_level > 9
+            || min_size < 0) {
+            std::cerr << "WebSocket Comm config error: invalid 'permessage_deflate' options." << std::endl;
+            return HAKO_PDU_ERR_INVALID_ARGUMENT;
+        }
+        deflate_.min_size = static_cast<size_t>(min_size);
+#if BOOST_VERSION < 108000
+        if (deflate_.enabled && deflate_.min_size > 0) {
+            std::cerr << "WebSocket Comm: 'min_size' needs Boost 1.80 or later; every message is compressed." << std::endl;
+        }
+#endif
+    }
+    if (role_ == Role::MuxSession) {
+        return HAKO_PDU_ERR_OK; // "local"/"io_threads" belong to the multiplexer
+    }
     const std::string role_value = config_json.at("role").get<std::string>();
     if (role_value == "server") {
         role_ = Role::Server;
@@ -323,9 +602,29 @@ HakoPduErrorType WebSocketComm::raw_start() noexcept {
         std::cerr << "WebSocket Comm start requested while already running." << std::endl;
         return HAKO_PDU_ERR_BUSY;
     }
+    if (role_ == Role::MuxSession) {
+        std::lock_guard<std::mutex> lock(sessions_mtx_);
+        if (sessions_.empty()) {
+            return HAKO_PDU_ERR_NOT_RUNNING; // the client is already gone
+        }
+        is_running_flag_ = true;
+        sessions_.front()->start_reading();
+        return HAKO_PDU_ERR_OK;
+    }
     is_running_flag_ = true;
+    if (!work_guard_) {
+        work_guard_.emplace(ioc_->get_executor()); // reset by a previous raw_stop()
+    }
     
-    comm_thread_ = std::thread([this]() { ioc_.run(); });
+    try {
+        for (int i = 0; i < io_thread_count_; ++i) {
+            io_threads_.emplace_back([this]() { ioc_->run(); });
+        }
+    } catch (const std::system_error& e) {
+        std::cerr << "WebSocket Comm start failed: cannot create io thread: " << e.what() << std::endl;
+        raw_stop();
+        return HAKO_PDU_ERR_IO_ERROR;
+    }
 
     if (role_ == Role::Server) {    
         do_accept();
@@ -338,7 +637,8 @@ HakoPduErrorType WebSocketComm::raw_start() noexcept {
 }
 
 HakoPduErrorType WebSocketComm::raw_stop() noexcept {
-    if (!is_running_flag_) return HAKO_PDU_ERR_OK;
+    // A mux session is closed even if its endpoint never started it.
+    if (!is_running_flag_ && role_ != Role::MuxSession) return HAKO_PDU_ERR_OK;
     is_running_flag_ = false;
 
     // Close acceptor to stop accepting new connections
@@ -359,18 +659,25 @@ HakoPduErrorType WebSocketComm::raw_stop() noexcept {
             session->close();
         }
     }
+    if (role_ == Role::MuxSession) {
+        notify_mux_closed_(); // the io_context belongs to the multiplexer
+        return HAKO_PDU_ERR_OK;
+    }
     
     // Reset the work_guard to allow the io_context to stop
     work_guard_.reset();
     
     // Then stop the io_context
-    if (!ioc_.stopped()) {
-        ioc_.stop();
+    if (!ioc_->stopped()) {
+        ioc_->stop();
     }
     
-    if (comm_thread_.joinable()) comm_thread_.join(); // Wait for the communication thread to finish
+    for (auto& thread : io_threads_) {
+        if (thread.joinable()) thread.join(); // Wait for the io threads to finish
+    }
+    io_threads_.clear();
 
-    ioc_.restart(); // Prepare for possible reuse
+    ioc_->restart(); // Prepare for possible reuse
     
     return HAKO_PDU_ERR_OK;
 }
@@ -386,9 +693,46 @@ void WebSocketComm::remove_session(std::shared_ptr<WebSocketSession> session_to_
         remaining = sessions_.size();
     }
     std::cout << "Session removed. Current active sessions: " << remaining << std::endl;
+    if (role_ == Role::MuxSession && remaining == 0) {
+        notify_mux_closed_();
+    }
+}
+
+void WebSocketComm::attach_mux_session_(WebSocketSocket socket, const std::string& remote, MuxNotify notify) {
+    role_ = Role::MuxSession;
+    mux_notify_ = std::move(notify);
+    std::lock_guard<std::mutex> lock(sessions_mtx_);
+    auto session = std::make_shared<WebSocketSession>(std::move(socket), std::static_pointer_cast<WebSocketComm>(shared_from_this()));
+    session->set_identity(next_session_id_.fetch_add(1), remote);
+    sessions_.push_back(session);
+    session->start_server_session();
+}
+
+void WebSocketComm::on_mux_handshake_() {
+    MuxNotify notify;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mtx_);
+        notify = mux_notify_;
+    }
+    if (notify) {
+        notify(std::static_pointer_cast<WebSocketComm>(shared_from_this()), true);
+    }
+}
+
+void WebSocketComm::notify_mux_closed_() noexcept {
+    MuxNotify notify;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mtx_);
+        notify.swap(mux_notify_);
+    }
+    if (notify) {
+        // Null when called from the destructor; the mux no longer holds the comm then.
+        notify(std::static_pointer_cast<WebSocketComm>(weak_from_this().lock()), false);
+    }
 }
 
 HakoPduErrorType WebSocketComm::raw_is_running(bool& running) noexcept {
+    std::lock_guard<std::mutex> lock(sessions_mtx_);
     running = is_running_flag_ && !sessions_.empty() && sessions_.front()->is_connected();
     return HAKO_PDU_ERR_OK;
 }
@@ -398,39 +742,84 @@ HakoPduErrorType WebSocketComm::raw_send(const std::vector<std::byte>& data) noe
         std::cerr << "WebSocket Comm send failed: not running." << std::endl;
         return HAKO_PDU_ERR_NOT_RUNNING;
     }
+
+    // One immutable copy of the frame, shared by every session's write queue.
+    WebSocketFrame frame;
+    try {
+        auto out = std::make_shared<WebSocketOutFrame>();
+        out->bytes = data;
+        if (send_queue_.policy == SendQueueOptions::Policy::Conflate) {
+            DataPacketView packet;
+            if (DataPacket::decode_view(out->bytes, packet_version(), packet)) {
+                out->key.robot.assign(packet.robot_name.data(), packet.robot_name.size());
+                out->key.channel_id = static_cast<decltype(out->key.channel_id)>(packet.meta.channel_id);
+            }
+        }
+        frame = std::move(out);
+    } catch (const std::bad_alloc&) {
+        return HAKO_PDU_ERR_OUT_OF_MEMORY;
+    }
+    return raw_send_frame(frame);
+}
+
+HakoPduErrorType WebSocketComm::raw_send_frame(const PduSharedFrame& frame) noexcept {
+    if (!is_running_flag_) {
+        std::cerr << "WebSocket Comm send failed: not running." << std::endl;
+        return HAKO_PDU_ERR_NOT_RUNNING;
+    }
     std::lock_guard<std::mutex> lock(sessions_mtx_);
     if (sessions_.empty()) {
         std::cerr << "WebSocket Comm send failed: no active sessions." << std::endl;
         return HAKO_PDU_ERR_NOT_RUNNING;
     }
-
     for (const auto& session : sessions_) {
         if (session) {
-            session->do_write(data);
+            session->do_write(frame);
         }
     }
     return HAKO_PDU_ERR_OK;
 }
 
-void WebSocketComm::on_session_data_received(const std::vector<std::byte>& data) {
+void WebSocketComm::on_session_data_received(std::span<const std::byte> data) {
     on_raw_data_received(data);
 }
 
+HakoPduErrorType WebSocketComm::get_session_stats(std::vector<WebSocketSessionStats>& stats) const noexcept {
+    stats.clear();
+    try {
+        std::lock_guard<std::mutex> lock(sessions_mtx_);
+        stats.reserve(sessions_.size());
+        for (const auto& session : sessions_) {
+            if (session) {
+                stats.push_back(session->stats());
+            }
+        }
+    } catch (const std::bad_alloc&) {
+        stats.clear();
+        return HAKO_PDU_ERR_OUT_OF_MEMORY;
+    }
+    return HAKO_PDU_ERR_OK;
+}
+
 void WebSocketComm::do_accept() {
     if (!acceptor_.is_open()) return;
-    acceptor_.async_accept(net::make_strand(ioc_),
+    acceptor_.async_accept(net::make_strand(*ioc_),
         beast::bind_front_handler(&WebSocketComm::on_accept, std::static_pointer_cast<WebSocketComm>(shared_from_this())));
 }
 
-void WebSocketComm::on_accept(beast::error_code ec, tcp::socket socket) {
+void WebSocketComm::on_accept(beast::error_code ec, WebSocketSocket socket) {
     if (ec) {
         std::cerr << "Comm: Accept error: " << ec.message() << std::endl;
         do_accept();
         return;
     }
     std::cout << "Comm: Server connection accepted." << std::endl;
+    beast::error_code remote_ec;
+    const tcp::endpoint remote = socket.remote_endpoint(remote_ec);
     std::lock_guard<std::mutex> lock(this->sessions_mtx_);
     auto session = std::make_shared<WebSocketSession>(std::move(socket), std::static_pointer_cast<WebSocketComm>(this->shared_from_this()));
+    session->set_identity(next_session_id_.fetch_add(1),
+        remote_ec ? std::string() : remote.address().to_string() + ":" + std::to_string(remote.port()));
     this->sessions_.push_back(session);
     session->start_server_session();
     this->do_accept(); // Continue accepting
@@ -448,7 +837,8 @@ void WebSocketComm::on_resolve(beast::error_code ec, tcp::resolver::results_type
     }
     std::lock_guard<std::mutex> lock(this->sessions_mtx_);
     this->sessions_.clear(); // Ensure only one client session
-    auto session = std::make_shared<WebSocketSession>(this->ioc_, std::static_pointer_cast<WebSocketComm>(this->shared_from_this()));
+    auto session = std::make_shared<WebSocketSession>(*this->ioc_, std::static_pointer_cast<WebSocketComm>(this->shared_from_this()));
+    session->set_identity(next_session_id_.fetch_add(1), this->remote_host_ + ":" + this->remote_port_);
     this->sessions_.push_back(session);
     session->start_client_session(this->remote_host_, this->remote_path_, results);
 }
@@ -0,0 +1,330 @@
+#include "hakoniwa/pdu/comm/comm_websocket_mux.hpp"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <fstream>
+#include <chrono>
+#include <iostream>
+#include <optional>
+#include <system_error>
+#include <thread>
+
+namespace hakoniwa {
+namespace pdu {
+namespace comm {
+
+struct WebSocketCommMultiplexer::Shared {
+    net::io_context ioc;
+    std::mutex mutex;
+    // Accepted clients still in the WebSocket handshake, then sessions not yet taken.
+    std::vector<std::shared_ptr<WebSocketComm>> handshaking;
+    std::vector<std::shared_ptr<PduComm>> pending;
+    // Taken sessions that have not ended; the io threads run while any is left.
+    std::vector<const PduComm*> taken;
+    std::atomic<size_t> connected{0};
+    std::shared_ptr<SessionSignal> signal; // the mux's; notified when a session is pending
+    bool closed = false;                   // the mux's close(); nothing restarts the io threads
+    // Each thread holds the Shared until its run() returns.
+    std::optional<net::executor_work_guard<net::io_context::executor_type>> work_guard;
+    std::vector<std::thread> io_threads;
+
+    // Stops the io threads unless a taken session still uses them. Called when
+    // the mux no longer accepts; on an io thread they are detached, not joined.
+    void release_io() noexcept
+    {
+        std::vector<std::thread> threads;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!taken.empty() || io_threads.empty()) {
+                return;
+            }
+            threads.swap(io_threads);
+            work_guard.reset();
+        }
+        ioc.stop();
+        const bool on_io_thread = std::any_of(threads.begin(), threads.end(), [](const std::thread& t) {
+            return t.get_id() == std::this_thread::get_id();
+        });
+        for (auto& thread : threads) {
+            if (on_io_thread) {
+                thread.detach();
+            } else if (thread.joinable()) {
+                thread.join();
+            }
+        }
+    }
+};
+
+WebSocketCommMultiplexer::WebSocketCommMultiplexer() {}
+WebSocketCommMultiplexer::~WebSocketCommMultiplexer() { close(); }
+
+HakoPduErrorType WebSocketCommMultiplexer::open(const std::string& config_path)
+{
+    if (acceptor_) {
+        return HAKO_PDU_ERR_BUSY;
+    }
+
+    std::ifstream config_stream(config_path);
+    if (!config_stream) {
+        std::cerr << "Failed to open WebSocket Mux config file: " << config_path << std::endl;
+        return HAKO_PDU_ERR_IO_ERROR;
+    }
+
+    nlohmann::json config_json;
+    try {
+        config_stream >> config_json;
+    } catch (const nlohmann::json::exception& e) {
+        std::cerr << "WebSocket Mux config JSON parse error: " << e.what() << std::endl;
+        return HAKO_PDU_ERR_INVALID_ARGUMENT;
+    }
+
+    if (!config_json.contains("protocol") || config_json.at("protocol").get<std::string>() != "websocket") {
+        std::cerr << "WebSocket Mux config error: protocol is not 'websocket'." << std::endl;
+        return HAKO_PDU_ERR_INVALID_ARGUMENT;
+    }
+    if (!config_json.contains("local")) {
+        std::cerr << "WebSocket Mux config error: missing 'local'." << std::endl;
+        return HAKO_PDU_ERR_INVALID_ARGUMENT;
+    }
+    if (!config_json.contains("expected_clients")) {
+        std::cerr << "WebSocket Mux config error: missing 'expected_clients'." << std::endl;
+        return HAKO_PDU_ERR_INVALID_ARGUMENT;
+    }
+    expected_clients_ = config_json.at("expected_clients").get<size_t>();
+
+    auto session_config = std::make_shared<const nlohmann::json>(std::move(config_json));
+    auto shared = std::make_shared<Shared>();
+    shared->signal = session_signal_;
+
+    // Session options ("send_queue", "permessage_deflate", ...) are parsed and
+    // validated the way each session comm will parse them when its endpoint opens.
+    WebSocketComm prototype(std::shared_ptr<net::io_context>(shared, &shared->ioc));
+    prototype.role_ = WebSocketComm::Role::MuxSession;
+    prototype.mux_config_ = session_config;
+    HakoPduErrorType err = prototype.raw_open(config_path);
+    if (err != HAKO_PDU_ERR_OK) {
+        return err;
+    }
+    io_thread_count_ = prototype.io_thread_count_;
+    deflate_ = prototype.deflate_;
+
+    auto acceptor = std::make_unique<tcp::acceptor>(net::make_strand(shared->ioc));
+    try {
+        const auto& local = session_config->at("local");
+        const std::string address = local.value("address", std::string("0.0.0.0"));
+        const unsigned short port = local.value("port", 8080);
+        tcp::endpoint endpoint(net::ip::make_address(address), port);
+        acceptor->open(endpoint.protocol());
+        acceptor->set_option(net::socket_base::reuse_address(true));
+        acceptor->bind(endpoint);
+        acceptor->listen();
+    } catch (const std::exception& e) {
+        std::cerr << "WebSocket Mux listen failed: " << e.what() << std::endl;
+        return HAKO_PDU_ERR_IO_ERROR;
+    }
+    session_config_ = std::move(session_config);
+    shared_ = std::move(shared);
+    acceptor_ = std::move(acceptor);
+    return HAKO_PDU_ERR_OK;
+}
+
+HakoPduErrorType WebSocketCommMultiplexer::close() noexcept
+{
+    stop();
+    acceptor_.reset();
+    if (!shared_) {
+        return HAKO_PDU_ERR_OK;
+    }
+    std::vector<std::shared_ptr<WebSocketComm>> handshaking;
+    std::vector<std::shared_ptr<PduComm>> pending;
+    {
+        std::lock_guard<std::mutex> lock(shared_->mutex);
+        handshaking.swap(shared_->handshaking);
+        pending.swap(shared_->pending);
+        shared_->closed = true;
+    }
+    for (auto& comm : handshaking) {
+        std::lock_guard<std::mutex> lock(comm->sessions_mtx_);
+        comm->mux_notify_ = nullptr; // never counted as connected
+    }
+    // Dropped here, outside shared_->mutex: untaken sessions report their end.
+    handshaking.clear();
+    pending.clear();
+    shared_->release_io(); // idle since a stop() that left taken sessions running
+    shared_.reset(); // the io threads run on while taken sessions use them
+    return HAKO_PDU_ERR_OK;
+}
+
+HakoPduErrorType WebSocketCommMultiplexer::start() noexcept
+{
+    if (is_running_) {
+        return HAKO_PDU_ERR_BUSY;
+    }
+    if (!acceptor_) {
+        std::cerr << "WebSocket Mux start failed: not opened." << std::endl;
+        return HAKO_PDU_ERR_INVALID_ARGUMENT;
+    }
+    is_running_ = true;
+    session_signal_->start();
+    accept_armed_ = true;
+    try {
+        std::lock_guard<std::mutex> lock(shared_->mutex);
+        if (shared_->io_threads.empty()) { // else still running for taken sessions
+            shared_->ioc.restart();
+            shared_->work_guard.emplace(shared_->ioc.get_executor());
+            for (int i = 0; i < io_thread_count_; ++i) {
+                shared_->io_threads.emplace_back([shared = shared_]() { shared->ioc.run(); });
+            }
+        }
+    } catch (const std::system_error& e) {
+        std::cerr << "WebSocket Mux start failed: cannot create io thread: " << e.what() << std::endl;
+        accept_armed_ = false;
+        stop();
+        return HAKO_PDU_ERR_IO_ERROR;
+    }
+    net::post(acceptor_->get_executor(), [this]() { do_accept_(); });
+    return HAKO_PDU_ERR_OK;
+}
+
+HakoPduErrorType WebSocketCommMultiplexer::stop() noexcept
+{
+    session_signal_->stop();
+    if (!is_running_) {
+        return HAKO_PDU_ERR_OK;
+    }
+    is_running_ = false;
+    bool has_io_threads = false;
+    {
+        std::lock_guard<std::mutex> lock(shared_->mutex);
+        has_io_threads = !shared_->io_threads.empty();
+    }
+    if (has_io_threads) {
+        // The io threads may outlive this call: wait until neither the cancel
+        // nor an accept handler can still reach the mux.
+        std::atomic<bool> cancelled{false};
+        net::post(acceptor_->get_executor(), [acceptor = acceptor_.get(), &cancelled]() {
+            beast::error_code ec;
+            acceptor->cancel(ec);
+            cancelled = true;
+        });
+        while (!cancelled.load() || accept_armed_.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    shared_->release_io();
+    // The listener stays open until close() so the mux can be restarted.
+    return HAKO_PDU_ERR_OK;
+}
+
+std::vector<std::shared_ptr<PduComm>> WebSocketCommMultiplexer::take_sessions()
+{
+    std::vector<std::shared_ptr<PduComm>> out;
+    if (!shared_) {
+        return out;
+    }
+    session_signal_->clear();
+    std::lock_guard<std::mutex> lock(shared_->mutex);
+    shared_->taken.reserve(shared_->taken.size() + shared_->pending.size());
+    for (const auto& comm : shared_->pending) {
+        shared_->taken.push_back(comm.get());
+    }
+    out.swap(shared_->pending);
+    return out;
+}
+
+size_t WebSocketCommMultiplexer::connected_count() const noexcept
+{
+    return shared_ ? shared_->connected.load() : 0;
+}
+
+size_t WebSocketCommMultiplexer::expected_count() const noexcept
+{
+    return expected_clients_;
+}
+
+void WebSocketCommMultiplexer::do_accept_()
+{
+    if (!is_running_ || !acceptor_->is_open()) {
+        accept_armed_ = false; // last touch of the mux from the io threads
+        return;
+    }
+    acceptor_->async_accept(net::make_strand(shared_->ioc),
+        beast::bind_front_handler(&WebSocketCommMultiplexer::on_accept_, this));
+}
+
+void WebSocketCommMultiplexer::on_accept_(beast::error_code ec, WebSocketSocket socket)
+{
+    if (ec == net::error::operation_aborted) {
+        accept_armed_ = false; // stop()
+        return;
+    }
+    if (ec) {
+        std::cerr << "WebSocket Mux accept failed: " << ec.message() << std::endl;
+        do_accept_();
+        return;
+    }
+    beast::error_code remote_ec;
+    const tcp::endpoint remote = socket.remote_endpoint(remote_ec);
+    try {
+        auto comm = std::shared_ptr<WebSocketComm>(
+            new WebSocketComm(std::shared_ptr<net::io_context>(shared_, &shared_->ioc)));
+        comm->deflate_ = deflate_; // negotiated in the handshake, before the endpoint opens the comm
+        comm->mux_config_ = session_config_;
+        {
+            std::lock_guard<std::mutex> lock(shared_->mutex);
+            shared_->handshaking.push_back(comm);
+        }
+        std::weak_ptr<Shared> weak_shared = shared_;
+        comm->attach_mux_session_(std::move(socket),
+            remote_ec ? std::string() : remote.address().to_string() + ":" + std::to_string(remote.port()),
+            [weak_shared, id = comm.get()](const std::shared_ptr<WebSocketComm>&, bool connected) {
+                if (auto shared = weak_shared.lock()) {
+                    on_session_(shared, id, connected);
+                }
+            });
+    } catch (const std::bad_alloc&) {
+        std::cerr << "WebSocket Mux: out of memory, connection dropped." << std::endl;
+    }
+    do_accept_();
+}
+
+void WebSocketCommMultiplexer::on_session_(const std::shared_ptr<Shared>& shared, const WebSocketComm* comm,
+                                           bool connected)
+{
+    std::unique_lock<std::mutex> lock(shared->mutex);
+    auto it = std::find_if(shared->handshaking.begin(), shared->handshaking.end(),
+                           [comm](const std::shared_ptr<WebSocketComm>& c) { return c.get() == comm; });
+    if (connected) {
+        if (it != shared->handshaking.end()) {
+            shared->pending.push_back(*it);
+            shared->handshaking.erase(it);
+            shared->connected.fetch_add(1);
+            lock.unlock();
+            shared->signal->notify();
+        }
+        return;
+    }
+    if (it != shared->handshaking.end()) {
+        shared->handshaking.erase(it); // handshake failed
+        return;
+    }
+    shared->pending.erase(std::remove_if(shared->pending.begin(), shared->pending.end(),
+                                         [comm](const std::shared_ptr<PduComm>& c) { return c.get() == comm; }),
+                          shared->pending.end());
+    auto taken = std::find(shared->taken.begin(), shared->taken.end(), comm);
+    const bool last_taken = taken != shared->taken.end() && shared->taken.size() == 1;
+    if (taken != shared->taken.end()) {
+        shared->taken.erase(taken);
+    }
+    if (shared->connected.load() > 0) {
+        shared->connected.fetch_sub(1);
+    }
+    const bool release = last_taken && shared->closed;
+    lock.unlock();
+    if (release) {
+        shared->release_io(); // the mux is gone; nothing else stops them
+    }
+}
+
+} // namespace comm
+} // namespace pdu
+} // namespace hakoniwa
@@ -1,5 +1,8 @@
 #include "hakoniwa/pdu/endpoint_comm_multiplexer.hpp"
 #include "hakoniwa/pdu/comm/comm_tcp_mux.hpp"
+#include "hakoniwa/pdu/comm/comm_udp_mux.hpp"
+#include "hakoniwa/pdu/comm/comm_websocket_mux.hpp"
+#include "hakoniwa/pdu/comm/packet.hpp"
 #include <nlohmann/json.hpp>
 #include <fstream>
 #include <iostream>
@@ -62,6 +65,19 @@ HakoPduErrorType EndpointCommMultiplexer::open(const std::string& endpoint_mux_c
         return HAKO_PDU_ERR_INVALID_CONFIG;
     }
 
+    std::shared_ptr<PduSharedCache> shared_cache;
+    try {
+        if (config.contains("shared_cache")) {
+            const auto& shared = config.at("shared_cache");
+            if (shared.value("enabled", false)) {
+                shared_cache = std::make_shared<PduSharedCache>(shared.value("per_session", false));
+            }
+        }
+    } catch (const nlohmann::json::exception& e) {
+        std::cerr << "EndpointMux config error: invalid shared_cache: " << e.what() << std::endl;
+        return HAKO_PDU_ERR_INVALID_CONFIG;
+    }
+
     std::string comm_config_path = config["comm"].get<std::string>();
     auto resolved_comm_config_path = resolve_under_base(base_dir_, comm_config_path);
 
@@ -71,13 +87,23 @@ HakoPduErrorType EndpointCommMultiplexer::open(const std::string& endpoint_mux_c
         return HAKO_PDU_ERR_INVALID_CONFIG;
     }
 
+    // Session endpoints are built from this template: no config is read per session.
+    auto endpoint_template = std::make_shared<EndpointTemplate>();
+    err = Endpoint::load_template(endpoint_mux_config_path, *endpoint_template);
+    if (err != HAKO_PDU_ERR_OK) {
+        std::cerr << "EndpointMux failed to load endpoint template: " << static_cast<int>(err) << std::endl;
+        comm_.reset();
+        return err;
+    }
+
     err = comm_->open(resolved_comm_config_path.string());
     if (err != HAKO_PDU_ERR_OK) {
         std::cerr << "Failed to open CommMultiplexer: " << static_cast<int>(err) << std::endl;
         return err;
     }
 
-    endpoint_config_path_ = endpoint_mux_config_path;
+    template_ = std::move(endpoint_template);
+    shared_cache_ = std::move(shared_cache);
     return HAKO_PDU_ERR_OK;
 }
 
@@ -108,7 +134,7 @@ HakoPduErrorType EndpointCommMultiplexer::stop() noexcept
 std::vector<std::unique_ptr<Endpoint>> EndpointCommMultiplexer::take_endpoints()
 {
     std::vector<std::unique_ptr<Endpoint>> endpoints;
-    if (!comm_) {
+    if (!comm_ || !template_) {
         return endpoints;
     }
 
@@ -118,11 +144,17 @@ std::vector<std::unique_ptr<Endpoint>> EndpointCommMultiplexer::take_endpoints()
     }
 
     for (auto& session_comm : sessions) {
-        auto endpoint_name = name_ + "_" + std::to_string(++endpoint_seq_);
+        const uint64_t session_id = ++endpoint_seq_;
+        auto endpoint_name = name_ + "_" + std::to_string(session_id);
         auto endpoint = std::make_unique<Endpoint>(endpoint_name, type_);
+        std::weak_ptr<PduComm> group_member = session_comm;
         endpoint->set_comm(std::move(session_comm));
 
-        HakoPduErrorType err = endpoint->open(endpoint_config_path_);
+        std::unique_ptr<PduCache> session_cache;
+        if (shared_cache_) {
+            session_cache = std::make_unique<PduSharedCacheSession>(shared_cache_, session_id);
+        }
+        HakoPduErrorType err = endpoint->open_from_template(*template_, std::move(session_cache));
         if (err != HAKO_PDU_ERR_OK) {
             std::cerr << "EndpointMux failed to open endpoint: " << static_cast<int>(err) << std::endl;
             continue;
@@ -136,11 +168,72 @@ std::vector<std::unique_ptr<Endpoint>> EndpointCommMultiplexer::take_endpoints()
         (void)endpoint->post_start();
 
         endpoints.push_back(std::move(endpoint));
+        std::lock_guard<std::mutex> lock(group_mutex_);
+        group_.push_back(std::move(group_member));
     }
 
     return endpoints;
 }
 
+HakoPduErrorType EndpointCommMultiplexer::send_to_all(const PduResolvedKey& pdu_key, std::span<const std::byte> data,
+                                                      PduGroupSendResult* result) noexcept
+{
+    PduGroupSendResult counts;
+    PduSharedFrame frame;
+    try {
+        auto encoded = std::make_shared<PduEncodedFrame>();
+        encoded->key = pdu_key;
+        comm::MetaPdu meta;
+        comm::DataPacket::init_meta(meta, pdu_key.robot, static_cast<uint32_t>(pdu_key.channel_id));
+        comm::DataPacket::encode_into(encoded->bytes, meta, data, packet_version_);
+        frame = std::move(encoded);
+    } catch (const std::bad_alloc&) {
+        return HAKO_PDU_ERR_OUT_OF_MEMORY;
+    }
+
+    // Snapshot the live sessions under the lock and send without it: a blocking
+    // session write must not hold up other group sends or take_endpoints().
+    std::vector<std::shared_ptr<PduComm>> sessions;
+    try {
+        std::lock_guard<std::mutex> lock(group_mutex_);
+        sessions.reserve(group_.size());
+        auto out = group_.begin();
+        for (auto it = group_.begin(); it != group_.end(); ++it) {
+            auto session = it->lock();
+            if (!session) {
+                continue; // its endpoint is gone
+            }
+            sessions.push_back(std::move(session));
+            if (out != it) {
+                *out = std::move(*it);
+            }
+            ++out;
+        }
+        group_.erase(out, group_.end());
+    } catch (const std::bad_alloc&) {
+        return HAKO_PDU_ERR_OUT_OF_MEMORY;
+    }
+
+    HakoPduErrorType first_error = HAKO_PDU_ERR_OK;
+    for (const auto& session : sessions) {
+        ++counts.sessions;
+        HakoPduErrorType err = session->send_frame(frame);
+        if (err == HAKO_PDU_ERR_OK) {
+            ++counts.sent;
+        } else {
+            ++counts.failed;
+            if (first_error == HAKO_PDU_ERR_OK) {
+                first_error = err;
+            }
+        }
+    }
+
+    if (result) {
+        *result = counts;
+    }
+    return first_error;
+}
+
 size_t EndpointCommMultiplexer::connected_count() const noexcept
 {
     if (!comm_) {
@@ -165,6 +258,48 @@ bool EndpointCommMultiplexer::is_ready() const noexcept
     return comm_->is_ready();
 }
 
+HakoPduErrorType EndpointCommMultiplexer::get_admission_stats(comm::CommMuxAdmissionStats& stats) const noexcept
+{
+    if (!comm_) {
+        stats = comm::CommMuxAdmissionStats{};
+        return HAKO_PDU_ERR_INVALID_CONFIG;
+    }
+    return comm_->get_admission_stats(stats);
+}
+
+HakoPduErrorType EndpointCommMultiplexer::wait_ready(int timeout_ms) noexcept
+{
+    if (!comm_) {
+        return HAKO_PDU_ERR_INVALID_CONFIG;
+    }
+    return comm_->wait_ready(timeout_ms);
+}
+
+HakoPduErrorType EndpointCommMultiplexer::wait_endpoints(int timeout_ms) noexcept
+{
+    if (!comm_) {
+        return HAKO_PDU_ERR_INVALID_CONFIG;
+    }
+    return comm_->wait_sessions(timeout_ms);
+}
+
+HakoPduErrorType EndpointCommMultiplexer::set_on_session_callback(std::function<void()> callback)
+{
+    if (!comm_) {
+        return HAKO_PDU_ERR_INVALID_CONFIG;
+    }
+    comm_->set_on_session_callback(std::move(callback));
+    return HAKO_PDU_ERR_OK;
+}
+
+int EndpointCommMultiplexer::session_fd() const noexcept
+{
+    if (!comm_) {
+        return -1;
+    }
+    return comm_->session_fd();
+}
+
 std::unique_ptr<comm::CommMultiplexer> EndpointCommMultiplexer::create_comm_mux_(const std::string& comm_config_path)
 {
     std::ifstream config_stream(comm_config_path);
@@ -182,9 +317,18 @@ std::unique_ptr<comm::CommMultiplexer> EndpointCommMultiplexer::create_comm_mux_
         return nullptr;
     }
     const std::string protocol = config_json.at("protocol").get<std::string>();
+    if (config_json.contains("comm_raw_version") && config_json.at("comm_raw_version").is_string()) {
+        packet_version_ = config_json.at("comm_raw_version").get<std::string>();
+    }
     if (protocol == "tcp") {
         return std::make_unique<comm::TcpCommMultiplexer>();
     }
+    if (protocol == "udp") {
+        return std::make_unique<comm::UdpCommMultiplexer>();
+    }
+    if (protocol == "websocket") {
+        return std::make_unique<comm::WebSocketCommMultiplexer>();
+    }
     return nullptr;
 }
 
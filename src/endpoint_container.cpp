@@ -1,9 +1,13 @@
 #include "hakoniwa/pdu/endpoint_container.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <filesystem>
 #include <iostream>
 #include <nlohmann/json.hpp>
+#include <system_error>
+#include <thread>
 
 namespace fs = std::filesystem;
 
@@ -317,27 +321,74 @@ HakoPduErrorType EndpointContainer::stop_all() noexcept
     }
 
     HakoPduErrorType first_err = HAKO_PDU_ERR_OK;
-
-    // Stop+close all endpoints that were created.
+    auto record = [&first_err, this](const std::string& id, const char* what, HakoPduErrorType err) noexcept {
+        if (err == HAKO_PDU_ERR_OK || first_err != HAKO_PDU_ERR_OK) {
+            return;
+        }
+        first_err = err;
+        try {
+            last_error_ = std::string("stop_all: ") + what + " failed at endpoint id=" + id
+                          + " err=" + std::to_string(static_cast<int>(err));
+        } catch (const std::bad_alloc&) {
+        }
+    };
+
+    // Stop+close all endpoints that were created on a pool of at most
+    // hardware_concurrency threads (this one included), each pulling the next
+    // endpoint: stops join comm threads, so they overlap instead of adding up.
+    struct StopResult {
+        const std::string* id;
+        Endpoint* ep;
+        HakoPduErrorType stop_err = HAKO_PDU_ERR_OK;
+        HakoPduErrorType close_err = HAKO_PDU_ERR_OK;
+    };
+    std::vector<StopResult> results;
+    try {
+        results.reserve(cache_.size());
+    } catch (const std::bad_alloc&) {
+        // No room even for the results: stop them one by one on this thread.
+        for (auto& [id, ep] : cache_) {
+            if (ep) {
+                record(id, "stop", ep->stop());
+                record(id, "close", ep->close());
+            }
+        }
+        cache_.clear();
+        initialized_ = false;
+        return first_err;
+    }
     for (auto& [id, ep] : cache_) {
-        if (!ep) { continue; }
-
-        // stop
-        const HakoPduErrorType stop_err = ep->stop();
-        if (stop_err != HAKO_PDU_ERR_OK && first_err == HAKO_PDU_ERR_OK) {
-            first_err = stop_err;
-            last_error_ = "stop_all: stop failed at endpoint id=" + id
-                          + " err=" + std::to_string(static_cast<int>(stop_err));
+        if (ep) {
+            results.push_back(StopResult{&id, ep.get()});
         }
-
-        // close
-        const HakoPduErrorType close_err = ep->close();
-        if (close_err != HAKO_PDU_ERR_OK && first_err == HAKO_PDU_ERR_OK) {
-            first_err = close_err;
-            last_error_ = "stop_all: close failed at endpoint id=" + id
-                          + " err=" + std::to_string(static_cast<int>(close_err));
+    }
+    std::atomic<size_t> next{0};
+    auto drain = [&results, &next]() noexcept {
+        for (size_t i = next.fetch_add(1); i < results.size(); i = next.fetch_add(1)) {
+            results[i].stop_err = results[i].ep->stop();
+            results[i].close_err = results[i].ep->close();
         }
+    };
+    const size_t pool_size =
+        std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), results.size());
+    std::vector<std::thread> workers;
+    try {
+        workers.reserve(pool_size);
+        for (size_t i = 1; i < pool_size; ++i) {
+            workers.emplace_back(drain);
+        }
+    } catch (const std::system_error&) {
+        // Could not spawn: this thread and the workers started so far finish the rest.
+    } catch (const std::bad_alloc&) {
+    }
+    drain();
+    for (auto& w : workers) {
+        w.join();
+    }
 
+    for (const auto& r : results) {
+        record(*r.id, "stop", r.stop_err);
+        record(*r.id, "close", r.close_err);
     }
 
     // Optional: clear cache to allow clean re-create later.
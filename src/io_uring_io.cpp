@@ -0,0 +1,472 @@
+#include "hakoniwa/pdu/comm/io_uring_io.hpp"
+#include "hakoniwa/pdu/socket_utils.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <poll.h>
+
+#ifdef HAKO_PDU_ENDPOINT_HAS_IO_URING
+#include <liburing.h>
+#endif
+
+namespace hakoniwa {
+namespace pdu {
+namespace comm {
+
+HakoPduErrorType parse_io_backend_options(const nlohmann::json& options, bool& use_io_uring,
+                                          IoUringIo::Options& uring_options)
+{
+    use_io_uring = false;
+    const std::string backend = options.value("io_backend", std::string("socket"));
+    if (backend == "socket") {
+        return HAKO_PDU_ERR_OK;
+    }
+    if (backend != "io_uring") {
+        std::cerr << "Comm config error: unknown io_backend '" << backend << "'." << std::endl;
+        return HAKO_PDU_ERR_INVALID_ARGUMENT;
+    }
+    use_io_uring = true;
+    if (options.contains("io_uring")) {
+        const auto& uring = options.at("io_uring");
+        uring_options.queue_depth = uring.value("queue_depth", uring_options.queue_depth);
+        uring_options.buffer_count = uring.value("buffer_count", uring_options.buffer_count);
+        uring_options.buffer_size = uring.value("buffer_size", uring_options.buffer_size);
+    }
+    return HAKO_PDU_ERR_OK;
+}
+
+#ifdef HAKO_PDU_ENDPOINT_HAS_IO_URING
+
+namespace {
+constexpr int kBufferGroupId = 0;
+constexpr uint64_t kRecvTag = 1;
+constexpr uint64_t kCancelTag = 2;
+constexpr uint64_t kWakeTag = 3;
+constexpr uint64_t kSendTagBase = 0x100;
+
+unsigned round_up_pow2(unsigned value) noexcept
+{
+    unsigned result = 1;
+    while (result < value && result < 32768) {
+        result <<= 1;
+    }
+    return result;
+}
+} // namespace
+
+struct IoUringIo::Impl {
+    io_uring ring{};
+    bool ring_ready = false;
+    Options options{};
+
+    // Provided-buffer ring registered with the kernel for multishot receive.
+    io_uring_buf_ring* buf_ring = nullptr;
+    int buf_mask = 0;
+    std::vector<std::byte> buffers;
+    msghdr recv_msg{};
+    bool recv_armed = false;
+    bool wake_armed = false;
+
+    std::vector<iovec> send_iov;
+    std::vector<msghdr> send_msg;
+    std::vector<int> send_results;
+
+    std::byte* buffer_at(unsigned bid) noexcept
+    {
+        return buffers.data() + static_cast<size_t>(bid) * options.buffer_size;
+    }
+
+    void recycle(unsigned bid) noexcept
+    {
+        io_uring_buf_ring_add(buf_ring, buffer_at(bid), static_cast<unsigned>(options.buffer_size),
+                              static_cast<unsigned short>(bid), buf_mask, 0);
+        io_uring_buf_ring_advance(buf_ring, 1);
+    }
+
+    bool arm_recv(int fd, bool datagram) noexcept
+    {
+        io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+        if (!sqe) {
+            return false;
+        }
+        if (datagram) {
+            io_uring_prep_recvmsg_multishot(sqe, fd, &recv_msg, 0);
+        } else {
+            io_uring_prep_recv_multishot(sqe, fd, nullptr, 0, 0);
+        }
+        sqe->flags |= IOSQE_BUFFER_SELECT;
+        sqe->buf_group = kBufferGroupId;
+        io_uring_sqe_set_data64(sqe, kRecvTag);
+        recv_armed = io_uring_submit(&ring) >= 0;
+        return recv_armed;
+    }
+
+    bool arm_wakeup(int wakeup_fd) noexcept
+    {
+        io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+        if (!sqe) {
+            return false;
+        }
+        io_uring_prep_poll_add(sqe, wakeup_fd, POLLIN);
+        io_uring_sqe_set_data64(sqe, kWakeTag);
+        wake_armed = io_uring_submit(&ring) >= 0;
+        return wake_armed;
+    }
+
+    // Cancel the armed multishot receive / wakeup poll and drain them, returning buffers.
+    void cancel_pending() noexcept
+    {
+        if (recv_armed) {
+            io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+            if (sqe) {
+                io_uring_prep_cancel64(sqe, kRecvTag, 0);
+                io_uring_sqe_set_data64(sqe, kCancelTag);
+            }
+        }
+        if (wake_armed) {
+            io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+            if (sqe) {
+                io_uring_prep_poll_remove(sqe, kWakeTag);
+                io_uring_sqe_set_data64(sqe, kCancelTag);
+            }
+        }
+        (void)io_uring_submit(&ring);
+        for (int i = 0; i < 64 && (recv_armed || wake_armed); ++i) {
+            io_uring_cqe* cqe = nullptr;
+            __kernel_timespec ts{};
+            ts.tv_nsec = 100 * 1000 * 1000;
+            if (io_uring_wait_cqe_timeout(&ring, &cqe, &ts) != 0) {
+                break;
+            }
+            const uint64_t tag = io_uring_cqe_get_data64(cqe);
+            const unsigned flags = cqe->flags;
+            io_uring_cqe_seen(&ring, cqe);
+            if (flags & IORING_CQE_F_BUFFER) {
+                recycle(flags >> IORING_CQE_BUFFER_SHIFT);
+            }
+            if (tag == kRecvTag && !(flags & IORING_CQE_F_MORE)) {
+                recv_armed = false;
+            } else if (tag == kWakeTag) {
+                wake_armed = false;
+            }
+        }
+        recv_armed = false;
+        wake_armed = false;
+    }
+};
+
+IoUringIo::IoUringIo() = default;
+IoUringIo::~IoUringIo() { shutdown(); }
+
+bool IoUringIo::is_compiled_in() noexcept { return true; }
+
+HakoPduErrorType IoUringIo::init(const Options& options, bool with_recv_buffers) noexcept
+{
+    shutdown();
+    if (options.queue_depth == 0 || options.buffer_count == 0 || options.buffer_size == 0) {
+        return HAKO_PDU_ERR_INVALID_ARGUMENT;
+    }
+    try {
+        impl_ = std::make_unique<Impl>();
+        impl_->options = options;
+        impl_->options.buffer_count = round_up_pow2(options.buffer_count);
+        impl_->send_iov.resize(options.queue_depth);
+        impl_->send_msg.resize(options.queue_depth);
+        impl_->send_results.resize(options.queue_depth);
+    } catch (const std::bad_alloc&) {
+        impl_.reset();
+        return HAKO_PDU_ERR_OUT_OF_MEMORY;
+    }
+    Impl& im = *impl_;
+
+    int ret = io_uring_queue_init(im.options.queue_depth, &im.ring, 0);
+    if (ret < 0) {
+        std::cerr << "io_uring setup failed: " << std::strerror(-ret) << std::endl;
+        impl_.reset();
+        return HAKO_PDU_ERR_UNSUPPORTED;
+    }
+    im.ring_ready = true;
+
+    if (with_recv_buffers) {
+        const unsigned count = im.options.buffer_count;
+        try {
+            im.buffers.resize(static_cast<size_t>(count) * im.options.buffer_size);
+        } catch (const std::bad_alloc&) {
+            shutdown();
+            return HAKO_PDU_ERR_OUT_OF_MEMORY;
+        }
+        int err = 0;
+        im.buf_ring = io_uring_setup_buf_ring(&im.ring, count, kBufferGroupId, 0, &err);
+        if (!im.buf_ring) {
+            std::cerr << "io_uring buffer ring setup failed: " << std::strerror(-err) << std::endl;
+            shutdown();
+            return HAKO_PDU_ERR_UNSUPPORTED;
+        }
+        im.buf_mask = io_uring_buf_ring_mask(count);
+        for (unsigned bid = 0; bid < count; ++bid) {
+            io_uring_buf_ring_add(im.buf_ring, im.buffer_at(bid), static_cast<unsigned>(im.options.buffer_size),
+                                  static_cast<unsigned short>(bid), im.buf_mask, static_cast<int>(bid));
+        }
+        io_uring_buf_ring_advance(im.buf_ring, static_cast<int>(count));
+        im.recv_msg.msg_namelen = sizeof(sockaddr_storage);
+    }
+    return HAKO_PDU_ERR_OK;
+}
+
+void IoUringIo::shutdown() noexcept
+{
+    if (!impl_) {
+        return;
+    }
+    if (impl_->buf_ring) {
+        (void)io_uring_free_buf_ring(&impl_->ring, impl_->buf_ring, impl_->options.buffer_count, kBufferGroupId);
+        impl_->buf_ring = nullptr;
+    }
+    if (impl_->ring_ready) {
+        io_uring_queue_exit(&impl_->ring);
+        impl_->ring_ready = false;
+    }
+    impl_.reset();
+}
+
+bool IoUringIo::is_initialized() const noexcept
+{
+    return impl_ && impl_->ring_ready;
+}
+
+HakoPduErrorType IoUringIo::run_recv(int fd, bool datagram, const std::atomic<bool>& running,
+                                     int poll_interval_ms, const RecvHandler& on_data,
+                                     int wakeup_fd, const std::function<void()>& on_idle) noexcept
+{
+    if (!is_initialized() || !impl_->buf_ring || fd < 0) {
+        return HAKO_PDU_ERR_INVALID_ARGUMENT;
+    }
+    Impl& im = *impl_;
+    if (wakeup_fd >= 0 && !im.arm_wakeup(wakeup_fd)) {
+        return HAKO_PDU_ERR_IO_ERROR;
+    }
+    if (!im.arm_recv(fd, datagram)) {
+        im.cancel_pending();
+        return HAKO_PDU_ERR_IO_ERROR;
+    }
+
+    bool received_any = false;
+    HakoPduErrorType result = HAKO_PDU_ERR_OK;
+    while (running.load()) {
+        io_uring_cqe* cqe = nullptr;
+        __kernel_timespec ts{};
+        ts.tv_sec = poll_interval_ms / 1000;
+        ts.tv_nsec = static_cast<long long>(poll_interval_ms % 1000) * 1000 * 1000;
+        int ret = io_uring_wait_cqe_timeout(&im.ring, &cqe, &ts);
+        if (ret == -ETIME && on_idle) {
+            on_idle();
+        }
+        if (ret == -ETIME || ret == -EINTR) {
+            continue;
+        }
+        if (ret < 0) {
+            result = HAKO_PDU_ERR_IO_ERROR;
+            break;
+        }
+        const uint64_t tag = io_uring_cqe_get_data64(cqe);
+        const int res = cqe->res;
+        const unsigned flags = cqe->flags;
+        io_uring_cqe_seen(&im.ring, cqe);
+
+        const bool has_buffer = (flags & IORING_CQE_F_BUFFER) != 0;
+        const unsigned bid = flags >> IORING_CQE_BUFFER_SHIFT;
+        if (tag == kWakeTag) {
+            im.wake_armed = false;
+            break; // stop requested
+        }
+        if (tag != kRecvTag) {
+            if (has_buffer) {
+                im.recycle(bid);
+            }
+            continue;
+        }
+        const bool more = (flags & IORING_CQE_F_MORE) != 0;
+        if (!more) {
+            im.recv_armed = false;
+        }
+
+        if (res < 0) {
+            if (has_buffer) {
+                im.recycle(bid);
+            }
+            if (res == -ENOBUFS) {
+                if (!more && !im.arm_recv(fd, datagram)) {
+                    result = HAKO_PDU_ERR_IO_ERROR;
+                    break;
+                }
+                continue;
+            }
+            if (!received_any && (res == -EINVAL || res == -EOPNOTSUPP)) {
+                result = HAKO_PDU_ERR_UNSUPPORTED;
+                break;
+            }
+            if (running.load()) {
+                std::cerr << "io_uring recv failed: " << std::strerror(-res) << std::endl;
+                result = map_errno_to_error(-res);
+            }
+            break;
+        }
+        if (res == 0 && !datagram) {
+            if (has_buffer) {
+                im.recycle(bid);
+            }
+            result = HAKO_PDU_ERR_IO_ERROR; // peer closed
+            break;
+        }
+
+        if (has_buffer) {
+            std::byte* buf = im.buffer_at(bid);
+            if (datagram) {
+                io_uring_recvmsg_out* out = io_uring_recvmsg_validate(buf, res, &im.recv_msg);
+                if (out) {
+                    if (out->flags & MSG_TRUNC) {
+                        std::cerr << "io_uring recv: datagram truncated (buffer_size too small)." << std::endl;
+                    } else {
+                        const auto* payload = static_cast<const std::byte*>(io_uring_recvmsg_payload(out, &im.recv_msg));
+                        const unsigned payload_len = io_uring_recvmsg_payload_length(out, res, &im.recv_msg);
+                        const socklen_t name_len = static_cast<socklen_t>(
+                            std::min<uint32_t>(out->namelen, sizeof(sockaddr_storage)));
+                        on_data(std::span<const std::byte>(payload, payload_len),
+                                static_cast<const sockaddr*>(io_uring_recvmsg_name(out)), name_len);
+                    }
+                }
+            } else {
+                on_data(std::span<const std::byte>(buf, static_cast<size_t>(res)), nullptr, 0);
+            }
+            received_any = true;
+            im.recycle(bid);
+        }
+
+        if (!more && running.load() && !im.arm_recv(fd, datagram)) {
+            result = HAKO_PDU_ERR_IO_ERROR;
+            break;
+        }
+    }
+    if (im.recv_armed || im.wake_armed) {
+        im.cancel_pending();
+    }
+    return result;
+}
+
+HakoPduErrorType IoUringIo::send_batch(int fd, std::span<const std::vector<std::byte>> frames,
+                                       const sockaddr* to, socklen_t to_len, bool datagram) noexcept
+{
+    if (!is_initialized() || fd < 0) {
+        return HAKO_PDU_ERR_INVALID_ARGUMENT;
+    }
+    Impl& im = *impl_;
+    size_t index = 0;
+    size_t offset = 0; // resume point inside frames[index] after a short stream write
+    while (index < frames.size()) {
+        const size_t count = std::min<size_t>(frames.size() - index, im.options.queue_depth);
+        unsigned queued = 0;
+        for (size_t i = 0; i < count; ++i) {
+            io_uring_sqe* sqe = io_uring_get_sqe(&im.ring);
+            if (!sqe) {
+                break;
+            }
+            const auto& frame = frames[index + i];
+            const size_t skip = (i == 0) ? offset : 0;
+            if (datagram) {
+                iovec& iov = im.send_iov[i];
+                iov.iov_base = const_cast<std::byte*>(frame.data());
+                iov.iov_len = frame.size();
+                msghdr& msg = im.send_msg[i];
+                msg = msghdr{};
+                msg.msg_name = const_cast<sockaddr*>(to);
+                msg.msg_namelen = to ? to_len : 0;
+                msg.msg_iov = &iov;
+                msg.msg_iovlen = 1;
+                io_uring_prep_sendmsg(sqe, fd, &msg, 0);
+            } else {
+                io_uring_prep_send(sqe, fd, frame.data() + skip, frame.size() - skip, MSG_NOSIGNAL | MSG_WAITALL);
+                if (i + 1 < count) {
+                    sqe->flags |= IOSQE_IO_LINK; // keep stream order
+                }
+            }
+            io_uring_sqe_set_data64(sqe, kSendTagBase + i);
+            ++queued;
+        }
+        if (queued == 0) {
+            return HAKO_PDU_ERR_BUSY;
+        }
+        int ret = io_uring_submit_and_wait(&im.ring, queued);
+        if (ret < 0) {
+            return map_errno_to_error(-ret);
+        }
+        unsigned completed = 0;
+        while (completed < queued) {
+            io_uring_cqe* cqe = nullptr;
+            if (io_uring_wait_cqe(&im.ring, &cqe) != 0) {
+                return HAKO_PDU_ERR_IO_ERROR;
+            }
+            const uint64_t tag = io_uring_cqe_get_data64(cqe);
+            if (tag >= kSendTagBase && tag < kSendTagBase + queued) {
+                im.send_results[tag - kSendTagBase] = cqe->res;
+                ++completed;
+            }
+            io_uring_cqe_seen(&im.ring, cqe);
+        }
+        for (unsigned i = 0; i < queued; ++i) {
+            const int res = im.send_results[i];
+            const size_t expected = frames[index].size() - offset;
+            if (res == -ECANCELED && !datagram) {
+                break; // chain cut by an earlier failure; resubmit from here
+            }
+            if (res < 0) {
+                std::cerr << "io_uring send failed: " << std::strerror(-res) << std::endl;
+                return map_errno_to_error(-res);
+            }
+            if (datagram || static_cast<size_t>(res) >= expected) {
+                ++index;
+                offset = 0;
+                continue;
+            }
+            offset += static_cast<size_t>(res);
+            break;
+        }
+    }
+    return HAKO_PDU_ERR_OK;
+}
+
+#else // !HAKO_PDU_ENDPOINT_HAS_IO_URING
+
+struct IoUringIo::Impl {};
+
+IoUringIo::IoUringIo() = default;
+IoUringIo::~IoUringIo() = default;
+
+bool IoUringIo::is_compiled_in() noexcept { return false; }
+
+HakoPduErrorType IoUringIo::init(const Options&, bool) noexcept
+{
+    return HAKO_PDU_ERR_UNSUPPORTED;
+}
+
+void IoUringIo::shutdown() noexcept {}
+
+bool IoUringIo::is_initialized() const noexcept { return false; }
+
+HakoPduErrorType IoUringIo::run_recv(int, bool, const std::atomic<bool>&, int, const RecvHandler&, int,
+                                     const std::function<void()>&) noexcept
+{
+    return HAKO_PDU_ERR_UNSUPPORTED;
+}
+
+HakoPduErrorType IoUringIo::send_batch(int, std::span<const std::vector<std::byte>>, const sockaddr*, socklen_t, bool) noexcept
+{
+    return HAKO_PDU_ERR_UNSUPPORTED;
+}
+
+#endif // HAKO_PDU_ENDPOINT_HAS_IO_URING
+
+} // namespace comm
+} // namespace pdu
+} // namespace hakoniwa
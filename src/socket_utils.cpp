@@ -1,6 +1,15 @@
 #include "hakoniwa/pdu/socket_utils.hpp"
 
 #include <netdb.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#endif
 
 namespace hakoniwa {
 namespace pdu {
@@ -44,5 +53,112 @@ HakoPduErrorType resolve_address(const nlohmann::json& endpoint_json, int socket
     return HAKO_PDU_ERR_OK;
 }
 
+HakoPduErrorType WakeupFd::open() noexcept
+{
+    if (read_fd_ >= 0) {
+        return HAKO_PDU_ERR_OK;
+    }
+#if defined(__linux__)
+    int fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0) {
+        return map_errno_to_error(errno);
+    }
+    read_fd_ = fd;
+    write_fd_ = fd;
+#else
+    int fds[2] = {-1, -1};
+    if (::pipe(fds) != 0) {
+        return map_errno_to_error(errno);
+    }
+    for (int fd : fds) {
+        int flags = fcntl(fd, F_GETFL, 0);
+        (void)fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+        (void)fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    read_fd_ = fds[0];
+    write_fd_ = fds[1];
+#endif
+    return HAKO_PDU_ERR_OK;
+}
+
+void WakeupFd::close() noexcept
+{
+    if (write_fd_ >= 0 && write_fd_ != read_fd_) {
+        ::close(write_fd_);
+    }
+    if (read_fd_ >= 0) {
+        ::close(read_fd_);
+    }
+    read_fd_ = -1;
+    write_fd_ = -1;
+}
+
+void WakeupFd::notify() noexcept
+{
+    if (write_fd_ < 0) {
+        return;
+    }
+#if defined(__linux__)
+    uint64_t one = 1;
+    (void)!::write(write_fd_, &one, sizeof(one));
+#else
+    char one = 1;
+    (void)!::write(write_fd_, &one, sizeof(one));
+#endif
+}
+
+void WakeupFd::drain() noexcept
+{
+    if (read_fd_ < 0) {
+        return;
+    }
+    char buf[64];
+    while (::read(read_fd_, buf, sizeof(buf)) > 0) {
+    }
+}
+
+HakoPduErrorType poll_with_wakeup(int fd, short events, const WakeupFd& wakeup, int timeout_ms) noexcept
+{
+    pollfd fds[2]{};
+    nfds_t count = 0;
+    int fd_index = -1;
+    if (fd >= 0) {
+        fds[count].fd = fd;
+        fds[count].events = events;
+        fd_index = static_cast<int>(count++);
+    }
+    int wakeup_index = -1;
+    if (wakeup.fd() >= 0) {
+        fds[count].fd = wakeup.fd();
+        fds[count].events = POLLIN;
+        wakeup_index = static_cast<int>(count++);
+    }
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (true) {
+        int wait_ms = timeout_ms;
+        if (timeout_ms > 0) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            wait_ms = left.count() > 0 ? static_cast<int>(left.count()) : 0;
+        }
+        int ret = ::poll(fds, count, wait_ms);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return map_errno_to_error(errno);
+        }
+        if (ret == 0) {
+            return HAKO_PDU_ERR_TIMEOUT;
+        }
+        if (wakeup_index >= 0 && (fds[wakeup_index].revents & POLLIN)) {
+            return HAKO_PDU_ERR_NOT_RUNNING;
+        }
+        if (fd_index >= 0 && fds[fd_index].revents != 0) {
+            // POLLERR/POLLHUP also count as ready: the next I/O call reports them.
+            return HAKO_PDU_ERR_OK;
+        }
+    }
+}
+
 }  // namespace pdu
 }  // namespace hakoniwa
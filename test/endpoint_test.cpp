@@ -9,11 +9,59 @@
 #include <nlohmann/json.hpp>
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <poll.h>
 #include <iostream>
 #include <cerrno>
 #include <cstring>
 #include "hakoniwa/pdu/comm/packet.hpp"
 #include "hakoniwa/pdu/endpoint_comm_multiplexer.hpp"
+#include "hakoniwa/pdu/comm/comm_tcp.hpp"
+#include "hakoniwa/pdu/comm/comm_udp.hpp"
+#include "hakoniwa/pdu/comm/comm_websocket.hpp"
+#include <mutex>
+#include <atomic>
+#include <map>
+#include <algorithm>
+#include <filesystem>
+#include <cstdlib>
+#include <new>
+
+// Allocations made by the calling thread, for tests that check a hot path
+// does not allocate (WebSocketInPlaceDecodeNoAllocTest).
+namespace {
+    thread_local uint64_t t_thread_allocations = 0;
+}
+
+void* operator new(std::size_t size)
+{
+    ++t_thread_allocations;
+    if (void* p = std::malloc(size != 0 ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+// Replaced too, so every form pairs with the free()-based delete below.
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    ++t_thread_allocations;
+    return std::malloc(size != 0 ? size : 1);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
 
 // Test Utilities
 namespace {
@@ -307,6 +355,126 @@ TEST_F(EndpointTest, TcpCommunicationV1Test) {
     ASSERT_EQ(client.close(), HAKO_PDU_ERR_OK);
 }
 
+TEST_F(EndpointTest, TcpClientResyncOnReconnectTest) {
+    hakoniwa::pdu::Endpoint client("tcp_client_resync", HAKO_PDU_ENDPOINT_DIRECTION_OUT);
+    ASSERT_EQ(client.open("test/test_endpoint_tcp_client_resync.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client.start(), HAKO_PDU_ERR_OK);
+
+    // Published while no server is up: the sends fail but the values are kept.
+    auto pose_key = create_key("robot_resync", 1);
+    auto status_key = create_key("robot_resync", 2);
+    std::vector<std::byte> pose_msg = {(std::byte)'p', (std::byte)'o', (std::byte)'s', (std::byte)'e'};
+    std::vector<std::byte> status_msg = {(std::byte)'o', (std::byte)'k'};
+    (void)client.send(pose_key, pose_msg);
+    (void)client.send(status_key, status_msg);
+
+    auto wait_recv = [](hakoniwa::pdu::Endpoint& ep, const hakoniwa::pdu::PduResolvedKey& key,
+                        const std::vector<std::byte>& expected) {
+        std::vector<std::byte> buf(16);
+        size_t len = 0;
+        for (int i = 0; i < 100; ++i) {
+            if (ep.recv(key, buf, len) == HAKO_PDU_ERR_OK) {
+                buf.resize(len);
+                return buf == expected;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return false;
+    };
+
+    for (int round = 0; round < 2; ++round) {
+        // Server (re)start: the client reconnects and replays its latest values.
+        hakoniwa::pdu::Endpoint server("tcp_server_resync", HAKO_PDU_ENDPOINT_DIRECTION_IN);
+        ASSERT_EQ(server.open("test/test_endpoint_tcp_server_resync.json"), HAKO_PDU_ERR_OK);
+        ASSERT_EQ(server.start(), HAKO_PDU_ERR_OK);
+        EXPECT_TRUE(wait_recv(server, pose_key, pose_msg)) << "round " << round;
+        EXPECT_TRUE(wait_recv(server, status_key, status_msg)) << "round " << round;
+        ASSERT_EQ(server.stop(), HAKO_PDU_ERR_OK);
+        ASSERT_EQ(server.close(), HAKO_PDU_ERR_OK);
+    }
+
+    ASSERT_EQ(client.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client.close(), HAKO_PDU_ERR_OK);
+}
+
+TEST_F(EndpointTest, TcpClientResyncRacingSendTest) {
+    // A value sent while the client reconnects must not be overwritten on the
+    // server by the older replayed snapshot.
+    hakoniwa::pdu::Endpoint client("tcp_client_resync", HAKO_PDU_ENDPOINT_DIRECTION_OUT);
+    ASSERT_EQ(client.open("test/test_endpoint_tcp_client_resync.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client.start(), HAKO_PDU_ERR_OK);
+    auto key = create_key("robot_resync", 1);
+    auto encode = [](uint32_t v) {
+        std::vector<std::byte> msg(sizeof(v));
+        std::memcpy(msg.data(), &v, sizeof(v));
+        return msg;
+    };
+    (void)client.send(key, encode(0));
+
+    for (int round = 0; round < 3; ++round) {
+        hakoniwa::pdu::Endpoint server("tcp_server_resync", HAKO_PDU_ENDPOINT_DIRECTION_IN);
+        ASSERT_EQ(server.open("test/test_endpoint_tcp_server_resync.json"), HAKO_PDU_ERR_OK);
+        std::atomic<bool> arrived{false};
+        server.subscribe_on_recv_callback(key, [&arrived](const hakoniwa::pdu::PduResolvedKey&, std::span<const std::byte>) {
+            arrived = true;
+        });
+        ASSERT_EQ(server.start(), HAKO_PDU_ERR_OK);
+        // Publish new values until the first frame of the new connection lands
+        // (replay or one of these), then a few more around the replay.
+        uint32_t last = 0;
+        for (uint32_t v = 1; v < 5000; ++v) {
+            (void)client.send(key, encode(v));
+            last = v;
+            if (arrived.load() && v % 8 == 0) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        ASSERT_TRUE(arrived.load()) << "round " << round;
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        std::vector<std::byte> buf(16);
+        size_t len = 0;
+        ASSERT_EQ(server.recv(key, buf, len), HAKO_PDU_ERR_OK);
+        buf.resize(len);
+        EXPECT_EQ(buf, encode(last)) << "round " << round;
+        ASSERT_EQ(server.stop(), HAKO_PDU_ERR_OK);
+        ASSERT_EQ(server.close(), HAKO_PDU_ERR_OK);
+    }
+
+    ASSERT_EQ(client.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client.close(), HAKO_PDU_ERR_OK);
+}
+
+TEST_F(EndpointTest, StopLatencyTest) {
+    // Idle UDP receiver (1 s timeout), TCP server blocked in accept, and a TCP
+    // client sleeping in a 5 s reconnect backoff must all stop promptly.
+    hakoniwa::pdu::Endpoint udp_server("udp_stop", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+    hakoniwa::pdu::Endpoint tcp_server("tcp_server_stop", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+    hakoniwa::pdu::Endpoint tcp_client("tcp_client_stop", HAKO_PDU_ENDPOINT_DIRECTION_OUT);
+    ASSERT_EQ(udp_server.open("test/test_endpoint_udp_server.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(tcp_server.open("test/test_endpoint_tcp_server.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(tcp_client.open("test/test_endpoint_tcp_client_backoff.json"), HAKO_PDU_ERR_OK);
+
+    for (int round = 0; round < 2; ++round) {
+        // Second round checks that a stopped comm can be restarted.
+        for (auto* ep : {&udp_server, &tcp_server, &tcp_client}) {
+            ASSERT_EQ(ep->start(), HAKO_PDU_ERR_OK) << ep->get_name() << " round " << round;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        for (auto* ep : {&udp_server, &tcp_server, &tcp_client}) {
+            const auto begin = std::chrono::steady_clock::now();
+            ASSERT_EQ(ep->stop(), HAKO_PDU_ERR_OK);
+            const auto elapsed = std::chrono::steady_clock::now() - begin;
+            EXPECT_LT(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count(), 100)
+                << ep->get_name() << " round " << round;
+        }
+    }
+
+    ASSERT_EQ(udp_server.close(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(tcp_server.close(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(tcp_client.close(), HAKO_PDU_ERR_OK);
+}
+
 TEST_F(EndpointTest, TcpMuxTwoClientsTest) {
     hakoniwa::pdu::EndpointCommMultiplexer mux("tcp_mux", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
     ASSERT_EQ(mux.open("test/mux/endpoint_tcp_mux.json"), HAKO_PDU_ERR_OK);
@@ -399,126 +567,1515 @@ TEST_F(EndpointTest, TcpMuxTwoClientsTest) {
     ASSERT_EQ(mux.close(), HAKO_PDU_ERR_OK);
 }
 
-TEST_F(EndpointTest, UdpCommunicationTest) {
-    int server_port = find_available_port(SOCK_DGRAM);
-    ASSERT_GT(server_port, 0);
+TEST_F(EndpointTest, TcpMuxWaitReadyTest) {
+    hakoniwa::pdu::EndpointCommMultiplexer mux("tcp_mux_wait", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+    ASSERT_EQ(mux.open("test/mux/endpoint_tcp_mux.json"), HAKO_PDU_ERR_OK);
+    EXPECT_EQ(mux.wait_ready(-1), HAKO_PDU_ERR_NOT_RUNNING); // not started yet
+    std::atomic<int> arrivals{0};
+    ASSERT_EQ(mux.set_on_session_callback([&arrivals]() { arrivals.fetch_add(1); }), HAKO_PDU_ERR_OK);
+    ASSERT_GE(mux.session_fd(), 0);
+    ASSERT_EQ(mux.start(), HAKO_PDU_ERR_OK);
+    EXPECT_EQ(mux.wait_ready(0), HAKO_PDU_ERR_TIMEOUT);
 
+    hakoniwa::pdu::Endpoint client1("tcp_mux_wait_client1", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+    hakoniwa::pdu::Endpoint client2("tcp_mux_wait_client2", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+    ASSERT_EQ(client1.open("test/mux/endpoint_tcp_mux_client1.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client2.open("test/mux/endpoint_tcp_mux_client2.json"), HAKO_PDU_ERR_OK);
+    std::thread connector([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        (void)client1.start();
+        (void)client2.start();
+    });
+    EXPECT_EQ(mux.wait_ready(3000), HAKO_PDU_ERR_OK);
+    connector.join();
+    EXPECT_EQ(arrivals.load(), 2);
+
+    pollfd pfd{mux.session_fd(), POLLIN, 0};
+    EXPECT_EQ(::poll(&pfd, 1, 0), 1);
+    ASSERT_EQ(mux.wait_endpoints(0), HAKO_PDU_ERR_OK);
+    auto endpoints = mux.take_endpoints();
+    EXPECT_EQ(endpoints.size(), 2u);
+    EXPECT_EQ(::poll(&pfd, 1, 0), 0);
+    EXPECT_EQ(mux.wait_endpoints(0), HAKO_PDU_ERR_TIMEOUT);
+
+    // stop() releases a blocked waiter.
+    HakoPduErrorType waited = HAKO_PDU_ERR_OK;
+    std::thread waiter([&]() { waited = mux.wait_endpoints(-1); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_EQ(mux.stop(), HAKO_PDU_ERR_OK);
+    waiter.join();
+    EXPECT_EQ(waited, HAKO_PDU_ERR_NOT_RUNNING);
+    // ...and a wait started after stop() does not block.
+    EXPECT_EQ(mux.wait_endpoints(-1), HAKO_PDU_ERR_NOT_RUNNING);
 
-    hakoniwa::pdu::Endpoint server("udp_server", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
-    hakoniwa::pdu::Endpoint client("udp_client", HAKO_PDU_ENDPOINT_DIRECTION_OUT);
+    for (auto& ep : endpoints) {
+        ASSERT_EQ(ep->stop(), HAKO_PDU_ERR_OK);
+        ASSERT_EQ(ep->close(), HAKO_PDU_ERR_OK);
+    }
+    ASSERT_EQ(client1.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client2.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client1.close(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client2.close(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(mux.close(), HAKO_PDU_ERR_OK);
+}
 
-    ASSERT_EQ(server.open("test/test_endpoint_udp_server.json"), HAKO_PDU_ERR_OK);
-    ASSERT_EQ(client.open("test/test_endpoint_udp_client.json"), HAKO_PDU_ERR_OK);
-    ASSERT_EQ(server.start(), HAKO_PDU_ERR_OK);
-    ASSERT_EQ(client.start(), HAKO_PDU_ERR_OK);
-    
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+TEST_F(EndpointTest, TcpMuxSharedCacheTest) {
+    hakoniwa::pdu::EndpointCommMultiplexer mux("tcp_mux_shared", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+    ASSERT_EQ(mux.open("test/mux/endpoint_tcp_mux_shared.json"), HAKO_PDU_ERR_OK);
+    auto shared = mux.shared_cache();
+    ASSERT_NE(shared, nullptr);
+    EXPECT_TRUE(shared->per_session());
+    ASSERT_EQ(mux.start(), HAKO_PDU_ERR_OK);
 
-    auto key = create_key("robot_udp", 20);
-    std::vector<std::byte> client_msg = {(std::byte)'h', (std::byte)'e', (std::byte)'l', (std::byte)'l', (std::byte)'o'};
+    hakoniwa::pdu::Endpoint client1("tcp_mux_shared_client1", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+    hakoniwa::pdu::Endpoint client2("tcp_mux_shared_client2", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+    ASSERT_EQ(client1.open("test/mux/endpoint_tcp_mux_client1.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client2.open("test/mux/endpoint_tcp_mux_client2.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client1.start(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client2.start(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(mux.wait_ready(3000), HAKO_PDU_ERR_OK);
+    auto endpoints = mux.take_endpoints();
+    ASSERT_EQ(endpoints.size(), 2u);
 
-    ASSERT_EQ(client.send(key, client_msg), HAKO_PDU_ERR_OK);
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    // Both clients publish the same PDU; the aggregator sees one slot per session.
+    auto key = create_key("robot_shared", 201);
+    std::vector<std::byte> msg1 = {(std::byte)'s', (std::byte)'1'};
+    std::vector<std::byte> msg2 = {(std::byte)'s', (std::byte)'2', (std::byte)'!'};
+    ASSERT_EQ(client1.send(key, msg1), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client2.send(key, msg2), HAKO_PDU_ERR_OK);
+    std::vector<hakoniwa::pdu::PduSharedCacheEntry> entries;
+    for (int attempt = 0; attempt < 40 && entries.size() < 2; ++attempt) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(25));
+        ASSERT_EQ(shared->snapshot(entries), HAKO_PDU_ERR_OK);
+    }
+    ASSERT_EQ(entries.size(), 2u);
+    EXPECT_NE(entries[0].session_id, entries[1].session_id);
+    std::vector<std::vector<std::byte>> values = {entries[0].data, entries[1].data};
+    std::sort(values.begin(), values.end());
+    EXPECT_EQ(values[0], msg1);
+    EXPECT_EQ(values[1], msg2);
+
+    // A session endpoint still reads its own client's value.
+    for (auto& ep : endpoints) {
+        std::vector<std::byte> buf(16);
+        size_t len = 0;
+        ASSERT_EQ(ep->recv(key, buf, len), HAKO_PDU_ERR_OK);
+        buf.resize(len);
+        EXPECT_TRUE(buf == msg1 || buf == msg2);
+    }
 
-    std::vector<std::byte> server_buf(20);
-    size_t server_len = 0;
-    ASSERT_EQ(server.recv(key, server_buf, server_len), HAKO_PDU_ERR_OK);
-    ASSERT_EQ(server_len, client_msg.size());
-    server_buf.resize(server_len);
-    EXPECT_EQ(server_buf, client_msg);
-    
-    ASSERT_EQ(server.stop(), HAKO_PDU_ERR_OK);
-    ASSERT_EQ(client.stop(), HAKO_PDU_ERR_OK);
-    ASSERT_EQ(server.close(), HAKO_PDU_ERR_OK);
-    ASSERT_EQ(client.close(), HAKO_PDU_ERR_OK);
+    // Closing a session endpoint drops its slots.
+    ASSERT_EQ(endpoints.back()->stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(endpoints.back()->close(), HAKO_PDU_ERR_OK);
+    endpoints.pop_back();
+    ASSERT_EQ(shared->snapshot(entries), HAKO_PDU_ERR_OK);
+    EXPECT_EQ(entries.size(), 1u);
 
+    for (auto& ep : endpoints) {
+        ASSERT_EQ(ep->stop(), HAKO_PDU_ERR_OK);
+        ASSERT_EQ(ep->close(), HAKO_PDU_ERR_OK);
+    }
+    ASSERT_EQ(client1.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client2.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client1.close(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client2.close(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(mux.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(mux.close(), HAKO_PDU_ERR_OK);
 }
 
-TEST_F(EndpointTest, WebSocketCommunicationTest) {
-    int server_port = find_available_port(SOCK_STREAM);
-    ASSERT_GT(server_port, 0);
-
-    hakoniwa::pdu::Endpoint server("ws_server", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
-    hakoniwa::pdu::Endpoint client("ws_client", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+TEST_F(EndpointTest, TcpMuxAdmissionControlTest) {
+    // max_sessions 1, 1 session/s with a burst of 2: refused clients get a
+    // SESSION_REJECTED frame with the reason, then EOF.
+    hakoniwa::pdu::EndpointCommMultiplexer mux("tcp_mux_admission", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+    ASSERT_EQ(mux.open("test/mux/endpoint_tcp_mux_admission.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(mux.start(), HAKO_PDU_ERR_OK);
 
+    auto connect_client = []() {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(54025);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            ::close(fd);
+            fd = -1;
+        }
+        return fd;
+    };
+    // Reason text of the reject frame; empty when the server kept the connection.
+    auto read_rejection = [](int fd) {
+        std::vector<std::byte> bytes;
+        for (;;) {
+            pollfd pfd{fd, POLLIN, 0};
+            if (::poll(&pfd, 1, 500) != 1) {
+                return std::string();
+            }
+            std::byte buf[512];
+            ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+            if (n <= 0) {
+                break;
+            }
+            bytes.insert(bytes.end(), buf, buf + n);
+        }
+        hakoniwa::pdu::comm::DataPacketView view;
+        if (!hakoniwa::pdu::comm::DataPacket::decode_view(bytes, "v2", view)
+            || view.meta.meta_request_type != hakoniwa::pdu::comm::SESSION_REJECTED) {
+            return std::string("?");
+        }
+        return std::string(reinterpret_cast<const char*>(view.body.data()), view.body.size());
+    };
+    auto take_one = [&mux]() {
+        (void)mux.wait_endpoints(2000);
+        auto endpoints = mux.take_endpoints();
+        return endpoints.empty() ? nullptr : std::move(endpoints.front());
+    };
 
-    ASSERT_EQ(server.open("test/test_endpoint_ws_server.json"), HAKO_PDU_ERR_OK);
-    ASSERT_EQ(client.open("test/test_endpoint_ws_client.json"), HAKO_PDU_ERR_OK);
-    
-    // Start server first, then client connects
-    ASSERT_EQ(server.start(), HAKO_PDU_ERR_OK);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500)); // Give server time to start accepting
+    int fd1 = connect_client();
+    ASSERT_GE(fd1, 0);
+    auto session1 = take_one();
+    ASSERT_NE(session1, nullptr);
+
+    int fd2 = connect_client();
+    ASSERT_GE(fd2, 0);
+    EXPECT_EQ(read_rejection(fd2), "max_sessions");
+    ::close(fd2);
+
+    // TcpComm recognizes the frame and waits the max reconnect delay (5 s)
+    // instead of retrying from its 10 ms initial delay.
+    {
+        hakoniwa::pdu::comm::TcpComm client;
+        ASSERT_EQ(client.open("test/mux/comm_tcp_mux_admission_client.json"), HAKO_PDU_ERR_OK);
+        ASSERT_EQ(client.start(), HAKO_PDU_ERR_OK);
+        for (int i = 0; i < 200 && client.rejected_count() == 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        EXPECT_EQ(client.rejected_count(), 1u);
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        EXPECT_EQ(client.rejected_count(), 1u);
+        ASSERT_EQ(client.stop(), HAKO_PDU_ERR_OK);
+        ASSERT_EQ(client.close(), HAKO_PDU_ERR_OK);
+    }
 
-    ASSERT_EQ(client.start(), HAKO_PDU_ERR_OK);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500)); // Give client time to connect
+    // Closing the session frees its slot; the burst still has a token.
+    ASSERT_EQ(session1->stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(session1->close(), HAKO_PDU_ERR_OK);
+    session1.reset();
+    int fd3 = connect_client();
+    ASSERT_GE(fd3, 0);
+    auto session3 = take_one();
+    ASSERT_NE(session3, nullptr);
+    ASSERT_EQ(session3->stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(session3->close(), HAKO_PDU_ERR_OK);
+    session3.reset();
+
+    // A slot is free, but the bucket is empty.
+    int fd4 = connect_client();
+    ASSERT_GE(fd4, 0);
+    EXPECT_EQ(read_rejection(fd4), "accept_rate");
+    ::close(fd4);
+
+    hakoniwa::pdu::comm::CommMuxAdmissionStats stats;
+    ASSERT_EQ(mux.get_admission_stats(stats), HAKO_PDU_ERR_OK);
+    EXPECT_EQ(stats.accepted, 2u);
+    EXPECT_EQ(stats.rejected_max_sessions, 2u);
+    EXPECT_EQ(stats.rejected_rate, 1u);
+    EXPECT_EQ(stats.live_sessions, 0u);
+
+    ::close(fd1);
+    ::close(fd3);
+    ASSERT_EQ(mux.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(mux.close(), HAKO_PDU_ERR_OK);
+}
 
-    auto key = create_key("robot_ws", 30);
-    std::vector<std::byte> client_msg = {(std::byte)'W', (std::byte)'e', (std::byte)'b', (std::byte)'S', (std::byte)'o', (std::byte)'c', (std::byte)'k', (std::byte)'e', (std::byte)'t'};
+TEST_F(EndpointTest, TcpMuxReactorSessionsTest) {
+    hakoniwa::pdu::EndpointCommMultiplexer mux("tcp_mux_reactor", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+    ASSERT_EQ(mux.open("test/mux/endpoint_tcp_mux_reactor.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(mux.start(), HAKO_PDU_ERR_OK);
 
-    // Client sends message to server
-    ASSERT_EQ(client.send(key, client_msg), HAKO_PDU_ERR_OK);
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    hakoniwa::pdu::Endpoint client1("tcp_mux_reactor_client1", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+    hakoniwa::pdu::Endpoint client2("tcp_mux_reactor_client2", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+    ASSERT_EQ(client1.open("test/mux/endpoint_tcp_mux_reactor_client.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client2.open("test/mux/endpoint_tcp_mux_reactor_client.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client1.start(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client2.start(), HAKO_PDU_ERR_OK);
 
-    std::vector<std::byte> server_buf(client_msg.size());
-    size_t server_len = 0;
-    ASSERT_EQ(server.recv(key, server_buf, server_len), HAKO_PDU_ERR_OK);
-    ASSERT_EQ(server_len, client_msg.size());
-    EXPECT_EQ(server_buf, client_msg);
-    
-    std::vector<std::byte> server_msg = {(std::byte)'H', (std::byte)'e', (std::byte)'l', (std::byte)'l', (std::byte)'o', (std::byte)' ', (std::byte)'C', (std::byte)'l', (std::byte)'i', (std::byte)'e', (std::byte)'n', (std::byte)'t'};
+    std::vector<std::unique_ptr<hakoniwa::pdu::Endpoint>> endpoints;
+    for (int i = 0; i < 30 && endpoints.size() < 2; ++i) {
+        for (auto& ep : mux.take_endpoints()) {
+            endpoints.push_back(std::move(ep));
+        }
+        if (endpoints.size() < 2) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+    ASSERT_EQ(endpoints.size(), 2u);
+    EXPECT_EQ(mux.connected_count(), 2u);
+
+    // Frames much larger than the socket buffers arrive in pieces on the loop
+    // and leave through the session's send queue.
+    auto small_key = create_key("robot_reactor_1", 201);
+    auto large_key = create_key("robot_reactor_1", 202);
+    auto key2 = create_key("robot_reactor_2", 203);
+    std::vector<std::byte> small = {(std::byte)'r', (std::byte)'1'};
+    std::vector<std::byte> large(256 * 1024);
+    for (size_t i = 0; i < large.size(); ++i) {
+        large[i] = static_cast<std::byte>(i * 7);
+    }
+    std::vector<std::byte> msg2 = {(std::byte)'r', (std::byte)'2'};
+    ASSERT_EQ(client1.send(small_key, small), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client1.send(large_key, large), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client2.send(key2, msg2), HAKO_PDU_ERR_OK);
 
-    // Server sends message to client
-    ASSERT_EQ(server.send(key, server_msg), HAKO_PDU_ERR_OK);
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    auto find_endpoint = [&](const hakoniwa::pdu::PduResolvedKey& key,
+                             const std::vector<std::byte>& expected) -> int {
+        for (int attempt = 0; attempt < 40; ++attempt) {
+            for (size_t i = 0; i < endpoints.size(); ++i) {
+                std::vector<std::byte> buf(expected.size() + 16);
+                size_t len = 0;
+                if (endpoints[i]->recv(key, buf, len) == HAKO_PDU_ERR_OK) {
+                    buf.resize(len);
+                    if (buf == expected) {
+                        return static_cast<int>(i);
+                    }
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        return -1;
+    };
+    int idx1 = find_endpoint(small_key, small);
+    ASSERT_GE(idx1, 0);
+    EXPECT_EQ(find_endpoint(large_key, large), idx1);
+    int idx2 = find_endpoint(key2, msg2);
+    ASSERT_GE(idx2, 0);
+    ASSERT_NE(idx1, idx2);
 
-    std::vector<std::byte> client_buf(server_msg.size());
+    std::reverse(large.begin(), large.end());
+    ASSERT_EQ(endpoints[static_cast<size_t>(idx1)]->send(large_key, large), HAKO_PDU_ERR_OK);
+    std::vector<std::byte> client_buf(large.size());
     size_t client_len = 0;
-    ASSERT_EQ(client.recv(key, client_buf, client_len), HAKO_PDU_ERR_OK);
-    ASSERT_EQ(client_len, server_msg.size());
-    EXPECT_EQ(client_buf, server_msg);
+    HakoPduErrorType err = HAKO_PDU_ERR_NO_ENTRY;
+    for (int attempt = 0; attempt < 40 && err != HAKO_PDU_ERR_OK; ++attempt) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        err = client1.recv(large_key, client_buf, client_len);
+    }
+    ASSERT_EQ(err, HAKO_PDU_ERR_OK);
+    client_buf.resize(client_len);
+    EXPECT_EQ(client_buf, large);
+
+    // Callbacks run outside the loop mutex, so one may stop its own session.
+    std::atomic<bool> stopped_in_callback{false};
+    hakoniwa::pdu::Endpoint& ep2 = *endpoints[static_cast<size_t>(idx2)];
+    ep2.subscribe_on_recv_callback(key2, [&](const hakoniwa::pdu::PduResolvedKey&, std::span<const std::byte>) {
+        (void)ep2.stop();
+        stopped_in_callback = true;
+    });
+    ASSERT_EQ(client2.send(key2, msg2), HAKO_PDU_ERR_OK);
+    for (int attempt = 0; attempt < 40 && !stopped_in_callback; ++attempt) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    EXPECT_TRUE(stopped_in_callback);
 
-    ASSERT_EQ(server.stop(), HAKO_PDU_ERR_OK);
-    ASSERT_EQ(client.stop(), HAKO_PDU_ERR_OK);
-    ASSERT_EQ(server.close(), HAKO_PDU_ERR_OK);
-    ASSERT_EQ(client.close(), HAKO_PDU_ERR_OK);
- 
+    for (auto& ep : endpoints) {
+        ASSERT_EQ(ep->stop(), HAKO_PDU_ERR_OK);
+        ASSERT_EQ(ep->close(), HAKO_PDU_ERR_OK);
+    }
+    ASSERT_EQ(client1.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client2.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client1.close(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client2.close(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(mux.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(mux.close(), HAKO_PDU_ERR_OK);
 }
 
-TEST_F(EndpointTest, WebSocketCommunicationInOutTest) {
-    int server_port = find_available_port(SOCK_STREAM);
-    ASSERT_GT(server_port, 0);
+TEST_F(EndpointTest, MuxSendToAllEncodesOnceTest) {
+    hakoniwa::pdu::EndpointCommMultiplexer mux("tcp_mux_group", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+    ASSERT_EQ(mux.open("test/mux/endpoint_tcp_mux_reactor.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(mux.start(), HAKO_PDU_ERR_OK);
 
+    hakoniwa::pdu::Endpoint client1("tcp_mux_group_client1", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+    hakoniwa::pdu::Endpoint client2("tcp_mux_group_client2", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+    ASSERT_EQ(client1.open("test/mux/endpoint_tcp_mux_reactor_client.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client2.open("test/mux/endpoint_tcp_mux_reactor_client.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client1.start(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client2.start(), HAKO_PDU_ERR_OK);
 
-    hakoniwa::pdu::Endpoint server("ws_server_inout", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
-    hakoniwa::pdu::Endpoint client("ws_client_inout", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+    std::vector<std::unique_ptr<hakoniwa::pdu::Endpoint>> endpoints;
+    for (int i = 0; i < 30 && endpoints.size() < 2; ++i) {
+        for (auto& ep : mux.take_endpoints()) {
+            endpoints.push_back(std::move(ep));
+        }
+        if (endpoints.size() < 2) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+    ASSERT_EQ(endpoints.size(), 2u);
 
+    auto key = create_key("world", 301);
+    std::vector<std::byte> state = {(std::byte)'w', (std::byte)'o', (std::byte)'r', (std::byte)'l', (std::byte)'d'};
+    hakoniwa::pdu::PduGroupSendResult result;
+    ASSERT_EQ(mux.send_to_all(key, state, &result), HAKO_PDU_ERR_OK);
+    EXPECT_EQ(result.sessions, 2u);
+    EXPECT_EQ(result.sent, 2u);
+    EXPECT_EQ(result.failed, 0u);
+
+    for (auto* client : {&client1, &client2}) {
+        std::vector<std::byte> buf(16);
+        size_t len = 0;
+        HakoPduErrorType err = HAKO_PDU_ERR_NO_ENTRY;
+        for (int attempt = 0; attempt < 40 && err != HAKO_PDU_ERR_OK; ++attempt) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(25));
+            err = client->recv(key, buf, len);
+        }
+        ASSERT_EQ(err, HAKO_PDU_ERR_OK);
+        buf.resize(len);
+        EXPECT_EQ(buf, state);
+    }
 
-    ASSERT_EQ(server.open("test/test_endpoint_ws_server_inout.json"), HAKO_PDU_ERR_OK);
-    ASSERT_EQ(client.open("test/test_endpoint_ws_client_inout.json"), HAKO_PDU_ERR_OK);
-    
-    // Start server first, then client connects
-    ASSERT_EQ(server.start(), HAKO_PDU_ERR_OK);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500)); // Give server time to start accepting
+    // A dropped session endpoint leaves the group.
+    ASSERT_EQ(endpoints.back()->stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(endpoints.back()->close(), HAKO_PDU_ERR_OK);
+    endpoints.pop_back();
+    ASSERT_EQ(mux.send_to_all(key, state, &result), HAKO_PDU_ERR_OK);
+    EXPECT_EQ(result.sessions, 1u);
+    EXPECT_EQ(result.sent, 1u);
 
-    ASSERT_EQ(client.start(), HAKO_PDU_ERR_OK);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500)); // Give client time to connect
+    for (auto& ep : endpoints) {
+        ASSERT_EQ(ep->stop(), HAKO_PDU_ERR_OK);
+        ASSERT_EQ(ep->close(), HAKO_PDU_ERR_OK);
+    }
+    ASSERT_EQ(client1.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client2.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client1.close(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client2.close(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(mux.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(mux.close(), HAKO_PDU_ERR_OK);
+}
 
-    auto key = create_key("robot_ws_inout", 40);
-    std::vector<std::byte> client_msg = {(std::byte)'I', (std::byte)'N', (std::byte)'O', (std::byte)'U', (std::byte)'T', (std::byte)' ', (std::byte)'C', (std::byte)'L', (std::byte)'I', (std::byte)'E', (std::byte)'N', (std::byte)'T'};
 
-    // Client sends message to server
-    ASSERT_EQ(client.send(key, client_msg), HAKO_PDU_ERR_OK);
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+TEST_F(EndpointTest, MuxSessionEndpointsFromTemplateTest) {
+    // The mux parses its endpoint config once: session endpoints share its PDU
+    // definition and open even after every config file is gone.
+    const std::string dir = "/tmp/hako_mux_template_test";
+    std::filesystem::create_directories(dir);
+    const std::string cwd = std::filesystem::current_path().string();
+    {
+        std::ofstream(dir + "/comm.json") << R"({ "protocol": "tcp", "direction": "inout",
+            "local": { "address": "127.0.0.1", "port": 54024 }, "expected_clients": 2 })";
+        std::ofstream(dir + "/comm_client.json") << R"({ "protocol": "tcp", "direction": "inout", "role": "client",
+            "remote": { "address": "127.0.0.1", "port": 54024 }, "options": { "connect_timeout_ms": 2000 } })";
+        std::ofstream(dir + "/endpoint.json") << "{ \"pdu_def_path\": \"" << cwd << "/test/test_pdudef.json\","
+            " \"cache\": \"" << cwd << "/config/sample/cache/queue.json\", \"comm\": \"comm.json\" }";
+        std::ofstream(dir + "/endpoint_client.json") << "{ \"cache\": \"" << cwd << "/config/sample/cache/queue.json\","
+            " \"comm\": \"comm_client.json\" }";
+    }
 
-    std::vector<std::byte> server_buf(client_msg.size());
-    size_t server_len = 0;
-    ASSERT_EQ(server.recv(key, server_buf, server_len), HAKO_PDU_ERR_OK);
-    ASSERT_EQ(server_len, client_msg.size());
-    EXPECT_EQ(server_buf, client_msg);
-    
-    std::vector<std::byte> server_msg = {(std::byte)'I', (std::byte)'N', (std::byte)'O', (std::byte)'U', (std::byte)'T', (std::byte)' ', (std::byte)'S', (std::byte)'E', (std::byte)'R', (std::byte)'V', (std::byte)'E', (std::byte)'R'};
+    hakoniwa::pdu::EndpointCommMultiplexer mux("tcp_mux_template", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+    ASSERT_EQ(mux.open(dir + "/endpoint.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(mux.start(), HAKO_PDU_ERR_OK);
+    hakoniwa::pdu::Endpoint client1("tcp_mux_template_client1", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+    hakoniwa::pdu::Endpoint client2("tcp_mux_template_client2", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+    ASSERT_EQ(client1.open(dir + "/endpoint_client.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client2.open(dir + "/endpoint_client.json"), HAKO_PDU_ERR_OK);
+    std::filesystem::remove_all(dir);
+    ASSERT_EQ(client1.start(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client2.start(), HAKO_PDU_ERR_OK);
 
-    // Server sends message to client
+    std::vector<std::unique_ptr<hakoniwa::pdu::Endpoint>> endpoints;
+    for (int i = 0; i < 30 && endpoints.size() < 2; ++i) {
+        for (auto& ep : mux.take_endpoints()) {
+            endpoints.push_back(std::move(ep));
+        }
+        if (endpoints.size() < 2) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+    ASSERT_EQ(endpoints.size(), 2u);
+    ASSERT_NE(endpoints[0]->get_pdu_definition(), nullptr);
+    EXPECT_EQ(endpoints[0]->get_pdu_definition(), endpoints[1]->get_pdu_definition());
+    EXPECT_EQ(endpoints[0]->get_pdu_size({"TestRobot", "TestPDU"}), 8u);
+
+    // Each session endpoint has its own cache cloned from the template.
+    auto key = create_key("TestRobot", 123);
+    std::vector<std::byte> msg = {(std::byte)'t', (std::byte)'m', (std::byte)'p', (std::byte)'l'};
+    ASSERT_EQ(client1.send(key, msg), HAKO_PDU_ERR_OK);
+    int received_by = -1;
+    for (int attempt = 0; attempt < 40 && received_by < 0; ++attempt) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(25));
+        for (size_t i = 0; i < endpoints.size(); ++i) {
+            std::vector<std::byte> buf(16);
+            size_t len = 0;
+            if (endpoints[i]->recv(key, buf, len) == HAKO_PDU_ERR_OK) {
+                buf.resize(len);
+                EXPECT_EQ(buf, msg);
+                received_by = static_cast<int>(i);
+            }
+        }
+    }
+    ASSERT_GE(received_by, 0);
+    std::vector<std::byte> buf(16);
+    size_t len = 0;
+    EXPECT_NE(endpoints[static_cast<size_t>(1 - received_by)]->recv(key, buf, len), HAKO_PDU_ERR_OK);
+
+    for (auto& ep : endpoints) {
+        ASSERT_EQ(ep->stop(), HAKO_PDU_ERR_OK);
+        ASSERT_EQ(ep->close(), HAKO_PDU_ERR_OK);
+    }
+    ASSERT_EQ(client1.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client2.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client1.close(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client2.close(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(mux.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(mux.close(), HAKO_PDU_ERR_OK);
+}
+
+
+TEST_F(EndpointTest, UdpMuxPeerSessionsTest) {
+    // One UDP socket: every client address becomes its own session endpoint,
+    // replies go to that peer only, and silent peers expire.
+    hakoniwa::pdu::EndpointCommMultiplexer mux("udp_mux", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+    ASSERT_EQ(mux.open("test/mux/endpoint_udp_mux.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(mux.start(), HAKO_PDU_ERR_OK);
+    EXPECT_EQ(mux.expected_count(), 2u);
+
+    hakoniwa::pdu::Endpoint client1("udp_mux_client1", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+    hakoniwa::pdu::Endpoint client2("udp_mux_client2", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+    ASSERT_EQ(client1.open("test/mux/endpoint_udp_mux_client1.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client2.open("test/mux/endpoint_udp_mux_client2.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client1.start(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client2.start(), HAKO_PDU_ERR_OK);
+
+    auto key1 = create_key("robot_udp_mux_1", 111);
+    auto key2 = create_key("robot_udp_mux_2", 112);
+    std::vector<std::byte> msg1 = {(std::byte)'u', (std::byte)'1'};
+    std::vector<std::byte> msg2 = {(std::byte)'u', (std::byte)'2'};
+    ASSERT_EQ(client1.send(key1, msg1), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client2.send(key2, msg2), HAKO_PDU_ERR_OK);
+
+    std::vector<std::unique_ptr<hakoniwa::pdu::Endpoint>> endpoints;
+    for (int i = 0; i < 30 && endpoints.size() < 2; ++i) {
+        for (auto& ep : mux.take_endpoints()) {
+            endpoints.push_back(std::move(ep));
+        }
+        if (endpoints.size() < 2) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+    ASSERT_EQ(endpoints.size(), 2u);
+    EXPECT_TRUE(mux.is_ready());
+
+    // The datagram that created a session is delivered once its endpoint starts.
+    auto find_endpoint = [&](const hakoniwa::pdu::PduResolvedKey& key, const std::vector<std::byte>& expected) -> int {
+        for (int attempt = 0; attempt < 20; ++attempt) {
+            for (size_t i = 0; i < endpoints.size(); ++i) {
+                std::vector<std::byte> buf(16);
+                size_t len = 0;
+                if (endpoints[i]->recv(key, buf, len) == HAKO_PDU_ERR_OK) {
+                    buf.resize(len);
+                    if (buf == expected) {
+                        return static_cast<int>(i);
+                    }
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return -1;
+    };
+    int idx1 = find_endpoint(key1, msg1);
+    int idx2 = find_endpoint(key2, msg2);
+    ASSERT_GE(idx1, 0);
+    ASSERT_GE(idx2, 0);
+    ASSERT_NE(idx1, idx2);
+
+    std::vector<std::byte> resp1 = {(std::byte)'r', (std::byte)'1'};
+    std::vector<std::byte> resp2 = {(std::byte)'r', (std::byte)'2'};
+    ASSERT_EQ(endpoints[static_cast<size_t>(idx1)]->send(key1, resp1), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(endpoints[static_cast<size_t>(idx2)]->send(key2, resp2), HAKO_PDU_ERR_OK);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    std::vector<std::byte> client_buf(8);
+    size_t client_len = 0;
+    ASSERT_EQ(client1.recv(key1, client_buf, client_len), HAKO_PDU_ERR_OK);
+    client_buf.resize(client_len);
+    EXPECT_EQ(client_buf, resp1);
+    client_buf.assign(8, std::byte{0});
+    client_len = 0;
+    ASSERT_EQ(client2.recv(key2, client_buf, client_len), HAKO_PDU_ERR_OK);
+    client_buf.resize(client_len);
+    EXPECT_EQ(client_buf, resp2);
+    // Each reply reached only its own peer.
+    client_len = 0;
+    EXPECT_NE(client1.recv(key2, client_buf, client_len), HAKO_PDU_ERR_OK);
+
+    // max_peers is 2: neither a datagram that is not a PDU nor a third peer opens a session.
+    ASSERT_EQ(client1.send(key1, msg1), HAKO_PDU_ERR_OK); // keep both peers from expiring
+    ASSERT_EQ(client2.send(key2, msg2), HAKO_PDU_ERR_OK);
+    int raw_fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(raw_fd, 0);
+    sockaddr_in mux_addr{};
+    mux_addr.sin_family = AF_INET;
+    mux_addr.sin_port = htons(54015);
+    mux_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    const char junk[] = "not a pdu";
+    EXPECT_EQ(::sendto(raw_fd, junk, sizeof(junk), 0, reinterpret_cast<const sockaddr*>(&mux_addr), sizeof(mux_addr)),
+              static_cast<ssize_t>(sizeof(junk)));
+    hakoniwa::pdu::Endpoint client3("udp_mux_client3", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+    ASSERT_EQ(client3.open("test/mux/endpoint_udp_mux_client3.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client3.start(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client3.send(key1, msg1), HAKO_PDU_ERR_OK);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_TRUE(mux.take_endpoints().empty());
+    EXPECT_EQ(mux.connected_count(), 2u);
+    hakoniwa::pdu::comm::CommMuxAdmissionStats stats;
+    ASSERT_EQ(mux.get_admission_stats(stats), HAKO_PDU_ERR_OK);
+    EXPECT_EQ(stats.accepted, 2u);
+    EXPECT_EQ(stats.rejected_max_sessions, 1u);
+    ::close(raw_fd);
+    ASSERT_EQ(client3.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client3.close(), HAKO_PDU_ERR_OK);
+
+    // idle_timeout_ms is 500: both peers expire, and a new datagram opens a new session.
+    for (int i = 0; i < 100 && mux.connected_count() > 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    EXPECT_EQ(mux.connected_count(), 0u);
+    bool running = true;
+    ASSERT_EQ(endpoints[static_cast<size_t>(idx1)]->is_running(running), HAKO_PDU_ERR_OK);
+    EXPECT_FALSE(running);
+    EXPECT_NE(endpoints[static_cast<size_t>(idx1)]->send(key1, resp1), HAKO_PDU_ERR_OK);
+
+    ASSERT_EQ(client1.send(key1, msg1), HAKO_PDU_ERR_OK);
+    std::vector<std::unique_ptr<hakoniwa::pdu::Endpoint>> renewed;
+    for (int i = 0; i < 30 && renewed.empty(); ++i) {
+        renewed = mux.take_endpoints();
+        if (renewed.empty()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+    ASSERT_EQ(renewed.size(), 1u);
+    EXPECT_EQ(mux.connected_count(), 1u);
+
+    for (auto& ep : endpoints) {
+        ASSERT_EQ(ep->stop(), HAKO_PDU_ERR_OK);
+        ASSERT_EQ(ep->close(), HAKO_PDU_ERR_OK);
+    }
+    ASSERT_EQ(renewed.front()->stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(renewed.front()->close(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client1.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client2.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client1.close(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client2.close(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(mux.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(mux.close(), HAKO_PDU_ERR_OK);
+}
+
+TEST_F(EndpointTest, WebSocketMuxPerClientEndpointsTest) {
+    // One listener and io pool: each WebSocket client becomes its own endpoint,
+    // and a reply from it reaches that client only.
+    hakoniwa::pdu::EndpointCommMultiplexer mux("ws_mux", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+    ASSERT_EQ(mux.open("test/mux/endpoint_ws_mux.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(mux.start(), HAKO_PDU_ERR_OK);
+    EXPECT_EQ(mux.expected_count(), 2u);
+
+    hakoniwa::pdu::Endpoint client1("ws_mux_client1", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+    auto client2 = std::make_unique<hakoniwa::pdu::Endpoint>("ws_mux_client2", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+    ASSERT_EQ(client1.open("test/mux/endpoint_ws_mux_client1.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client2->open("test/mux/endpoint_ws_mux_client2.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client1.start(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client2->start(), HAKO_PDU_ERR_OK);
+
+    std::vector<std::unique_ptr<hakoniwa::pdu::Endpoint>> endpoints;
+    for (int i = 0; i < 100 && endpoints.size() < 2; ++i) {
+        for (auto& ep : mux.take_endpoints()) {
+            endpoints.push_back(std::move(ep));
+        }
+        if (endpoints.size() < 2) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+    }
+    ASSERT_EQ(endpoints.size(), 2u);
+    EXPECT_TRUE(mux.is_ready());
+    for (auto* client : {&client1, client2.get()}) {
+        bool running = false;
+        for (int w = 0; w < 100 && !running; ++w) {
+            client->is_running(running);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        ASSERT_TRUE(running);
+    }
+
+    auto key1 = create_key("robot_ws_mux_1", 121);
+    auto key2 = create_key("robot_ws_mux_2", 122);
+    std::vector<std::byte> msg1 = {(std::byte)'w', (std::byte)'s', (std::byte)'1'};
+    std::vector<std::byte> msg2 = {(std::byte)'w', (std::byte)'s', (std::byte)'2'};
+    ASSERT_EQ(client1.send(key1, msg1), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client2->send(key2, msg2), HAKO_PDU_ERR_OK);
+
+    auto find_endpoint = [&](const hakoniwa::pdu::PduResolvedKey& key,
+                             const std::vector<std::byte>& expected) -> int {
+        for (int attempt = 0; attempt < 40; ++attempt) {
+            for (size_t i = 0; i < endpoints.size(); ++i) {
+                std::vector<std::byte> buf(64);
+                size_t len = 0;
+                if (endpoints[i]->recv(key, buf, len) == HAKO_PDU_ERR_OK) {
+                    buf.resize(len);
+                    if (buf == expected) {
+                        return static_cast<int>(i);
+                    }
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(25));
+        }
+        return -1;
+    };
+    const int idx1 = find_endpoint(key1, msg1);
+    const int idx2 = find_endpoint(key2, msg2);
+    ASSERT_GE(idx1, 0);
+    ASSERT_GE(idx2, 0);
+    ASSERT_NE(idx1, idx2);
+
+    std::vector<std::byte> resp1 = {(std::byte)'r', (std::byte)'1'};
+    ASSERT_EQ(endpoints[static_cast<size_t>(idx1)]->send(key1, resp1), HAKO_PDU_ERR_OK);
+    std::vector<std::byte> client_buf(8);
+    size_t client_len = 0;
+    for (int w = 0; w < 100 && client1.recv(key1, client_buf, client_len) != HAKO_PDU_ERR_OK; ++w) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    client_buf.resize(client_len);
+    EXPECT_EQ(client_buf, resp1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    client_buf.assign(8, std::byte{0});
+    EXPECT_NE(client2->recv(key1, client_buf, client_len), HAKO_PDU_ERR_OK); // not broadcast
+
+    // A disconnecting client drops out of connected_count().
+    ASSERT_EQ(client2->stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client2->close(), HAKO_PDU_ERR_OK);
+    client2.reset();
+    for (int w = 0; w < 100 && mux.connected_count() > 1; ++w) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(mux.connected_count(), 1u);
+
+    // Stopping and closing the mux only ends accepting: the taken session keeps
+    // its io threads and still reaches its client.
+    auto expect_reply = [&](const std::vector<std::byte>& reply) {
+        ASSERT_EQ(endpoints[static_cast<size_t>(idx1)]->send(key1, reply), HAKO_PDU_ERR_OK);
+        std::vector<std::byte> buf(8);
+        size_t len = 0;
+        for (int w = 0; w < 100; ++w) {
+            buf.assign(8, std::byte{0});
+            if (client1.recv(key1, buf, len) == HAKO_PDU_ERR_OK && len == reply.size() &&
+                std::equal(reply.begin(), reply.end(), buf.begin())) {
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        ADD_FAILURE() << "reply not received after the mux stopped";
+    };
+    ASSERT_EQ(mux.stop(), HAKO_PDU_ERR_OK);
+    expect_reply({(std::byte)'r', (std::byte)'2'});
+    ASSERT_EQ(mux.close(), HAKO_PDU_ERR_OK);
+    expect_reply({(std::byte)'r', (std::byte)'3'});
+
+    for (auto& ep : endpoints) {
+        ASSERT_EQ(ep->stop(), HAKO_PDU_ERR_OK);
+        ASSERT_EQ(ep->close(), HAKO_PDU_ERR_OK);
+    }
+    ASSERT_EQ(client1.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client1.close(), HAKO_PDU_ERR_OK);
+}
+TEST_F(EndpointTest, UdpCommunicationTest) {
+    int server_port = find_available_port(SOCK_DGRAM);
+    ASSERT_GT(server_port, 0);
+
+
+    hakoniwa::pdu::Endpoint server("udp_server", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+    hakoniwa::pdu::Endpoint client("udp_client", HAKO_PDU_ENDPOINT_DIRECTION_OUT);
+
+    ASSERT_EQ(server.open("test/test_endpoint_udp_server.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client.open("test/test_endpoint_udp_client.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(server.start(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client.start(), HAKO_PDU_ERR_OK);
+    
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    auto key = create_key("robot_udp", 20);
+    std::vector<std::byte> client_msg = {(std::byte)'h', (std::byte)'e', (std::byte)'l', (std::byte)'l', (std::byte)'o'};
+
+    ASSERT_EQ(client.send(key, client_msg), HAKO_PDU_ERR_OK);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::vector<std::byte> server_buf(20);
+    size_t server_len = 0;
+    ASSERT_EQ(server.recv(key, server_buf, server_len), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(server_len, client_msg.size());
+    server_buf.resize(server_len);
+    EXPECT_EQ(server_buf, client_msg);
+    
+    ASSERT_EQ(server.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(server.close(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client.close(), HAKO_PDU_ERR_OK);
+
+}
+
+TEST_F(EndpointTest, UdpBatchSendRecvTest) {
+    // send_batch 3 splits 10 datagrams over several sendmmsg calls; recv_batch 4 reads them with recvmmsg.
+    hakoniwa::pdu::comm::UdpComm rx;
+    hakoniwa::pdu::comm::UdpComm tx;
+    ASSERT_EQ(rx.open("test/test_comm_udp_batch_in.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(tx.open("test/test_comm_udp_batch_out.json"), HAKO_PDU_ERR_OK);
+
+    std::mutex mtx;
+    std::vector<std::pair<HakoPduChannelIdType, std::vector<std::byte>>> received;
+    rx.set_on_recv_callback([&](const hakoniwa::pdu::PduResolvedKey& key, std::span<const std::byte> data) {
+        std::lock_guard<std::mutex> lock(mtx);
+        EXPECT_EQ(key.robot, "robot_batch");
+        received.emplace_back(key.channel_id, std::vector<std::byte>(data.begin(), data.end()));
+    });
+    ASSERT_EQ(rx.start(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(tx.start(), HAKO_PDU_ERR_OK);
+
+    constexpr int kCount = 10;
+    std::vector<std::vector<std::byte>> payloads;
+    for (int i = 0; i < kCount; ++i) {
+        payloads.emplace_back(static_cast<size_t>(i + 1), static_cast<std::byte>('a' + i));
+    }
+    std::vector<hakoniwa::pdu::PduSendItem> items;
+    for (int i = 0; i < kCount; ++i) {
+        items.push_back(hakoniwa::pdu::PduSendItem{create_key("robot_batch", i), payloads[i]});
+    }
+    ASSERT_EQ(tx.send_batch(items), HAKO_PDU_ERR_OK);
+
+    for (int i = 0; i < 100; ++i) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (received.size() >= kCount) {
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        ASSERT_EQ(received.size(), static_cast<size_t>(kCount));
+        for (int i = 0; i < kCount; ++i) {
+            EXPECT_EQ(received[i].first, static_cast<HakoPduChannelIdType>(i));
+            EXPECT_EQ(received[i].second, payloads[i]);
+        }
+    }
+
+    ASSERT_EQ(tx.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(rx.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(tx.close(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(rx.close(), HAKO_PDU_ERR_OK);
+}
+
+TEST_F(EndpointTest, IoUringBackendBatchTest) {
+    // "io_backend": "io_uring" must work with or without liburing: without it
+    // (or without kernel support) the comms fall back to the socket path.
+    if (!hakoniwa::pdu::comm::IoUringIo::is_compiled_in()) {
+        hakoniwa::pdu::comm::IoUringIo ring;
+        EXPECT_EQ(ring.init(hakoniwa::pdu::comm::IoUringIo::Options{}, true), HAKO_PDU_ERR_UNSUPPORTED);
+    }
+    constexpr int kCount = 8;
+    std::vector<std::vector<std::byte>> payloads;
+    for (int i = 0; i < kCount; ++i) {
+        payloads.emplace_back(static_cast<size_t>(i + 1), static_cast<std::byte>('a' + i));
+    }
+    auto make_items = [&](const std::string& robot) {
+        std::vector<hakoniwa::pdu::PduSendItem> items;
+        for (int i = 0; i < kCount; ++i) {
+            items.push_back(hakoniwa::pdu::PduSendItem{create_key(robot, i), payloads[i]});
+        }
+        return items;
+    };
+    std::mutex mtx;
+    std::vector<std::pair<HakoPduChannelIdType, std::vector<std::byte>>> received;
+    auto on_recv = [&](const hakoniwa::pdu::PduResolvedKey& key, std::span<const std::byte> data) {
+        std::lock_guard<std::mutex> lock(mtx);
+        received.emplace_back(key.channel_id, std::vector<std::byte>(data.begin(), data.end()));
+    };
+    auto wait_and_check = [&]() {
+        for (int i = 0; i < 100; ++i) {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (received.size() >= kCount) {
+                    break;
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        std::lock_guard<std::mutex> lock(mtx);
+        ASSERT_EQ(received.size(), static_cast<size_t>(kCount));
+        for (int i = 0; i < kCount; ++i) {
+            EXPECT_EQ(received[i].first, static_cast<HakoPduChannelIdType>(i));
+            EXPECT_EQ(received[i].second, payloads[i]);
+        }
+        received.clear();
+    };
+
+    {
+        hakoniwa::pdu::comm::UdpComm rx;
+        hakoniwa::pdu::comm::UdpComm tx;
+        ASSERT_EQ(rx.open("test/test_comm_udp_uring_in.json"), HAKO_PDU_ERR_OK);
+        ASSERT_EQ(tx.open("test/test_comm_udp_uring_out.json"), HAKO_PDU_ERR_OK);
+        rx.set_on_recv_callback(on_recv);
+        ASSERT_EQ(rx.start(), HAKO_PDU_ERR_OK);
+        ASSERT_EQ(tx.start(), HAKO_PDU_ERR_OK);
+        ASSERT_EQ(tx.send_batch(make_items("robot_uring")), HAKO_PDU_ERR_OK);
+        wait_and_check();
+        ASSERT_EQ(tx.stop(), HAKO_PDU_ERR_OK);
+        ASSERT_EQ(rx.stop(), HAKO_PDU_ERR_OK);
+        ASSERT_EQ(tx.close(), HAKO_PDU_ERR_OK);
+        ASSERT_EQ(rx.close(), HAKO_PDU_ERR_OK);
+    }
+    {
+        // TcpComm::raw_send_batch: linked sends with io_uring, one send per frame otherwise.
+        hakoniwa::pdu::comm::TcpComm server;
+        hakoniwa::pdu::comm::TcpComm client;
+        ASSERT_EQ(server.open("test/test_comm_tcp_uring_server.json"), HAKO_PDU_ERR_OK);
+        ASSERT_EQ(client.open("test/test_comm_tcp_uring_client.json"), HAKO_PDU_ERR_OK);
+        std::atomic<int> connected{0};
+        server.set_on_recv_callback(on_recv);
+        server.set_on_connected_callback([&connected]() { connected++; });
+        client.set_on_connected_callback([&connected]() { connected++; });
+        ASSERT_EQ(server.start(), HAKO_PDU_ERR_OK);
+        ASSERT_EQ(client.start(), HAKO_PDU_ERR_OK);
+        for (int i = 0; i < 200 && connected.load() < 2; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        ASSERT_EQ(connected.load(), 2);
+        ASSERT_EQ(client.send_batch(make_items("robot_uring")), HAKO_PDU_ERR_OK);
+        wait_and_check();
+        ASSERT_EQ(client.stop(), HAKO_PDU_ERR_OK);
+        ASSERT_EQ(server.stop(), HAKO_PDU_ERR_OK);
+        ASSERT_EQ(client.close(), HAKO_PDU_ERR_OK);
+        ASSERT_EQ(server.close(), HAKO_PDU_ERR_OK);
+    }
+}
+
+TEST_F(EndpointTest, UdpGsoGroTest) {
+    // Equal-sized frames are coalesced with UDP_SEGMENT and may arrive GRO-merged;
+    // either way the receiver must see every frame, in order, with its own key.
+    hakoniwa::pdu::comm::UdpComm rx;
+    hakoniwa::pdu::comm::UdpComm tx;
+    ASSERT_EQ(rx.open("test/test_comm_udp_gro_in.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(tx.open("test/test_comm_udp_gso_out.json"), HAKO_PDU_ERR_OK);
+
+    std::mutex mtx;
+    std::vector<std::pair<HakoPduChannelIdType, std::vector<std::byte>>> received;
+    rx.set_on_recv_callback([&](const hakoniwa::pdu::PduResolvedKey& key, std::span<const std::byte> data) {
+        std::lock_guard<std::mutex> lock(mtx);
+        received.emplace_back(key.channel_id, std::vector<std::byte>(data.begin(), data.end()));
+    });
+    ASSERT_EQ(rx.start(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(tx.start(), HAKO_PDU_ERR_OK);
+
+    // 8 x 100 bytes, then a run of 3 x 40 bytes ending with a shorter 8-byte frame.
+    std::vector<std::vector<std::byte>> payloads;
+    for (int i = 0; i < 8; ++i) {
+        payloads.emplace_back(100, static_cast<std::byte>('A' + i));
+    }
+    for (int i = 0; i < 3; ++i) {
+        payloads.emplace_back(40, static_cast<std::byte>('a' + i));
+    }
+    payloads.emplace_back(8, std::byte{'z'});
+    std::vector<hakoniwa::pdu::PduSendItem> items;
+    for (size_t i = 0; i < payloads.size(); ++i) {
+        items.push_back(hakoniwa::pdu::PduSendItem{create_key("robot_gso", static_cast<HakoPduChannelIdType>(i)), payloads[i]});
+    }
+    ASSERT_EQ(tx.send_batch(items), HAKO_PDU_ERR_OK);
+
+    for (int i = 0; i < 100; ++i) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (received.size() >= payloads.size()) {
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        ASSERT_EQ(received.size(), payloads.size());
+        for (size_t i = 0; i < payloads.size(); ++i) {
+            EXPECT_EQ(received[i].first, static_cast<HakoPduChannelIdType>(i));
+            EXPECT_EQ(received[i].second, payloads[i]);
+        }
+    }
+
+    ASSERT_EQ(tx.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(rx.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(tx.close(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(rx.close(), HAKO_PDU_ERR_OK);
+}
+
+TEST_F(EndpointTest, UdpFragmentationTest) {
+    // PDUs above the 64 KiB datagram limit are split into 1200-byte fragments and reassembled.
+    hakoniwa::pdu::comm::UdpComm rx;
+    hakoniwa::pdu::comm::UdpComm tx;
+    ASSERT_EQ(rx.open("test/test_comm_udp_frag_in.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(tx.open("test/test_comm_udp_frag_out.json"), HAKO_PDU_ERR_OK);
+
+    std::mutex mtx;
+    std::vector<std::pair<HakoPduChannelIdType, std::vector<std::byte>>> received;
+    rx.set_on_recv_callback([&](const hakoniwa::pdu::PduResolvedKey& key, std::span<const std::byte> data) {
+        std::lock_guard<std::mutex> lock(mtx);
+        received.emplace_back(key.channel_id, std::vector<std::byte>(data.begin(), data.end()));
+    });
+    ASSERT_EQ(rx.start(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(tx.start(), HAKO_PDU_ERR_OK);
+
+    std::vector<std::byte> big(200000);
+    for (size_t i = 0; i < big.size(); ++i) {
+        big[i] = static_cast<std::byte>(i * 31);
+    }
+    std::vector<std::byte> small(16, std::byte{'s'});
+    std::vector<std::byte> big2(5000, std::byte{'b'});
+    ASSERT_EQ(tx.send(create_key("robot_frag", 1), big), HAKO_PDU_ERR_OK);
+    std::vector<hakoniwa::pdu::PduSendItem> items = {
+        {create_key("robot_frag", 2), small},
+        {create_key("robot_frag", 3), big2},
+        {create_key("robot_frag", 4), small},
+    };
+    ASSERT_EQ(tx.send_batch(items), HAKO_PDU_ERR_OK);
+
+    for (int i = 0; i < 100; ++i) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (received.size() >= 4) {
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        ASSERT_EQ(received.size(), 4u);
+        EXPECT_EQ(received[0].first, 1);
+        EXPECT_EQ(received[0].second, big);
+        EXPECT_EQ(received[1].second, small);
+        EXPECT_EQ(received[2].first, 3);
+        EXPECT_EQ(received[2].second, big2);
+        EXPECT_EQ(received[3].first, 4);
+    }
+
+    ASSERT_EQ(tx.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(rx.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(tx.close(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(rx.close(), HAKO_PDU_ERR_OK);
+}
+
+TEST_F(EndpointTest, UdpFragmentLatestWinsTest) {
+    hakoniwa::pdu::comm::UdpComm rx;
+    ASSERT_EQ(rx.open("test/test_comm_udp_frag_in.json"), HAKO_PDU_ERR_OK);
+    std::mutex mtx;
+    std::vector<std::vector<std::byte>> received;
+    rx.set_on_recv_callback([&](const hakoniwa::pdu::PduResolvedKey&, std::span<const std::byte> data) {
+        std::lock_guard<std::mutex> lock(mtx);
+        received.emplace_back(data.begin(), data.end());
+    });
+    ASSERT_EQ(rx.start(), HAKO_PDU_ERR_OK);
+
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(sock, 0);
+    sockaddr_in to{};
+    to.sin_family = AF_INET;
+    to.sin_port = htons(54009);
+    to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    // Hand-built fragments (see the header layout in comm_udp.cpp), 3 per message.
+    auto make_frame = [](char fill) {
+        std::vector<std::byte> body(3000, static_cast<std::byte>(fill));
+        hakoniwa::pdu::comm::MetaPdu meta;
+        hakoniwa::pdu::comm::DataPacket::init_meta(meta, "robot_frag", 5);
+        std::vector<std::byte> frame;
+        hakoniwa::pdu::comm::DataPacket::encode_into(frame, meta, body);
+        return std::make_pair(body, frame);
+    };
+    uint32_t robot_id = 2166136261u; // FNV-1a of the robot name
+    for (char ch : std::string("robot_frag")) {
+        robot_id = (robot_id ^ static_cast<uint8_t>(ch)) * 16777619u;
+    }
+    auto send_fragment_from = [&](int from, uint32_t message_id, const std::vector<std::byte>& frame, uint16_t index) {
+        const size_t chunk = (frame.size() + 2) / 3;
+        const size_t offset = index * chunk;
+        const size_t len = std::min(chunk, frame.size() - offset);
+        const uint32_t fields[] = {0x524648F7, message_id, robot_id, 5, static_cast<uint32_t>(frame.size()),
+                                   static_cast<uint32_t>(offset)};
+        std::vector<std::byte> dgram(28 + len);
+        for (size_t f = 0; f < 6; ++f) {
+            for (size_t b = 0; b < 4; ++b) {
+                dgram[f * 4 + b] = static_cast<std::byte>((fields[f] >> (8 * b)) & 0xFF);
+            }
+        }
+        dgram[24] = static_cast<std::byte>(index);
+        dgram[26] = std::byte{3};
+        std::memcpy(dgram.data() + 28, frame.data() + offset, len);
+        ASSERT_GT(sendto(from, dgram.data(), dgram.size(), 0, reinterpret_cast<sockaddr*>(&to), sizeof(to)), 0);
+    };
+    auto send_fragment = [&](uint32_t message_id, const std::vector<std::byte>& frame, uint16_t index) {
+        send_fragment_from(sock, message_id, frame, index);
+    };
+
+    auto [a_body, a] = make_frame('a');
+    auto [b_body, b] = make_frame('b');
+    auto [c_body, c] = make_frame('c');
+    auto [d_body, d] = make_frame('d');
+    // A is incomplete when B starts: B wins and A's late fragments are dropped.
+    send_fragment(10, a, 0);
+    for (uint16_t i = 0; i < 3; ++i) send_fragment(11, b, i);
+    send_fragment(10, a, 1);
+    send_fragment(10, a, 2);
+    // C stalls past reassembly_timeout_ms and is discarded.
+    send_fragment(12, c, 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    send_fragment(12, c, 1);
+    send_fragment(12, c, 2);
+    for (uint16_t i = 0; i < 3; ++i) send_fragment(13, d, i);
+    // Another sender on the same channel is a separate stream: interleaved, E and F both complete.
+    int sock2 = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(sock2, 0);
+    auto [e_body, e] = make_frame('e');
+    auto [f_body, f] = make_frame('f');
+    for (uint16_t i = 0; i < 3; ++i) {
+        send_fragment(20, e, i);
+        send_fragment_from(sock2, 900, f, i);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    close(sock2);
+    close(sock);
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        ASSERT_EQ(received.size(), 4u);
+        EXPECT_EQ(received[0], b_body);
+        EXPECT_EQ(received[1], d_body);
+        EXPECT_EQ(received[2], e_body);
+        EXPECT_EQ(received[3], f_body);
+    }
+    ASSERT_EQ(rx.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(rx.close(), HAKO_PDU_ERR_OK);
+}
+
+TEST_F(EndpointTest, UdpSequenceNumberTest) {
+    hakoniwa::pdu::Endpoint server("udp_seq_in", HAKO_PDU_ENDPOINT_DIRECTION_IN);
+    hakoniwa::pdu::Endpoint client("udp_seq_out", HAKO_PDU_ENDPOINT_DIRECTION_OUT);
+    ASSERT_EQ(server.open("test/test_endpoint_udp_seq_in.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client.open("test/test_endpoint_udp_seq_out.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(server.start(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client.start(), HAKO_PDU_ERR_OK);
+
+    // In-order samples from a sequence-stamping comm.
+    auto key = create_key("robot_seq", 1);
+    for (int i = 0; i < 3; ++i) {
+        std::vector<std::byte> msg(4, static_cast<std::byte>('0' + i));
+        ASSERT_EQ(client.send(key, msg), HAKO_PDU_ERR_OK);
+    }
+
+    // Hand-stamped frames on channel 2, arriving 1 2 4 3 4 5 8.
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(sock, 0);
+    sockaddr_in to{};
+    to.sin_family = AF_INET;
+    to.sin_port = htons(54010);
+    to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    auto send_seq = [&](uint64_t seq) {
+        std::vector<std::byte> body(4, static_cast<std::byte>('0' + seq));
+        hakoniwa::pdu::comm::MetaPdu meta;
+        hakoniwa::pdu::comm::DataPacket::init_meta(meta, "robot_seq", 2);
+        std::vector<std::byte> frame;
+        hakoniwa::pdu::comm::DataPacket::encode_into(frame, meta, body);
+        hakoniwa::pdu::comm::DataPacket::stamp_sequence(frame, seq, 7);
+        ASSERT_GT(sendto(sock, frame.data(), frame.size(), 0, reinterpret_cast<sockaddr*>(&to), sizeof(to)), 0);
+    };
+    {
+        // Re-encoding a received meta must not carry over its stamp.
+        hakoniwa::pdu::comm::MetaPdu meta;
+        hakoniwa::pdu::comm::DataPacket::init_meta(meta, "robot_seq", 2);
+        std::vector<std::byte> frame;
+        hakoniwa::pdu::comm::DataPacket::encode_into(frame, meta, std::vector<std::byte>(4));
+        hakoniwa::pdu::comm::DataPacket::stamp_sequence(frame, 9, 7);
+        hakoniwa::pdu::comm::DataPacketView view;
+        ASSERT_TRUE(hakoniwa::pdu::comm::DataPacket::decode_view(frame, "v2", view));
+        std::vector<std::byte> reencoded;
+        hakoniwa::pdu::comm::DataPacket::encode_into(reencoded, view.meta, view.body);
+        ASSERT_TRUE(hakoniwa::pdu::comm::DataPacket::decode_view(reencoded, "v2", view));
+        uint64_t seq = 0;
+        uint32_t epoch = 0;
+        EXPECT_FALSE(hakoniwa::pdu::comm::DataPacket::get_sequence(view.meta, seq, epoch));
+    }
+    std::vector<std::byte> buf(8);
+    size_t len = 0;
+    for (uint64_t seq : {1, 2, 4, 3}) {
+        send_seq(seq);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    // The late "3" must not overwrite the newer "4" in the latest-value cache.
+    ASSERT_EQ(server.recv(create_key("robot_seq", 2), buf, len), HAKO_PDU_ERR_OK);
+    EXPECT_EQ(buf[0], std::byte{'4'});
+    for (uint64_t seq : {4, 5, 8}) {
+        send_seq(seq);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    close(sock);
+
+    std::vector<hakoniwa::pdu::PduChannelStats> stats;
+    ASSERT_EQ(server.get_comm_channel_stats(stats), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(stats.size(), 2u);
+    for (const auto& st : stats) {
+        if (st.key.channel_id == 1) {
+            EXPECT_EQ(st.received, 3u);
+            EXPECT_EQ(st.last_sequence, 3u);
+            EXPECT_EQ(st.lost, 0u);
+        } else {
+            EXPECT_EQ(st.received, 5u);     // 1 2 4 5 8
+            EXPECT_EQ(st.reordered, 1u);    // 3
+            EXPECT_EQ(st.duplicates, 1u);   // second 4
+            EXPECT_EQ(st.lost, 2u);         // 6 7
+            EXPECT_EQ(st.last_sequence, 8u);
+        }
+    }
+    ASSERT_EQ(server.recv(create_key("robot_seq", 2), buf, len), HAKO_PDU_ERR_OK);
+    EXPECT_EQ(buf[0], std::byte{'8'});
+
+    ASSERT_EQ(client.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(server.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client.close(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(server.close(), HAKO_PDU_ERR_OK);
+}
+
+TEST_F(EndpointTest, LatencyHistogramPercentileTest) {
+    hakoniwa::pdu::LatencyHistogram hist;
+    for (int v = 1; v <= 10000; ++v) {
+        hist.record(v);
+    }
+    hist.record(-5); // clock skew clamps to 0
+    const auto s = hist.summary();
+    EXPECT_EQ(s.count, 10001u);
+    EXPECT_EQ(s.min_us, 0);
+    EXPECT_EQ(s.max_us, 10000);
+    // Log-linear buckets: within 1/32 of the exact percentile.
+    EXPECT_NEAR(static_cast<double>(s.p50_us), 5000.0, 5000.0 / 32);
+    EXPECT_NEAR(static_cast<double>(s.p99_us), 9900.0, 9900.0 / 32);
+    EXPECT_LE(s.p999_us, 10000);
+    EXPECT_EQ(hist.value_at_percentile(100.0), 10000);
+    hist.reset();
+    EXPECT_EQ(hist.summary().count, 0u);
+}
+
+TEST_F(EndpointTest, UdpLatencyTrackingTest) {
+    hakoniwa::pdu::Endpoint server("udp_latency_in", HAKO_PDU_ENDPOINT_DIRECTION_IN);
+    hakoniwa::pdu::Endpoint client("udp_latency_out", HAKO_PDU_ENDPOINT_DIRECTION_OUT);
+    ASSERT_EQ(server.open("test/test_endpoint_udp_latency_in.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client.open("test/test_endpoint_udp_latency_out.json"), HAKO_PDU_ERR_OK);
+    std::atomic<int> received{0};
+    auto key = create_key("robot_latency", 1);
+    server.subscribe_on_recv_callback(key, [&](const hakoniwa::pdu::PduResolvedKey&, std::span<const std::byte>) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        received.fetch_add(1);
+    });
+    ASSERT_EQ(server.start(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client.start(), HAKO_PDU_ERR_OK);
+
+    constexpr int kCount = 10;
+    std::vector<std::byte> msg(64, std::byte{0x42});
+    for (int i = 0; i < kCount; ++i) {
+        ASSERT_EQ(client.send(key, msg), HAKO_PDU_ERR_OK);
+    }
+    for (int w = 0; w < 100 && received.load() < kCount; ++w) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ(received.load(), kCount);
+
+    std::vector<hakoniwa::pdu::PduLatencyStats> stats;
+    ASSERT_EQ(server.get_latency_stats(stats), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(stats.size(), 1u);
+    const auto& st = stats[0];
+    EXPECT_EQ(st.key.robot, "robot_latency");
+    EXPECT_EQ(st.wire.count, static_cast<uint64_t>(kCount));
+    EXPECT_EQ(st.stack.count, static_cast<uint64_t>(kCount));
+    EXPECT_EQ(st.total.count, static_cast<uint64_t>(kCount));
+    EXPECT_GE(st.dispatch.min_us, 2000);   // the subscriber sleeps 2 ms
+    EXPECT_GE(st.total.p50_us, st.dispatch.p50_us);
+    EXPECT_LT(st.wire.max_us, 1000000);    // same host: no clock offset
+    // Later samples wait in the socket queue behind the sleeping callback, which the
+    // kernel timestamp attributes to the stack stage.
+    EXPECT_GE(st.stack.max_us, 2000);
+    std::vector<hakoniwa::pdu::PduLatencyStats> none;
+    EXPECT_EQ(client.get_latency_stats(none), HAKO_PDU_ERR_OK);
+    EXPECT_TRUE(none.empty());
+
+    ASSERT_EQ(server.reset_latency_stats(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(server.get_latency_stats(stats), HAKO_PDU_ERR_OK);
+    EXPECT_EQ(stats[0].total.count, 0u);
+
+    ASSERT_EQ(client.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(server.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client.close(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(server.close(), HAKO_PDU_ERR_OK);
+}
+
+TEST_F(EndpointTest, UdpReceiverThreadsTest) {
+    // 4 SO_REUSEPORT sockets on one port; each sender is one flow and must stay in order.
+    hakoniwa::pdu::comm::UdpComm rx;
+    ASSERT_EQ(rx.open("test/test_comm_udp_reuseport_in.json"), HAKO_PDU_ERR_OK);
+    std::mutex mtx;
+    std::map<HakoPduChannelIdType, std::vector<int>> received;
+    rx.set_on_recv_callback([&](const hakoniwa::pdu::PduResolvedKey& key, std::span<const std::byte> data) {
+        std::lock_guard<std::mutex> lock(mtx);
+        received[key.channel_id].push_back(static_cast<int>(data[0]));
+    });
+
+    constexpr int kSenders = 6;
+    constexpr int kMessages = 50;
+    for (int round = 0; round < 2; ++round) {
+        // The second round checks that every receiver thread restarts.
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            received.clear();
+        }
+        ASSERT_EQ(rx.start(), HAKO_PDU_ERR_OK);
+        std::vector<std::unique_ptr<hakoniwa::pdu::comm::UdpComm>> senders;
+        for (int i = 0; i < kSenders; ++i) {
+            senders.push_back(std::make_unique<hakoniwa::pdu::comm::UdpComm>());
+            ASSERT_EQ(senders.back()->open("test/test_comm_udp_reuseport_out.json"), HAKO_PDU_ERR_OK);
+            ASSERT_EQ(senders.back()->start(), HAKO_PDU_ERR_OK);
+        }
+        for (int m = 0; m < kMessages; ++m) {
+            for (int i = 0; i < kSenders; ++i) {
+                std::vector<std::byte> msg(1, static_cast<std::byte>(m));
+                ASSERT_EQ(senders[i]->send(create_key("robot_rp", i), msg), HAKO_PDU_ERR_OK);
+            }
+        }
+        for (int w = 0; w < 100; ++w) {
+            size_t total = 0;
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                for (const auto& entry : received) {
+                    total += entry.second.size();
+                }
+            }
+            if (total >= kSenders * kMessages) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            ASSERT_EQ(received.size(), static_cast<size_t>(kSenders));
+            for (const auto& entry : received) {
+                ASSERT_EQ(entry.second.size(), static_cast<size_t>(kMessages)) << "channel " << entry.first;
+                for (int m = 0; m < kMessages; ++m) {
+                    EXPECT_EQ(entry.second[m], m) << "channel " << entry.first;
+                }
+            }
+        }
+        for (auto& sender : senders) {
+            ASSERT_EQ(sender->stop(), HAKO_PDU_ERR_OK);
+            ASSERT_EQ(sender->close(), HAKO_PDU_ERR_OK);
+        }
+        ASSERT_EQ(rx.stop(), HAKO_PDU_ERR_OK);
+    }
+    ASSERT_EQ(rx.close(), HAKO_PDU_ERR_OK);
+}
+
+TEST_F(EndpointTest, UdpRxqOverflowStatsTest) {
+    // A tiny SO_RCVBUF overflows while nobody reads; the next datagrams carry the
+    // SO_RXQ_OVFL counter, which shows up in the stats and grows the buffer.
+    hakoniwa::pdu::comm::UdpComm rx;
+    hakoniwa::pdu::comm::UdpComm tx;
+    ASSERT_EQ(rx.open("test/test_comm_udp_rxq_in.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(tx.open("test/test_comm_udp_rxq_out.json"), HAKO_PDU_ERR_OK);
+    hakoniwa::pdu::PduCommSocketStats stats;
+    ASSERT_EQ(rx.get_socket_stats(stats), HAKO_PDU_ERR_OK);
+    EXPECT_EQ(stats.rx_dropped, 0u);
+    const int initial_rcvbuf = stats.recv_buffer_size;
+    EXPECT_GT(initial_rcvbuf, 0);
+
+    std::atomic<int> received{0};
+    rx.set_on_recv_callback([&](const hakoniwa::pdu::PduResolvedKey&, std::span<const std::byte>) {
+        received.fetch_add(1);
+    });
+    ASSERT_EQ(tx.start(), HAKO_PDU_ERR_OK);
+    std::vector<std::byte> payload(512, std::byte{0x11});
+    for (int i = 0; i < 200; ++i) {
+        ASSERT_EQ(tx.send(create_key("robot_rxq", 1), payload), HAKO_PDU_ERR_OK);
+    }
+    ASSERT_EQ(rx.start(), HAKO_PDU_ERR_OK);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    const int drained = received.load();
+    EXPECT_LT(drained, 200);
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_EQ(tx.send(create_key("robot_rxq", 1), payload), HAKO_PDU_ERR_OK);
+    }
+    for (int w = 0; w < 50 && received.load() < drained + 3; ++w) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ(rx.get_socket_stats(stats), HAKO_PDU_ERR_OK);
+    EXPECT_EQ(stats.rx_dropped, static_cast<uint64_t>(200 - drained));
+    EXPECT_GE(stats.recv_buffer_grows, 1u);
+    EXPECT_GT(stats.recv_buffer_size, initial_rcvbuf);
+
+    ASSERT_EQ(tx.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(rx.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(tx.close(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(rx.close(), HAKO_PDU_ERR_OK);
+}
+
+TEST_F(EndpointTest, UdpFanoutTest) {
+    // "remote" + "remotes": every frame is encoded once and reaches both receivers.
+    hakoniwa::pdu::comm::UdpComm rx_a;
+    hakoniwa::pdu::comm::UdpComm rx_b;
+    hakoniwa::pdu::comm::UdpComm tx;
+    ASSERT_EQ(rx_a.open("test/test_comm_udp_fanout_in_a.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(rx_b.open("test/test_comm_udp_fanout_in_b.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(tx.open("test/test_comm_udp_fanout_out.json"), HAKO_PDU_ERR_OK);
+    std::mutex mtx;
+    std::vector<int> received_a;
+    std::vector<int> received_b;
+    rx_a.set_on_recv_callback([&](const hakoniwa::pdu::PduResolvedKey&, std::span<const std::byte> data) {
+        std::lock_guard<std::mutex> lock(mtx);
+        received_a.push_back(static_cast<int>(data[0]));
+    });
+    rx_b.set_on_recv_callback([&](const hakoniwa::pdu::PduResolvedKey&, std::span<const std::byte> data) {
+        std::lock_guard<std::mutex> lock(mtx);
+        received_b.push_back(static_cast<int>(data[0]));
+    });
+    ASSERT_EQ(rx_a.start(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(rx_b.start(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(tx.start(), HAKO_PDU_ERR_OK);
+
+    constexpr int kBatch = 20; // more than send_batch x destinations per sendmmsg
+    std::vector<std::vector<std::byte>> payloads;
+    for (int i = 0; i < kBatch; ++i) {
+        payloads.emplace_back(16, static_cast<std::byte>(i));
+    }
+    std::vector<hakoniwa::pdu::PduSendItem> items;
+    for (const auto& payload : payloads) {
+        items.push_back(hakoniwa::pdu::PduSendItem{create_key("robot_fanout", 1), payload});
+    }
+    ASSERT_EQ(tx.send_batch(items), HAKO_PDU_ERR_OK);
+    std::vector<std::byte> last(16, static_cast<std::byte>(kBatch));
+    ASSERT_EQ(tx.send(create_key("robot_fanout", 1), last), HAKO_PDU_ERR_OK);
+
+    for (int w = 0; w < 100; ++w) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (received_a.size() >= kBatch + 1 && received_b.size() >= kBatch + 1) {
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        ASSERT_EQ(received_a.size(), static_cast<size_t>(kBatch + 1));
+        ASSERT_EQ(received_b.size(), static_cast<size_t>(kBatch + 1));
+        for (int i = 0; i <= kBatch; ++i) {
+            EXPECT_EQ(received_a[i], i);
+            EXPECT_EQ(received_b[i], i);
+        }
+    }
+    ASSERT_EQ(tx.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(rx_a.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(rx_b.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(tx.close(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(rx_a.close(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(rx_b.close(), HAKO_PDU_ERR_OK);
+}
+
+TEST_F(EndpointTest, UdpMulticastChannelGroupsTest) {
+    // Each channel has its own group; a receiver only joins the groups it subscribes to,
+    // so the kernel filters the other channel even though both share the port.
+    hakoniwa::pdu::comm::UdpComm rx1;
+    hakoniwa::pdu::comm::UdpComm rx2;
+    hakoniwa::pdu::comm::UdpComm tx;
+    ASSERT_EQ(rx1.open("test/test_comm_udp_mcast_channel1_in.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(rx2.open("test/test_comm_udp_mcast_channel2_in.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(tx.open("test/test_comm_udp_mcast_channels_out.json"), HAKO_PDU_ERR_OK);
+    std::mutex mtx;
+    std::vector<HakoPduChannelIdType> received1;
+    std::vector<HakoPduChannelIdType> received2;
+    rx1.set_on_recv_callback([&](const hakoniwa::pdu::PduResolvedKey& key, std::span<const std::byte>) {
+        std::lock_guard<std::mutex> lock(mtx);
+        received1.push_back(key.channel_id);
+    });
+    rx2.set_on_recv_callback([&](const hakoniwa::pdu::PduResolvedKey& key, std::span<const std::byte>) {
+        std::lock_guard<std::mutex> lock(mtx);
+        received2.push_back(key.channel_id);
+    });
+    ASSERT_EQ(rx1.start(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(rx2.start(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(tx.start(), HAKO_PDU_ERR_OK);
+
+    std::vector<std::byte> payload(8, std::byte{0x42});
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_EQ(tx.send(create_key("robot_mcast", 1), payload), HAKO_PDU_ERR_OK);
+        ASSERT_EQ(tx.send(create_key("robot_mcast", 2), payload), HAKO_PDU_ERR_OK);
+    }
+    for (int w = 0; w < 100; ++w) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (received1.size() >= 5 && received2.size() >= 5) {
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50)); // let stray datagrams arrive
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        ASSERT_EQ(received1.size(), 5u);
+        ASSERT_EQ(received2.size(), 5u);
+        for (size_t i = 0; i < 5; ++i) {
+            EXPECT_EQ(received1[i], 1);
+            EXPECT_EQ(received2[i], 2);
+        }
+    }
+    ASSERT_EQ(tx.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(rx1.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(rx2.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(tx.close(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(rx1.close(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(rx2.close(), HAKO_PDU_ERR_OK);
+}
+
+TEST_F(EndpointTest, WebSocketCommunicationTest) {
+    int server_port = find_available_port(SOCK_STREAM);
+    ASSERT_GT(server_port, 0);
+
+    hakoniwa::pdu::Endpoint server("ws_server", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+    hakoniwa::pdu::Endpoint client("ws_client", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+
+
+    ASSERT_EQ(server.open("test/test_endpoint_ws_server.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client.open("test/test_endpoint_ws_client.json"), HAKO_PDU_ERR_OK);
+    
+    // Start server first, then client connects
+    ASSERT_EQ(server.start(), HAKO_PDU_ERR_OK);
+    std::this_thread::sleep_for(std::chrono::milliseconds(500)); // Give server time to start accepting
+
+    ASSERT_EQ(client.start(), HAKO_PDU_ERR_OK);
+    std::this_thread::sleep_for(std::chrono::milliseconds(500)); // Give client time to connect
+
+    auto key = create_key("robot_ws", 30);
+    std::vector<std::byte> client_msg = {(std::byte)'W', (std::byte)'e', (std::byte)'b', (std::byte)'S', (std::byte)'o', (std::byte)'c', (std::byte)'k', (std::byte)'e', (std::byte)'t'};
+
+    // Client sends message to server
+    ASSERT_EQ(client.send(key, client_msg), HAKO_PDU_ERR_OK);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::vector<std::byte> server_buf(client_msg.size());
+    size_t server_len = 0;
+    ASSERT_EQ(server.recv(key, server_buf, server_len), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(server_len, client_msg.size());
+    EXPECT_EQ(server_buf, client_msg);
+    
+    std::vector<std::byte> server_msg = {(std::byte)'H', (std::byte)'e', (std::byte)'l', (std::byte)'l', (std::byte)'o', (std::byte)' ', (std::byte)'C', (std::byte)'l', (std::byte)'i', (std::byte)'e', (std::byte)'n', (std::byte)'t'};
+
+    // Server sends message to client
     ASSERT_EQ(server.send(key, server_msg), HAKO_PDU_ERR_OK);
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
 
@@ -532,5 +2089,358 @@ TEST_F(EndpointTest, WebSocketCommunicationInOutTest) {
     ASSERT_EQ(client.stop(), HAKO_PDU_ERR_OK);
     ASSERT_EQ(server.close(), HAKO_PDU_ERR_OK);
     ASSERT_EQ(client.close(), HAKO_PDU_ERR_OK);
+ 
+}
+
+TEST_F(EndpointTest, WebSocketCommunicationInOutTest) {
+    int server_port = find_available_port(SOCK_STREAM);
+    ASSERT_GT(server_port, 0);
+
+
+    hakoniwa::pdu::Endpoint server("ws_server_inout", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+    hakoniwa::pdu::Endpoint client("ws_client_inout", HAKO_PDU_ENDPOINT_DIRECTION_INOUT);
+
+
+    ASSERT_EQ(server.open("test/test_endpoint_ws_server_inout.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client.open("test/test_endpoint_ws_client_inout.json"), HAKO_PDU_ERR_OK);
+    
+    // Start server first, then client connects
+    ASSERT_EQ(server.start(), HAKO_PDU_ERR_OK);
+    std::this_thread::sleep_for(std::chrono::milliseconds(500)); // Give server time to start accepting
+
+    ASSERT_EQ(client.start(), HAKO_PDU_ERR_OK);
+    std::this_thread::sleep_for(std::chrono::milliseconds(500)); // Give client time to connect
+
+    auto key = create_key("robot_ws_inout", 40);
+    std::vector<std::byte> client_msg = {(std::byte)'I', (std::byte)'N', (std::byte)'O', (std::byte)'U', (std::byte)'T', (std::byte)' ', (std::byte)'C', (std::byte)'L', (std::byte)'I', (std::byte)'E', (std::byte)'N', (std::byte)'T'};
+
+    // Client sends message to server
+    ASSERT_EQ(client.send(key, client_msg), HAKO_PDU_ERR_OK);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::vector<std::byte> server_buf(client_msg.size());
+    size_t server_len = 0;
+    ASSERT_EQ(server.recv(key, server_buf, server_len), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(server_len, client_msg.size());
+    EXPECT_EQ(server_buf, client_msg);
     
+    std::vector<std::byte> server_msg = {(std::byte)'I', (std::byte)'N', (std::byte)'O', (std::byte)'U', (std::byte)'T', (std::byte)' ', (std::byte)'S', (std::byte)'E', (std::byte)'R', (std::byte)'V', (std::byte)'E', (std::byte)'R'};
+
+    // Server sends message to client
+    ASSERT_EQ(server.send(key, server_msg), HAKO_PDU_ERR_OK);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::vector<std::byte> client_buf(server_msg.size());
+    size_t client_len = 0;
+    ASSERT_EQ(client.recv(key, client_buf, client_len), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client_len, server_msg.size());
+    EXPECT_EQ(client_buf, server_msg);
+
+    ASSERT_EQ(server.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client.stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(server.close(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client.close(), HAKO_PDU_ERR_OK);
+    
+}
+
+TEST_F(EndpointTest, WebSocketBroadcastTest) {
+    // One server comm broadcasting to three clients; every client gets every frame in order.
+    constexpr int kClients = 3;
+    constexpr int kFrames = 20;
+    auto server = std::make_shared<hakoniwa::pdu::comm::WebSocketComm>();
+    ASSERT_EQ(server->open("test/test_comm_ws_broadcast_server.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(server->start(), HAKO_PDU_ERR_OK);
+
+    std::mutex mtx;
+    std::vector<std::vector<int>> received(kClients);
+    std::vector<std::shared_ptr<hakoniwa::pdu::comm::WebSocketComm>> clients;
+    for (int c = 0; c < kClients; ++c) {
+        auto client = std::make_shared<hakoniwa::pdu::comm::WebSocketComm>();
+        ASSERT_EQ(client->open("test/test_comm_ws_broadcast_client.json"), HAKO_PDU_ERR_OK);
+        client->set_on_recv_callback([&, c](const hakoniwa::pdu::PduResolvedKey&, std::span<const std::byte> data) {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (data.size() == 64 * 1024) {
+                received[c].push_back(static_cast<int>(data[0]));
+            }
+        });
+        ASSERT_EQ(client->start(), HAKO_PDU_ERR_OK);
+        clients.push_back(client);
+    }
+    for (auto& client : clients) {
+        bool running = false;
+        for (int w = 0; w < 100 && !running; ++w) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            client->is_running(running);
+        }
+        ASSERT_TRUE(running);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100)); // server side handshakes
+
+    auto key = create_key("robot_ws_bcast", 1);
+    for (int i = 0; i < kFrames; ++i) {
+        std::vector<std::byte> frame(64 * 1024, static_cast<std::byte>(i));
+        ASSERT_EQ(server->send(key, frame), HAKO_PDU_ERR_OK);
+    }
+    auto all_done = [&]() {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (const auto& r : received) {
+            if (r.size() < static_cast<size_t>(kFrames)) {
+                return false;
+            }
+        }
+        return true;
+    };
+    for (int w = 0; w < 200 && !all_done(); ++w) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (const auto& r : received) {
+            ASSERT_EQ(r.size(), static_cast<size_t>(kFrames));
+            for (int i = 0; i < kFrames; ++i) {
+                EXPECT_EQ(r[i], i);
+            }
+        }
+    }
+
+    for (auto& client : clients) {
+        ASSERT_EQ(client->stop(), HAKO_PDU_ERR_OK);
+        ASSERT_EQ(client->close(), HAKO_PDU_ERR_OK);
+    }
+    ASSERT_EQ(server->stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(server->close(), HAKO_PDU_ERR_OK);
+}
+
+TEST_F(EndpointTest, WebSocketSlowConsumerTest) {
+    // A client that never reads: the server's send queue must stay bounded under every policy.
+    namespace net = boost::asio;
+    namespace websocket = boost::beast::websocket;
+    for (const std::string policy : {"drop_oldest", "conflate", "disconnect"}) {
+        SCOPED_TRACE(policy);
+        auto server = std::make_shared<hakoniwa::pdu::comm::WebSocketComm>();
+        ASSERT_EQ(server->open("test/test_comm_ws_slow_" + policy + ".json"), HAKO_PDU_ERR_OK);
+        ASSERT_EQ(server->start(), HAKO_PDU_ERR_OK);
+
+        net::io_context ioc;
+        net::ip::tcp::socket socket(ioc);
+        socket.open(net::ip::tcp::v4());
+        socket.set_option(net::socket_base::receive_buffer_size(4096));
+        socket.connect({net::ip::make_address("127.0.0.1"), 54019});
+        websocket::stream<net::ip::tcp::socket> slow(std::move(socket));
+        slow.handshake("127.0.0.1", "/");
+
+        std::vector<hakoniwa::pdu::comm::WebSocketSessionStats> stats;
+        for (int w = 0; w < 100; ++w) {
+            ASSERT_EQ(server->get_session_stats(stats), HAKO_PDU_ERR_OK);
+            if (!stats.empty()) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        ASSERT_EQ(stats.size(), 1u);
+
+        constexpr int kFrames = 200;
+        std::vector<std::byte> payload(64 * 1024, std::byte{0x33});
+        for (int i = 0; i < kFrames; ++i) {
+            const HakoPduErrorType err = server->send(create_key("robot_ws_slow", 1 + i % 2), payload);
+            if (policy != "disconnect") { // once dropped there is no session left to send to
+                ASSERT_EQ(err, HAKO_PDU_ERR_OK);
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+        ASSERT_EQ(server->get_session_stats(stats), HAKO_PDU_ERR_OK);
+        if (policy == "disconnect") {
+            EXPECT_TRUE(stats.empty());
+            EXPECT_EQ(server->slow_consumer_disconnects(), 1u);
+        } else {
+            ASSERT_EQ(stats.size(), 1u);
+            const auto& st = stats[0];
+            EXPECT_EQ(st.sent + st.dropped + st.conflated + st.queued_messages, static_cast<uint64_t>(kFrames));
+            EXPECT_LE(st.queued_messages, 8u);
+            EXPECT_EQ(st.queued_bytes, st.queued_messages * (payload.size() + sizeof(hakoniwa::pdu::comm::MetaPdu)));
+            if (policy == "conflate") {
+                EXPECT_LE(st.queued_messages, 3u); // frame in flight + latest of each channel
+                EXPECT_GT(st.conflated, 0u);
+                EXPECT_EQ(st.dropped, 0u);
+            } else {
+                EXPECT_GT(st.dropped, 0u);
+            }
+            EXPECT_EQ(server->slow_consumer_disconnects(), 0u);
+        }
+
+        ASSERT_EQ(server->stop(), HAKO_PDU_ERR_OK);
+        ASSERT_EQ(server->close(), HAKO_PDU_ERR_OK);
+        boost::system::error_code ec;
+        slow.next_layer().close(ec);
+    }
+}
+
+TEST_F(EndpointTest, WebSocketIoThreadsOrderTest) {
+    // Four io threads serve four clients; each client's frames must still arrive in order.
+    constexpr int kClients = 4;
+    constexpr int kFrames = 200;
+    auto server = std::make_shared<hakoniwa::pdu::comm::WebSocketComm>();
+    ASSERT_EQ(server->open("test/test_comm_ws_pool_server.json"), HAKO_PDU_ERR_OK);
+    std::mutex mtx;
+    std::map<int, std::vector<int>> received;
+    server->set_on_recv_callback([&](const hakoniwa::pdu::PduResolvedKey& key, std::span<const std::byte> data) {
+        std::lock_guard<std::mutex> lock(mtx);
+        received[key.channel_id].push_back(static_cast<int>(data[0]) | (static_cast<int>(data[1]) << 8));
+    });
+    ASSERT_EQ(server->start(), HAKO_PDU_ERR_OK);
+
+    std::vector<std::shared_ptr<hakoniwa::pdu::comm::WebSocketComm>> clients;
+    for (int c = 0; c < kClients; ++c) {
+        auto client = std::make_shared<hakoniwa::pdu::comm::WebSocketComm>();
+        ASSERT_EQ(client->open("test/test_comm_ws_pool_client.json"), HAKO_PDU_ERR_OK);
+        ASSERT_EQ(client->start(), HAKO_PDU_ERR_OK);
+        clients.push_back(client);
+    }
+    for (auto& client : clients) {
+        bool running = false;
+        for (int w = 0; w < 100 && !running; ++w) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            client->is_running(running);
+        }
+        ASSERT_TRUE(running);
+    }
+
+    std::vector<std::thread> senders;
+    for (int c = 0; c < kClients; ++c) {
+        senders.emplace_back([&, c]() {
+            for (int i = 0; i < kFrames; ++i) {
+                std::vector<std::byte> msg = {static_cast<std::byte>(i & 0xFF), static_cast<std::byte>(i >> 8)};
+                clients[c]->send(create_key("robot_ws_pool", c), msg);
+            }
+        });
+    }
+    for (auto& t : senders) {
+        t.join();
+    }
+    auto complete = [&]() {
+        std::lock_guard<std::mutex> lock(mtx);
+        size_t total = 0;
+        for (const auto& [ch, seq] : received) {
+            total += seq.size();
+        }
+        return total >= static_cast<size_t>(kClients * kFrames);
+    };
+    for (int w = 0; w < 200 && !complete(); ++w) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        ASSERT_EQ(received.size(), static_cast<size_t>(kClients));
+        for (const auto& [ch, seq] : received) {
+            ASSERT_EQ(seq.size(), static_cast<size_t>(kFrames));
+            for (int i = 0; i < kFrames; ++i) {
+                EXPECT_EQ(seq[i], i);
+            }
+        }
+    }
+
+    for (auto& client : clients) {
+        ASSERT_EQ(client->stop(), HAKO_PDU_ERR_OK);
+        ASSERT_EQ(client->close(), HAKO_PDU_ERR_OK);
+    }
+    ASSERT_EQ(server->stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(server->close(), HAKO_PDU_ERR_OK);
+}
+
+TEST_F(EndpointTest, WebSocketInPlaceDecodeNoAllocTest) {
+    // Once warmed up, receiving same-sized messages allocates nothing on the
+    // server's io thread: frames are decoded in place from the read buffer and
+    // the read operation state lives in per-session storage.
+    constexpr int kWarmup = 50;
+    constexpr int kFrames = 250;
+    auto server = std::make_shared<hakoniwa::pdu::comm::WebSocketComm>();
+    ASSERT_EQ(server->open("test/test_comm_ws_alloc_server.json"), HAKO_PDU_ERR_OK);
+    std::atomic<int> received{0};
+    std::atomic<uint64_t> allocations_at_warmup{0};
+    std::atomic<uint64_t> allocations_at_end{0};
+    server->set_on_recv_callback([&](const hakoniwa::pdu::PduResolvedKey&, std::span<const std::byte>) {
+        // io_threads 1: every callback runs on the same io thread.
+        const int n = ++received;
+        if (n == kWarmup) {
+            allocations_at_warmup = t_thread_allocations;
+        } else if (n == kFrames) {
+            allocations_at_end = t_thread_allocations;
+        }
+    });
+    ASSERT_EQ(server->start(), HAKO_PDU_ERR_OK);
+
+    auto client = std::make_shared<hakoniwa::pdu::comm::WebSocketComm>();
+    ASSERT_EQ(client->open("test/test_comm_ws_alloc_client.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client->start(), HAKO_PDU_ERR_OK);
+    bool running = false;
+    for (int w = 0; w < 100 && !running; ++w) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        client->is_running(running);
+    }
+    ASSERT_TRUE(running);
+
+    const std::vector<std::byte> msg(4096, std::byte{0x5A});
+    for (int i = 0; i < kFrames; ++i) {
+        ASSERT_EQ(client->send(create_key("robot_ws_alloc", 1), msg), HAKO_PDU_ERR_OK);
+    }
+    for (int w = 0; w < 200 && received.load() < kFrames; ++w) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ(received.load(), kFrames);
+    EXPECT_EQ(allocations_at_end.load() - allocations_at_warmup.load(), 0u);
+
+    ASSERT_EQ(client->stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client->close(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(server->stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(server->close(), HAKO_PDU_ERR_OK);
+}
+
+TEST_F(EndpointTest, WebSocketPermessageDeflateTest) {
+    // The server negotiates permessage-deflate with a client that offers it and
+    // its compressed frames inflate back to the original PDU.
+    namespace net = boost::asio;
+    namespace websocket = boost::beast::websocket;
+    auto server = std::make_shared<hakoniwa::pdu::comm::WebSocketComm>();
+    ASSERT_EQ(server->open("test/test_comm_ws_deflate_server.json"), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(server->start(), HAKO_PDU_ERR_OK);
+
+    net::io_context ioc;
+    net::ip::tcp::socket socket(ioc);
+    socket.connect({net::ip::make_address("127.0.0.1"), 54021});
+    websocket::stream<net::ip::tcp::socket> client(std::move(socket));
+    websocket::permessage_deflate pmd;
+    pmd.client_enable = true;
+    client.set_option(pmd);
+    websocket::response_type res;
+    client.handshake(res, "127.0.0.1", "/");
+    const std::string extensions(res[boost::beast::http::field::sec_websocket_extensions]);
+    EXPECT_NE(extensions.find("permessage-deflate"), std::string::npos);
+    EXPECT_NE(extensions.find("server_max_window_bits=12"), std::string::npos);
+
+    std::vector<hakoniwa::pdu::comm::WebSocketSessionStats> stats;
+    for (int w = 0; w < 100 && stats.empty(); ++w) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        ASSERT_EQ(server->get_session_stats(stats), HAKO_PDU_ERR_OK);
+    }
+    std::vector<std::byte> pdu(64 * 1024);
+    for (size_t i = 0; i < pdu.size(); ++i) {
+        pdu[i] = static_cast<std::byte>((i / 64) & 0xFF);
+    }
+    ASSERT_EQ(server->send(create_key("robot_ws_deflate", 3), pdu), HAKO_PDU_ERR_OK);
+
+    boost::beast::flat_buffer buffer;
+    client.read(buffer);
+    const auto data = buffer.data();
+    std::span<const std::byte> frame(static_cast<const std::byte*>(data.data()), data.size());
+    hakoniwa::pdu::comm::DataPacketView packet;
+    ASSERT_TRUE(hakoniwa::pdu::comm::DataPacket::decode_view(frame, "v2", packet));
+    EXPECT_EQ(packet.robot_name, "robot_ws_deflate");
+    ASSERT_EQ(packet.body.size(), pdu.size());
+    EXPECT_TRUE(std::equal(packet.body.begin(), packet.body.end(), pdu.begin()));
+
+    ASSERT_EQ(server->stop(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(server->close(), HAKO_PDU_ERR_OK);
+    boost::system::error_code ec;
+    client.next_layer().close(ec);
 }